@@ -0,0 +1,82 @@
+#include "stdafx.h"
+#include "MicroBenchmark.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if SNES_COUNT_ALLOCATIONS
+
+namespace snes
+{
+	namespace
+	{
+		/** Every allocation made through operator new, counted by the replacements below */
+		std::atomic<uint64> allocationCount(0);
+	}
+
+	uint64 MicroBenchmark::GetAllocationCount()
+	{
+		return allocationCount.load(std::memory_order_relaxed);
+	}
+}
+
+/** Replace the global allocation functions to count allocations. The nothrow forms are replaced too, so every new is
+  * paired with the delete below even when a runtime (e.g. a sanitizer) supplies its own defaults */
+void* operator new(std::size_t size)
+{
+	snes::allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* memory = std::malloc(size > 0 ? size : 1);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	snes::allocationCount.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+#else
+
+namespace snes
+{
+	uint64 MicroBenchmark::GetAllocationCount()
+	{
+		return 0;
+	}
+}
+
+#endif
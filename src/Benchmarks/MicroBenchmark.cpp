@@ -0,0 +1,461 @@
+#include "stdafx.h"
+#include "MicroBenchmark.h"
+#include <Core\GameObject.h>
+#include <Components\AABBCollider.h>
+#include <Components\Camera.h>
+#include <Components\LODModel.h>
+#include <Components\Rigidbody.h>
+#include <Components\SphereCollider.h>
+#include <Components\TestComponent.h>
+#include <Rendering\LightClusterGrid.h>
+#include <Rendering\Material.h>
+#include <Rendering\Mesh.h>
+#include <Rendering\RenderQueue.h>
+#include <Rendering\RenderSnapshot.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+namespace snes
+{
+	namespace
+	{
+		/** Written by KeepResult(). Volatile, so every write counts as used */
+		const void* volatile resultSink = nullptr;
+
+		/** Stop the compiler from optimising away a result that is otherwise unused */
+		void KeepResult(const void* result)
+		{
+			resultSink = result;
+		}
+
+		/** A scene to build benchmark objects in, torn down in bulk at the end of the benchmark */
+		struct BenchmarkScene
+		{
+			ObjectPools pools;
+			ComponentPhases phases;
+			GameObject* root;
+
+			BenchmarkScene() { root = pools.Get<GameObject>().Create(nullptr, pools, phases); }
+			~BenchmarkScene()
+			{
+				phases.Clear();
+				pools.Clear();
+			}
+		};
+	}
+
+	constexpr std::chrono::milliseconds MicroBenchmark::MIN_RUN_TIME;
+	constexpr uint64 MicroBenchmark::MAX_ITERATIONS;
+
+	bool MicroBenchmarkState::KeepRunning()
+	{
+		if (!m_started)
+		{
+			m_started = true;
+			ResumeTiming();
+		}
+
+		if (m_completed < m_iterations)
+		{
+			++m_completed;
+			return true;
+		}
+
+		PauseTiming();
+		return false;
+	}
+
+	void MicroBenchmarkState::PauseTiming()
+	{
+		if (m_timing)
+		{
+			m_elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start);
+			m_allocations += MicroBenchmark::GetAllocationCount() - m_startAllocations;
+			m_timing = false;
+		}
+	}
+
+	void MicroBenchmarkState::ResumeTiming()
+	{
+		if (!m_timing)
+		{
+			m_timing = true;
+			m_startAllocations = MicroBenchmark::GetAllocationCount();
+			m_start = Clock::now();
+		}
+	}
+
+	void MicroBenchmark::Run(const std::string& filter, const std::string& outputPath)
+	{
+		std::vector<std::pair<std::string, Function>> benchmarks;
+		RegisterBenchmarks(benchmarks);
+
+		std::cout << "Micro benchmarks" << (filter.empty() ? "" : " matching \"" + filter + "\"") << ":" << std::endl;
+#if !SNES_COUNT_ALLOCATIONS
+		std::cout << "Allocations aren't counted in this build. Build the MicroBenchmark configuration (or define SNES_COUNT_ALLOCATIONS=1) to count them" << std::endl;
+#endif
+
+		std::vector<Result> results;
+		for (const auto& benchmark : benchmarks)
+		{
+			if (benchmark.first.find(filter) == std::string::npos)
+			{
+				continue;
+			}
+
+			Result result = Measure(benchmark.first, benchmark.second);
+			results.push_back(result);
+
+			std::cout << "  " << std::left << std::setw(52) << result.name << std::right << std::fixed
+				<< std::setw(14) << std::setprecision(1) << result.nsPerOp << " ns/op";
+#if SNES_COUNT_ALLOCATIONS
+			std::cout << std::setw(10) << std::setprecision(2) << result.allocsPerOp << " allocs/op";
+#endif
+			std::cout << "  (" << result.iterations << " iterations)" << std::endl;
+			std::cout.unsetf(std::ios::fixed);
+		}
+
+		if (!outputPath.empty())
+		{
+			WriteResults(outputPath, results);
+		}
+	}
+
+	MicroBenchmark::Result MicroBenchmark::Measure(const std::string& name, const Function& function)
+	{
+		const std::chrono::nanoseconds minRunTime = MIN_RUN_TIME;
+
+		uint64 iterations = 1;
+		while (true)
+		{
+			MicroBenchmarkState state(iterations);
+			function(state);
+
+			if (state.GetElapsed() >= minRunTime || iterations >= MAX_ITERATIONS)
+			{
+				Result result;
+				result.name = name;
+				result.iterations = iterations;
+				result.nsPerOp = (double)state.GetElapsed().count() / iterations;
+				result.allocsPerOp = (double)state.GetAllocations() / iterations;
+				return result;
+			}
+
+			// Aim a little past the minimum time, but grow by at most 10x at once in case the first runs were unusually fast
+			double elapsedNs = (double)std::max(state.GetElapsed().count(), (std::chrono::nanoseconds::rep)1);
+			uint64 target = (uint64)(iterations * 1.5 * minRunTime.count() / elapsedNs);
+			iterations = std::min(std::max(target, iterations + 1), std::min(iterations * 10, MAX_ITERATIONS));
+		}
+	}
+
+	void MicroBenchmark::RegisterBenchmarks(std::vector<std::pair<std::string, Function>>& outBenchmarks)
+	{
+		/** Mesh loading: parsing the .obj and building the vertex lists (the upload is skipped without a GL context) */
+
+		const char* models[] = { "cube", "sphere3", "sphere1", "sphere0", "charizard" };
+		for (const char* model : models)
+		{
+			std::string path = std::string("Models/") + model + ".obj";
+			outBenchmarks.emplace_back(std::string("Mesh::Load/") + model, [path](MicroBenchmarkState& state)
+			{
+				while (state.KeepRunning())
+				{
+					Mesh mesh(path.c_str());
+					KeepResult(&mesh);
+				}
+			});
+		}
+
+		const char* neighbourModels[] = { "sphere3", "sphere1", "sphere0" };
+		for (const char* model : neighbourModels)
+		{
+			std::string path = std::string("Models/") + model + ".obj";
+			outBenchmarks.emplace_back(std::string("Mesh::GenNeighbourData/") + model, [path](MicroBenchmarkState& state)
+			{
+				while (state.KeepRunning())
+				{
+					// Generating neighbour data rewrites the mesh, so every run needs a freshly loaded one
+					state.PauseTiming();
+					std::unique_ptr<Mesh> mesh(new Mesh(path.c_str()));
+					state.ResumeTiming();
+
+					mesh->GenNeighbourData();
+
+					state.PauseTiming();
+					mesh.reset();
+					state.ResumeTiming();
+				}
+			});
+		}
+
+		/** LOD selection over every LOD of every model, as run by Scene::FixedLogic() */
+
+		const uint lodInstanceCounts[] = { 100, 1000, 10000 };
+		for (uint instanceCount : lodInstanceCounts)
+		{
+			outBenchmarks.emplace_back("LODModel::SortAndSetLODValues/" + std::to_string(instanceCount), [instanceCount](MicroBenchmarkState& state)
+			{
+				BenchmarkScene scene;
+				GameObject* cameraObject = scene.root->AddChild();
+				Camera* camera = cameraObject->AddComponent<Camera>();
+				camera->MainLogic();
+
+				std::vector<LODModel*> lodModels;
+				uint gridSize = (uint)std::ceil(std::sqrt((float)instanceCount));
+				for (uint i = 0; i < instanceCount; ++i)
+				{
+					GameObject* sphere = scene.root->AddChild();
+					sphere->GetTransform().SetLocalPosition(glm::vec3((i % gridSize) * 2.0f, 0.0f, 5.0f + (i / gridSize) * 2.0f));
+					sphere->GetTransform().SetLocalScale(glm::vec3(0.1f));
+					LODModel* lodModel = sphere->AddComponent<LODModel>();
+					lodModel->SetCamera(camera);
+					lodModel->Load("Models/sphere");
+					lodModels.push_back(lodModel);
+				}
+
+				while (state.KeepRunning())
+				{
+					// Sorting leaves the values in order, so they're gathered again before every sort
+					state.PauseTiming();
+					LODModel::StartNewFrame();
+					for (LODModel* lodModel : lodModels)
+					{
+						lodModel->FixedLogic();
+					}
+					state.ResumeTiming();
+
+					LODModel::SortAndSetLODValues();
+				}
+			});
+		}
+
+		/** World matrices down a hierarchy */
+
+		const uint depths[] = { 4, 32 };
+		for (uint depth : depths)
+		{
+			for (int moved = 0; moved < 2; ++moved)
+			{
+				std::string name = "Transform::GetTRS/depth " + std::to_string(depth) + (moved ? " after the root moves" : " unchanged");
+				outBenchmarks.emplace_back(name, [depth, moved](MicroBenchmarkState& state)
+				{
+					BenchmarkScene scene;
+					GameObject* top = scene.root->AddChild();
+					GameObject* leaf = top;
+					for (uint i = 1; i < depth; ++i)
+					{
+						leaf = leaf->AddChild();
+						leaf->GetTransform().SetLocalPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+						leaf->GetTransform().SetLocalRotation(glm::vec3(0.0f, 10.0f, 0.0f));
+					}
+
+					Transform& topTransform = top->GetTransform();
+					Transform& leafTransform = leaf->GetTransform();
+					float x = 0.0f;
+					while (state.KeepRunning())
+					{
+						if (moved)
+						{
+							x += 1.0f;
+							topTransform.SetLocalPosition(glm::vec3(x, 0.0f, 0.0f));
+						}
+						glm::mat4 trs = leafTransform.GetTRS();
+						KeepResult(&trs);
+					}
+				});
+			}
+		}
+
+		/** Component lookups, which search the object's components in the order they were added */
+
+		outBenchmarks.emplace_back("GameObject::GetComponent/first of 4", [](MicroBenchmarkState& state)
+		{
+			BenchmarkScene scene;
+			GameObject* object = scene.root->AddChild();
+			object->AddComponent<TestComponent>();
+			object->AddComponent<Rigidbody>();
+			object->AddComponent<AABBCollider>();
+			object->AddComponent<SphereCollider>();
+			while (state.KeepRunning())
+			{
+				KeepResult(object->GetComponent<TestComponent>());
+			}
+		});
+		outBenchmarks.emplace_back("GameObject::GetComponent/last of 4", [](MicroBenchmarkState& state)
+		{
+			BenchmarkScene scene;
+			GameObject* object = scene.root->AddChild();
+			object->AddComponent<TestComponent>();
+			object->AddComponent<Rigidbody>();
+			object->AddComponent<AABBCollider>();
+			object->AddComponent<SphereCollider>();
+			while (state.KeepRunning())
+			{
+				KeepResult(object->GetComponent<SphereCollider>());
+			}
+		});
+		outBenchmarks.emplace_back("GameObject::GetComponent/missing of 4", [](MicroBenchmarkState& state)
+		{
+			BenchmarkScene scene;
+			GameObject* object = scene.root->AddChild();
+			object->AddComponent<TestComponent>();
+			object->AddComponent<Rigidbody>();
+			object->AddComponent<AABBCollider>();
+			object->AddComponent<SphereCollider>();
+			while (state.KeepRunning())
+			{
+				KeepResult(object->GetComponent<LODModel>());
+			}
+		});
+
+		/** Per-draw uniform updates, as made by DrawItem::Draw() (the GL calls themselves are skipped without a context) */
+
+		const char* materials[] = { "sphere0", "teapot", "CrashSil" };
+		for (const char* materialName : materials)
+		{
+			std::string path = std::string("Models/") + materialName + ".mat";
+			outBenchmarks.emplace_back(std::string("Material::PrepareForRendering/") + materialName, [path](MicroBenchmarkState& state)
+			{
+				std::shared_ptr<Material> material = Material::CreateMaterial(path.c_str());
+
+				DrawItem item;
+				item.mesh = Mesh::GetMesh("Models/sphere3.obj");
+				item.material = material;
+				item.model = glm::mat4(1.0f);
+				item.worldPosition = glm::vec3(0.0f, 0.0f, 10.0f);
+				item.worldScale = glm::vec3(1.0f);
+
+				CameraState camera;
+				camera.proj = glm::perspective(glm::radians(85.0f), 800.0f / 600.0f, 0.01f, 1000.0f);
+				camera.view = Camera::CalculateViewMatrix(camera.position, camera.rotation);
+				camera.verticalFoV = 85.0f * 0.75f;
+
+				while (state.KeepRunning())
+				{
+					material->ApplyTransformUniforms(item.model);
+					material->PrepareForRendering(item, camera);
+				}
+			});
+		}
+
+		/** Ordering a pass's draws by sort key, as done by Scene::Render() before every pass */
+
+		const uint drawCounts[] = { 100, 1000, 10000 };
+		for (uint drawCount : drawCounts)
+		{
+			outBenchmarks.emplace_back("RenderQueue::Sort/" + std::to_string(drawCount), [drawCount](MicroBenchmarkState& state)
+			{
+				const char* materialPaths[] = { "Models/sphere0.mat", "Models/teapot.mat", "Models/CrashSil.mat" };
+				const char* meshPaths[] = { "Models/sphere3.obj", "Models/sphere1.obj", "Models/cube.obj" };
+				std::vector<std::shared_ptr<Material>> materials;
+				std::vector<std::shared_ptr<Mesh>> meshes;
+				for (uint i = 0; i < 3; ++i)
+				{
+					materials.push_back(Material::CreateMaterial(materialPaths[i]));
+					meshes.push_back(Mesh::GetMesh(meshPaths[i]));
+				}
+
+				// Scattered in front of the camera, with materials and meshes interleaved as a hierarchy might leave them
+				RenderSnapshot snapshot;
+				for (uint i = 0; i < drawCount; ++i)
+				{
+					snapshot.items.emplace_back();
+					DrawItem& item = snapshot.items.back();
+					item.material = materials[i % materials.size()];
+					item.mesh = meshes[(i / 3) % meshes.size()];
+					item.worldPosition = glm::vec3((float)(i % 37), (float)(i % 11), -1.0f - (float)((i * 7919) % drawCount));
+				}
+
+				RenderQueue queue;
+				while (state.KeepRunning())
+				{
+					state.PauseTiming();
+					queue.Build(snapshot, RENDER_PASS_GEOMETRY, snapshot.camera);
+					state.ResumeTiming();
+
+					queue.Sort();
+				}
+			});
+		}
+
+		/** Binning point lights into the view's clusters, as done by DeferredLightingManager::RenderLighting() every frame */
+
+		const uint lightCounts[] = { 100, 1000, 4000 };
+		for (uint lightCount : lightCounts)
+		{
+			outBenchmarks.emplace_back("LightClusterGrid::Build/" + std::to_string(lightCount), [lightCount](MicroBenchmarkState& state)
+			{
+				CameraState camera;
+				camera.proj = glm::perspective(glm::radians(85.0f), 800.0f / 600.0f, 0.01f, 1000.0f);
+				camera.view = Camera::CalculateViewMatrix(camera.position, camera.rotation);
+
+				// Scattered around and in front of the camera, with the default point light attenuation
+				std::vector<PointLightState> pointLights;
+				for (uint i = 0; i < lightCount; ++i)
+				{
+					glm::vec3 position((float)((i * 7) % 61) - 30.0f, (float)((i * 13) % 21) - 10.0f, -(float)((i * 7919) % 200));
+					pointLights.push_back(PointLightState{ position, glm::vec3(1.0f), 0.1f, 0.2f });
+				}
+
+				LightClusterGrid grid;
+				while (state.KeepRunning())
+				{
+					grid.Build(pointLights, camera);
+					KeepResult(grid.GetLightIndices().data());
+				}
+			});
+		}
+
+		/** Collision response between two boxes. Both are locked in place, so every run sees the same overlap */
+		for (int overlapping = 1; overlapping >= 0; --overlapping)
+		{
+			outBenchmarks.emplace_back(std::string("Rigidbody::HandleCollision/") + (overlapping ? "overlapping" : "apart"), [overlapping](MicroBenchmarkState& state)
+			{
+				BenchmarkScene scene;
+				GameObject* a = scene.root->AddChild();
+				GameObject* b = scene.root->AddChild();
+				Rigidbody* rigidbody = a->AddComponent<Rigidbody>();
+				b->AddComponent<Rigidbody>()->LockPosition();
+				rigidbody->LockPosition();
+				a->AddComponent<AABBCollider>()->SetBounds(glm::vec3(0.0f), glm::vec3(1.0f));
+				b->AddComponent<AABBCollider>()->SetBounds(glm::vec3(overlapping ? 0.5f : 2.0f, 0.2f, 0.1f), glm::vec3(1.0f));
+
+				while (state.KeepRunning())
+				{
+					rigidbody->HandleCollision(*b);
+				}
+			});
+		}
+	}
+
+	bool MicroBenchmark::WriteResults(const std::string& path, const std::vector<Result>& results)
+	{
+		std::ofstream out(path, std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			std::cout << "Error: Could not open " << path << " to write benchmark results" << std::endl;
+			return false;
+		}
+
+		out << "{\n";
+		out << "  \"units\": \"ns\",\n";
+		out << "  \"benchmarks\": [\n";
+		for (uint i = 0; i < results.size(); ++i)
+		{
+			const Result& result = results[i];
+			out << "    { \"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+				<< ", \"nsPerOp\": " << result.nsPerOp;
+#if SNES_COUNT_ALLOCATIONS
+			out << ", \"allocsPerOp\": " << result.allocsPerOp;
+#endif
+			out << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		out << "  ]\n";
+		out << "}\n";
+
+		std::cout << "Benchmark results written to " << path << std::endl;
+		return true;
+	}
+}
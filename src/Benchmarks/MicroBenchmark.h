@@ -0,0 +1,95 @@
+#pragma once
+#include <Core\FrameTime.h>
+#include <functional>
+
+/** Counting allocations replaces the global operator new and delete, which the whole program then allocates through,
+  * so it's only compiled into builds made for running micro benchmarks. The MicroBenchmark|x64 configuration is a Release
+  * build with SNES_COUNT_ALLOCATIONS=1 defined; define it in any other build to count them there */
+#ifndef SNES_COUNT_ALLOCATIONS
+#define SNES_COUNT_ALLOCATIONS 0
+#endif
+
+namespace snes
+{
+	/** Micro Benchmark State
+	  * Passed to each microbenchmark, which runs the operation being measured once per KeepRunning():
+	  *
+	  *   while (state.KeepRunning())
+	  *   {
+	  *       transform.GetTRS();
+	  *   }
+	  *
+	  * Work that shouldn't count (e.g. resetting what the operation changed) goes between PauseTiming() and ResumeTiming(). */
+	class MicroBenchmarkState
+	{
+	public:
+		MicroBenchmarkState(uint64 iterations) : m_iterations(iterations) {}
+
+		/** @return true until the operation has run the requested number of times. Starts timing on the first call */
+		bool KeepRunning();
+
+		/** Stop counting time and allocations */
+		void PauseTiming();
+		/** Start counting time and allocations again */
+		void ResumeTiming();
+
+		/** @return the number of times the operation runs */
+		uint64 GetIterations() const { return m_iterations; }
+		/** @return the time spent in the operation, excluding pauses */
+		std::chrono::nanoseconds GetElapsed() const { return m_elapsed; }
+		/** @return the allocations made by the operation, excluding pauses */
+		uint64 GetAllocations() const { return m_allocations; }
+
+	private:
+		uint64 m_iterations;
+		uint64 m_completed = 0;
+		bool m_started = false;
+		bool m_timing = false;
+
+		Clock::time_point m_start;
+		uint64 m_startAllocations = 0;
+		std::chrono::nanoseconds m_elapsed{ 0 };
+		uint64 m_allocations = 0;
+	};
+
+	/** Micro Benchmark
+	  * Times the engine's hot paths in isolation (mesh loading, LOD sorting, transform and component lookups, uniform
+	  * flushing, draw sorting, collision), reporting nanoseconds and heap allocations per operation so regressions show up before they
+	  * reach a full scene. Each benchmark repeats with more iterations until a run takes long enough to time reliably.
+	  * Doesn't need a window or OpenGL context, so GPU work is skipped as it is when running headless. */
+	class MicroBenchmark
+	{
+	public:
+		typedef std::function<void(MicroBenchmarkState&)> Function;
+
+		/** Run every benchmark whose name contains the filter, print the results to the console and optionally write
+		  * them to a JSON file */
+		static void Run(const std::string& filter = "", const std::string& outputPath = "");
+
+		/** @return the number of heap allocations made through operator new since startup, or 0 if allocations aren't
+		  * counted in this build (see SNES_COUNT_ALLOCATIONS) */
+		static uint64 GetAllocationCount();
+
+	private:
+		struct Result
+		{
+			std::string name;
+			uint64 iterations;
+			double nsPerOp;
+			double allocsPerOp;
+		};
+
+		/** The shortest run that counts as a measurement */
+		static constexpr std::chrono::milliseconds MIN_RUN_TIME{ 200 };
+		/** The most iterations a single run may have */
+		static constexpr uint64 MAX_ITERATIONS = 1000000000;
+
+		/** Add every benchmark to a list, in the order they run */
+		static void RegisterBenchmarks(std::vector<std::pair<std::string, Function>>& outBenchmarks);
+		/** Run a benchmark with increasing iteration counts until it takes at least MIN_RUN_TIME */
+		static Result Measure(const std::string& name, const Function& function);
+		/** Write the results to a JSON file
+		  * @return true if the file was written */
+		static bool WriteResults(const std::string& path, const std::vector<Result>& results);
+	};
+}
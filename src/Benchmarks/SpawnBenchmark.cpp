@@ -0,0 +1,95 @@
+#include "stdafx.h"
+#include "SpawnBenchmark.h"
+#include <Core\FrameTime.h>
+#include <Core\GameObject.h>
+#include <Components\Rigidbody.h>
+#include <Components\TestComponent.h>
+
+namespace snes
+{
+	namespace
+	{
+		/** Print the duration of a benchmark step since start, in total and per object */
+		void PrintResult(const char* name, Clock::time_point start, uint objectCount)
+		{
+			double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			double nsPerObject = (ms * NS_IN_MS) / objectCount;
+			std::cout << "  " << name << ": " << ms << " ms (" << nsPerObject << " ns/object)" << std::endl;
+		}
+	}
+
+	void SpawnBenchmark::Run(uint objectCount)
+	{
+		std::cout << "Spawn benchmark: " << objectCount << " GameObjects, each with a TestComponent and Rigidbody" << std::endl;
+
+		// Pooled: GameObjects and components allocated from the scene's pools
+		{
+			ObjectPools pools;
+			ComponentPhases phases;
+			GameObject* root = pools.Get<GameObject>().Create(nullptr, pools, phases);
+			std::vector<GameObject*> objects;
+			objects.reserve(objectCount);
+
+			std::cout << "Pooled:" << std::endl;
+
+			Clock::time_point start = Clock::now();
+			for (uint i = 0; i < objectCount; i++)
+			{
+				GameObject* object = root->AddChild();
+				object->AddComponent<TestComponent>();
+				object->AddComponent<Rigidbody>();
+				objects.push_back(object);
+			}
+			PrintResult("Spawn (cold pools)", start, objectCount);
+
+			start = Clock::now();
+			for (GameObject* object : objects)
+			{
+				object->Destroy();
+			}
+			PrintResult("Destroy individually", start, objectCount);
+			objects.clear();
+
+			start = Clock::now();
+			for (uint i = 0; i < objectCount; i++)
+			{
+				GameObject* object = root->AddChild();
+				object->AddComponent<TestComponent>();
+				object->AddComponent<Rigidbody>();
+			}
+			PrintResult("Spawn (reusing free slots)", start, objectCount);
+
+			start = Clock::now();
+			phases.Clear();
+			pools.Clear();
+			PrintResult("Bulk scene teardown", start, objectCount);
+		}
+
+		// Baseline: one make_shared allocation (and refcount control block) per GameObject and component
+		{
+			ObjectPools pools;
+			ComponentPhases phases;
+			std::vector<std::shared_ptr<GameObject>> objects;
+			std::vector<std::shared_ptr<Component>> components;
+			objects.reserve(objectCount);
+			components.reserve(objectCount * 2);
+
+			std::cout << "make_shared:" << std::endl;
+
+			Clock::time_point start = Clock::now();
+			for (uint i = 0; i < objectCount; i++)
+			{
+				auto object = std::make_shared<GameObject>(nullptr, pools, phases);
+				components.push_back(std::make_shared<TestComponent>(*object));
+				components.push_back(std::make_shared<Rigidbody>(*object));
+				objects.push_back(object);
+			}
+			PrintResult("Spawn", start, objectCount);
+
+			start = Clock::now();
+			components.clear();
+			objects.clear();
+			PrintResult("Destroy", start, objectCount);
+		}
+	}
+}
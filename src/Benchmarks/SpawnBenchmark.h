@@ -0,0 +1,15 @@
+#pragma once
+
+namespace snes
+{
+	/** Spawn Benchmark
+	  * Measures the cost of spawning and destroying large numbers of GameObjects with components,
+	  * comparing the pooled allocation used by Scene against one make_shared allocation per object.
+	  * Doesn't need a window or OpenGL context, so it can run before the Application is created. */
+	class SpawnBenchmark
+	{
+	public:
+		/** Run the benchmark and print the results to the console */
+		static void Run(uint objectCount = 100000);
+	};
+}
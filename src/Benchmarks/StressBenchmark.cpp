@@ -0,0 +1,108 @@
+#include "stdafx.h"
+#include "StressBenchmark.h"
+#include <Rendering\GraphicsDevice.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+
+namespace snes
+{
+	constexpr uint StressBenchmark::WARMUP_FRAMES;
+
+	StressBenchmark::StressBenchmark(const StressSceneSettings& settings, uint frameCount)
+		: m_settings(settings)
+		, m_frameCount(frameCount)
+	{
+		for (auto& samples : m_phaseSamples)
+		{
+			samples.reserve(frameCount);
+		}
+		m_frameSamples.reserve(frameCount);
+		m_lastFrameEnd = Clock::now();
+	}
+
+	void StressBenchmark::RecordFrame(Scene& scene)
+	{
+		Clock::time_point frameEnd = Clock::now();
+
+		if (m_framesRecorded >= WARMUP_FRAMES && !IsFinished())
+		{
+			for (uint phase = 0; phase < SCENE_PHASE_COUNT; ++phase)
+			{
+				m_phaseSamples[phase].push_back(scene.GetPhaseTime((ScenePhase)phase));
+			}
+			m_frameSamples.push_back(std::chrono::duration<double, std::milli>(frameEnd - m_lastFrameEnd).count());
+		}
+
+		++m_framesRecorded;
+		m_lastFrameEnd = frameEnd;
+		scene.ResetPhaseTimes();
+	}
+
+	bool StressBenchmark::WriteResults(const std::string& path, const Scene& scene) const
+	{
+		std::ofstream out(path, std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			std::cout << "Error: Could not open " << path << " to write benchmark results" << std::endl;
+			return false;
+		}
+
+		bool headless = !GraphicsDevice::IsAvailable();
+
+		out << "{\n";
+		out << "  \"scene\": { \"lodSpheres\": " << m_settings.lodSpheres
+			<< ", \"pointLights\": " << m_settings.pointLights
+			<< ", \"rigidbodies\": " << m_settings.rigidbodies
+			<< ", \"hierarchyDepth\": " << m_settings.hierarchyDepth
+			<< ", \"objects\": " << scene.GetObjectCount()
+			<< ", \"pooledInstances\": " << scene.GetPooledInstanceCount() << " },\n";
+		out << "  \"headless\": " << (headless ? "true" : "false") << ",\n";
+		out << "  \"frames\": " << m_frameSamples.size() << ",\n";
+		out << "  \"units\": \"ms\",\n";
+		out << "  \"phases\": {\n";
+		for (uint phase = 0; phase < SCENE_PHASE_COUNT; ++phase)
+		{
+			// Nothing is drawn headless, so the draw phases would only be zeros
+			if (headless && phase >= SCENE_PHASE_SHADOW_PASS)
+			{
+				continue;
+			}
+			out << "    \"" << Scene::GetPhaseName((ScenePhase)phase) << "\": ";
+			WriteSummary(out, m_phaseSamples[phase]);
+			out << ",\n";
+		}
+		out << "    \"frame\": ";
+		WriteSummary(out, m_frameSamples);
+		out << "\n  }\n";
+		out << "}\n";
+
+		std::cout << "Benchmark results written to " << path << std::endl;
+		return true;
+	}
+
+	void StressBenchmark::WriteSummary(std::ostream& out, std::vector<double> samples)
+	{
+		if (samples.empty())
+		{
+			out << "null";
+			return;
+		}
+
+		std::sort(samples.begin(), samples.end());
+		auto percentile = [&samples](double p)
+		{
+			// Nearest-rank percentile
+			uint rank = (uint)std::ceil(p * samples.size());
+			return samples[std::max(rank, 1u) - 1];
+		};
+		double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+		out << "{ \"mean\": " << mean
+			<< ", \"p50\": " << percentile(0.5)
+			<< ", \"p90\": " << percentile(0.9)
+			<< ", \"p99\": " << percentile(0.99)
+			<< ", \"max\": " << samples.back() << " }";
+	}
+}
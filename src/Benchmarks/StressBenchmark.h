@@ -0,0 +1,45 @@
+#pragma once
+#include <Core\Scene.h>
+
+namespace snes
+{
+	/** Stress Benchmark
+	  * Collects per-phase CPU timings from a procedurally generated stress scene over a fixed number of frames,
+	  * and writes them out as JSON (mean, percentiles and max per phase) so scaling can be compared between builds.
+	  * Draw phases are left out of the results when running headless, as nothing is drawn. */
+	class StressBenchmark
+	{
+	public:
+		StressBenchmark(const StressSceneSettings& settings, uint frameCount);
+		~StressBenchmark() {};
+
+		/** Record the scene's phase timings for the frame that just finished, and reset them for the next one */
+		void RecordFrame(Scene& scene);
+
+		/** @return true once every frame has been recorded */
+		bool IsFinished() const { return m_framesRecorded >= WARMUP_FRAMES + m_frameCount; }
+
+		/** Write the results to a JSON file
+		  * @return true if the file was written */
+		bool WriteResults(const std::string& path, const Scene& scene) const;
+
+	private:
+		/** Frames run before recording starts, so one-off loading costs don't skew the results */
+		static constexpr uint WARMUP_FRAMES = 10;
+
+		/** Write the summary of one set of samples as a JSON object */
+		static void WriteSummary(std::ostream& out, std::vector<double> samples);
+
+		StressSceneSettings m_settings;
+		uint m_frameCount;
+		uint m_framesRecorded = 0;
+
+		/** Per-frame samples of each phase, in milliseconds */
+		std::vector<double> m_phaseSamples[SCENE_PHASE_COUNT];
+		/** Per-frame wall time, in milliseconds */
+		std::vector<double> m_frameSamples;
+
+		/** When the last frame was recorded */
+		Clock::time_point m_lastFrameEnd;
+	};
+}
@@ -11,38 +11,48 @@ namespace snes
 {
 	void AABBCollider::FixedLogic()
 	{
-		std::weak_ptr<Mesh> mesh;
+		Handle<Mesh> meshHandle;
 
 		// Calculate collider bounds from mesh
 		const auto mr = m_gameObject.GetComponent<MeshRenderer>();
 		if (mr)
 		{
-			mesh = mr->GetMesh();
+			meshHandle = mr->GetMesh();
 		}
 		else
 		{
 			const auto lodMesh = m_gameObject.GetComponent<LODModel>();
 			if (lodMesh)
 			{
-				mesh = lodMesh->GetMesh(0);
+				meshHandle = lodMesh->GetMesh(0);
 			}
 			const auto tessMesh = m_gameObject.GetComponent<TessModel>();
 			if (tessMesh)
 			{
-				mesh = tessMesh->GetMesh();
+				meshHandle = tessMesh->GetMesh();
 			}
 		}
 
-		if (mesh.expired())
+		Mesh* mesh = meshHandle.Get();
+		if (!mesh)
 		{
 			std::cout << "Error: No mesh exists when creating bounding box." << std::endl;
 			return;
 		}
 
-		glm::vec3 min = mesh.lock()->GetVertices()[0];
+		// Nothing to do if neither the mesh nor the transform has changed since the bounds were fitted
+		uint64 version = m_transform.GetWorldVersion();
+		if (version == m_boundsVersion && meshHandle.GetId() == m_boundsMesh)
+		{
+			return;
+		}
+		m_boundsVersion = version;
+		m_boundsMesh = meshHandle.GetId();
+
+		glm::vec3 min = mesh->GetVertices()[0];
 		glm::vec3 max = min;
 
-		for (const auto& vertex : mesh.lock()->GetVertices())
+		for (const auto& vertex : mesh->GetVertices())
 		{
 			if (vertex.x < min.x)
 			{
@@ -72,9 +82,8 @@ namespace snes
 		}
 		
 		// Translate the min/max points into world space
-		auto transform = m_gameObject.GetTransform();
-		glm::mat4 scale = glm::scale(glm::mat4(1.0f), transform.GetWorldScale());
-		glm::mat4 translate = glm::translate(glm::mat4(1.0f), transform.GetWorldPosition());
+		glm::mat4 scale = glm::scale(glm::mat4(1.0f), m_transform.GetWorldScale());
+		glm::mat4 translate = glm::translate(glm::mat4(1.0f), m_transform.GetWorldPosition());
 		glm::mat4 modelMat = translate * scale;
 
 		min = modelMat * glm::vec4(min, 1);
@@ -4,7 +4,9 @@
 
 namespace snes
 {
-	/** Axis-Aligned Bounding Box */
+	/** Axis-Aligned Bounding Box
+	  * Fitted to the GameObject's mesh in world space. The bounds are only rebuilt when the transform
+	  * or the mesh changes, so static colliders cost nothing per fixed step. */
 	class AABBCollider : public Collider
 	{
 	public:
@@ -37,5 +39,9 @@ namespace snes
 	private:
 		glm::vec3 m_center;
 		glm::vec3 m_size;
+
+		/** The transform version and mesh the bounds were last fitted to */
+		uint64 m_boundsVersion = 0;
+		HandleId m_boundsMesh;
 	};
 }
@@ -1,8 +1,10 @@
 #include "stdafx.h"
 #include "Camera.h"
+#include <Core\Application.h>
 #include <Core\FrameTime.h>
 #include <Core\GameObject.h>
 #include <Core\Input.h>
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
@@ -10,8 +12,13 @@ namespace snes
 	{
 		if (!m_orthographic)
 		{
+			// Follow the window's shape, so resizing it doesn't stretch the view
+			uint screenWidth, screenHeight;
+			Application::GetScreenSize(screenWidth, screenHeight);
+			float aspect = (screenWidth > 0 && screenHeight > 0) ? (float)screenWidth / screenHeight : 4.0f / 3.0f;
+
 			auto fov = glm::radians(m_fieldOfView);
-			m_projMatrix = glm::perspective(fov, 800.0f / 600.0f, m_nearClipPlane, m_farClipPlane);
+			m_projMatrix = glm::perspective(fov, aspect, m_nearClipPlane, m_farClipPlane);
 		}
 		else
 		{
@@ -21,19 +28,26 @@ namespace snes
 
 	void Camera::CalculateCurrentViewMatrix()
 	{
-		const glm::vec3& cameraPosition = m_transform.GetWorldPosition();
+		m_viewMatrix = CalculateViewMatrix(m_transform.GetWorldPosition(), m_transform.GetWorldRotation());
+	}
 
-		m_viewMatrix = glm::lookAt(
-			cameraPosition,						// Camera position
-			cameraPosition + GetCameraDirection(),	// Camera "look-at" point
-			glm::vec3(0, 1, 0)					// Up vector
+	glm::mat4 Camera::CalculateViewMatrix(const glm::vec3& position, const glm::vec3& rotation)
+	{
+		return glm::lookAt(
+			position,											// Camera position
+			position + CalculateDirection(glm::radians(rotation)),	// Camera "look-at" point
+			glm::vec3(0, 1, 0)									// Up vector
 		);
 	}
 
 	glm::vec3 Camera::GetCameraDirection()
+	{
+		return CalculateDirection(m_transform.GetWorldRotationRadians());
+	}
+
+	glm::vec3 Camera::CalculateDirection(const glm::vec3& rot)
 	{
 		glm::vec3 cameraDirection;
-		const glm::vec3& rot = m_transform.GetWorldRotationRadians();
 		cameraDirection.x = cos(rot.x) * cos(rot.y);
 		cameraDirection.y = sin(rot.x);
 		cameraDirection.z = cos(rot.x) * sin(rot.y);
@@ -51,4 +65,20 @@ namespace snes
 	{
 		return (m_fieldOfView / 4) * 3; // 4:3
 	}
+
+	void Camera::SaveSnapshot(SnapshotWriter& writer)
+	{
+		writer.Write<bool>(m_orthographic);
+		writer.Write<float>(m_fieldOfView);
+		writer.Write<float>(m_nearClipPlane);
+		writer.Write<float>(m_farClipPlane);
+	}
+
+	void Camera::LoadSnapshot(SnapshotReader& reader)
+	{
+		m_orthographic = reader.Read<bool>();
+		m_fieldOfView = reader.Read<float>();
+		m_nearClipPlane = reader.Read<float>();
+		m_farClipPlane = reader.Read<float>();
+	}
 }
\ No newline at end of file
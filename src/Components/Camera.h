@@ -11,6 +11,8 @@ namespace snes
 		~Camera() {};
 
 		virtual void MainLogic() override;
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
 
 		void SetOrthographic(bool set) { m_orthographic = set; }
 
@@ -22,6 +24,14 @@ namespace snes
 		float GetVerticalFoV();
 		float GetNearClipPlane() { return m_nearClipPlane; }
 
+		/** @return the degrees the camera turns per pixel of mouse movement (x: yaw, y: pitch), or zero if the mouse doesn't turn it */
+		virtual glm::vec2 GetMouseLookSensitivity() { return glm::vec2(0.0f); }
+
+		/** @return the view matrix for a camera at a position, with a rotation in euler angles (degrees) */
+		static glm::mat4 CalculateViewMatrix(const glm::vec3& position, const glm::vec3& rotation);
+		/** @return the direction a camera with a rotation in euler angles (radians) faces */
+		static glm::vec3 CalculateDirection(const glm::vec3& rotationRadians);
+
 	protected:
 		/** @return the direction the camera is facing in euler angles */
 		glm::vec3 GetCameraDirection();
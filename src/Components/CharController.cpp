@@ -5,6 +5,7 @@
 #include <Core\GameObject.h>
 #include <Core\Input.h>
 #include <GL/freeglut.h>
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
@@ -60,4 +61,14 @@ namespace snes
 			}
 		}
 	}
-}
+
+	void CharController::SaveSnapshot(SnapshotWriter& writer)
+	{
+		writer.Write<bool>(m_charControl);
+	}
+
+	void CharController::LoadSnapshot(SnapshotReader& reader)
+	{
+		m_charControl = reader.Read<bool>();
+	}
+}
\ No newline at end of file
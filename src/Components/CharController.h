@@ -11,6 +11,8 @@ namespace snes
 
 		void Awake() override;
 		void MainLogic() override;
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
 
 		/** Set whether this character is being controlled by the keyboard */
 		void SetCharControl(bool on) { m_charControl = on; }
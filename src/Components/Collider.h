@@ -12,14 +12,6 @@ namespace snes
 		Collider(GameObject& gameObject) : Component(gameObject) {};
 		~Collider() {};
 
-		virtual void Awake() {};
-		virtual void Start() {};
-		virtual void FixedLogic() {};
-		virtual void MainLogic() {};
-		virtual void MainDraw() {};
-		virtual void OnDestroy() {};
-		virtual void OnCollision(GameObject& other) {};
-
 		/** @return whether the target collider is intersecting with this collider */
 		bool CheckIntersection(Collider& target);
 		virtual bool Intersects(const AABBCollider& target) const = 0;
@@ -3,6 +3,7 @@
 #include <Core\FrameTime.h>
 #include <Core\GameObject.h>
 #include <Core\Input.h>
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
@@ -67,4 +68,27 @@ namespace snes
 		CalculateCurrentProjMatrix();
 		CalculateCurrentViewMatrix();
 	}
+
+	glm::vec2 ControllableCamera::GetMouseLookSensitivity()
+	{
+		return m_cameraControl ? glm::vec2(m_xSensitivity, m_ySensitivity) : glm::vec2(0.0f);
+	}
+
+	void ControllableCamera::SaveSnapshot(SnapshotWriter& writer)
+	{
+		Camera::SaveSnapshot(writer);
+		writer.Write<bool>(m_cameraControl);
+		writer.Write<float>(m_xSensitivity);
+		writer.Write<float>(m_ySensitivity);
+		writer.Write<float>(m_moveSpeed);
+	}
+
+	void ControllableCamera::LoadSnapshot(SnapshotReader& reader)
+	{
+		Camera::LoadSnapshot(reader);
+		m_cameraControl = reader.Read<bool>();
+		m_xSensitivity = reader.Read<float>();
+		m_ySensitivity = reader.Read<float>();
+		m_moveSpeed = reader.Read<float>();
+	}
 }
\ No newline at end of file
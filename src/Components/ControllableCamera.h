@@ -14,6 +14,9 @@ namespace snes
 		void SetCameraControl(bool on) { m_cameraControl = on; }
 
 		void MainLogic() override;
+		glm::vec2 GetMouseLookSensitivity() override;
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
 
 	private:
 
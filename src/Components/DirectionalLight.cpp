@@ -1,10 +1,48 @@
 #include "stdafx.h"
 #include "DirectionalLight.h"
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
-	void DirectionalLight::MainLogic()
+	glm::mat4 DirectionalLight::GetViewProjectionMatrix()
 	{
+		Camera* camera = m_camera.Get();
+		if (!camera)
+		{
+			return glm::mat4(1.0f);
+		}
+		return camera->GetProjMatrix() * camera->GetViewMatrix();
+	}
+
+	glm::mat4 DirectionalLight::GetViewMatrix()
+	{
+		Camera* camera = m_camera.Get();
+		if (!camera)
+		{
+			return glm::mat4(1.0f);
+		}
+		return camera->GetViewMatrix();
+	}
 
+	glm::mat4 DirectionalLight::GetProjectionMatrix()
+	{
+		Camera* camera = m_camera.Get();
+		if (!camera)
+		{
+			return glm::mat4(1.0f);
+		}
+		return camera->GetProjMatrix();
+	}
+
+	void DirectionalLight::SaveSnapshot(SnapshotWriter& writer)
+	{
+		writer.Write<glm::vec3>(m_colour);
+		writer.WriteComponentRef(m_camera.Get());
+	}
+
+	void DirectionalLight::LoadSnapshot(SnapshotReader& reader)
+	{
+		m_colour = reader.Read<glm::vec3>();
+		m_camera = reader.ReadComponentRef<Camera>();
 	}
-}
+}
\ No newline at end of file
@@ -15,18 +15,20 @@ namespace snes
 		/** @return the colour of the pointlight */
 		const glm::vec3& GetColour() const { return m_colour; }
 
-		void SetCamera(std::shared_ptr<Camera> camera) { m_camera = camera; }
+		void SetCamera(Handle<Camera> camera) { m_camera = camera; }
 
-		glm::mat4 GetViewProjectionMatrix() { return m_camera->GetProjMatrix() * m_camera->GetViewMatrix(); }
-		glm::mat4 GetViewMatrix() { return m_camera->GetViewMatrix(); }
-		glm::mat4 GetProjectionMatrix() { return m_camera->GetProjMatrix(); }
+		/** @return the light camera's matrices, or the identity if the camera has been destroyed */
+		glm::mat4 GetViewProjectionMatrix();
+		glm::mat4 GetViewMatrix();
+		glm::mat4 GetProjectionMatrix();
 
-		void MainLogic() override;
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
 
 		//@TODO: Add a "follow" object, so the shadow camera follows the main camera
 
 	private:
 		glm::vec3 m_colour;
-		std::shared_ptr<Camera> m_camera;
+		Handle<Camera> m_camera;
 	};
 }
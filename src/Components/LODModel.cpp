@@ -4,26 +4,22 @@
 #include <Core\FrameTime.h>
 #include <Core\GameObject.h>
 #include <Core\Input.h>
-#include <GL/glew.h>
+#include <Core\Profiler.h>
+#include <Rendering\RenderSnapshot.h>
 #include <glm/gtx/euler_angles.hpp>
 #include <algorithm>
 #include <fstream>
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
-	const float LODModel::STIPPLE_PATTERN[16] = {
-		1.0f/17.0f,  9.0f/17.0f,  3.0f/17.0f,  11.0f/17.0f,
-		13.0f/17.0f, 5.0f/17.0f,  15.0f/17.0f, 7.0f/17.0f,
-		4.0f/17.0f,  12.0f/17.0f, 2.0f/17.0f,  10.0f/17.0f,
-		16.0f/17.0f, 8.0f/17.0f,  14.0f/17.0f, 6.0f/17.0f
-	};
 	const float LODModel::TRANSITION_DURATION_S = 0.0f;
 
 	std::vector<LODValue> LODModel::m_lodValues;
 	uint LODModel::m_instanceCount = 0;
 	float LODModel::m_totalCost = 0;
 	float LODModel::m_maxCost = 10000;
-	std::weak_ptr<GameObject> LODModel::m_referenceObj;
+	Handle<GameObject> LODModel::m_referenceObj;
 	bool LODModel::m_useReferenceObj = false;
 	
 	void LODModel::Load(std::string modelName)
@@ -48,24 +44,12 @@ namespace snes
 
 		for (int i = 0; i < totalModels; i++)
 		{
-			// Read current LOD mesh file
-			std::getline(lodFile, line);
-			auto mesh = Mesh::GetMesh(line.c_str());
-			if (mesh)
-			{
-				m_meshes.push_back(mesh);
-
-				float costCoefficient = 1;
-				float costCoefficient2 = 1;
-
-				float cost = mesh->GetNumFaces() * costCoefficient + mesh->GetVertexCount() * costCoefficient2;
-				m_costs.push_back(cost);
-			}
-
-			// Read current LOD material file
-			std::getline(lodFile, line);
-			m_materials.push_back(Material::CreateMaterial(line.c_str()));
-			m_shadowMaterials.push_back(Material::CreateShadowMaterial(line.c_str()));
+			// Read current LOD mesh and material files
+			std::string meshPath;
+			std::string materialPath;
+			std::getline(lodFile, meshPath);
+			std::getline(lodFile, materialPath);
+			AddLOD(meshPath, materialPath);
 		}
 
 		if (m_meshes.size() == 0)
@@ -74,26 +58,50 @@ namespace snes
 			std::cout << "Error: No LOD meshes loaded for model name " << modelName << std::endl;
 			return;
 		}
+	}
 
-		m_currentMesh = m_meshes.size() - 1;
+	void LODModel::AddLOD(const std::string& meshPath, const std::string& materialPath)
+	{
+		auto mesh = Mesh::GetMesh(meshPath.c_str());
+		if (mesh)
+		{
+			m_meshes.push_back(mesh);
+
+			float costCoefficient = 1;
+			float costCoefficient2 = 1;
+
+			float cost = mesh->GetNumFaces() * costCoefficient + mesh->GetVertexCount() * costCoefficient2;
+			m_costs.push_back(cost);
+		}
+
+		m_materials.push_back(Material::CreateMaterial(materialPath.c_str()));
+		m_shadowMaterials.push_back(Material::CreateShadowMaterial(materialPath.c_str()));
+		m_lodFiles.push_back(std::make_pair(meshPath, materialPath));
+
+		if (m_meshes.size() > 0)
+		{
+			m_currentMesh = m_meshes.size() - 1;
+		}
 	}
 
 	int LODModel::GetCurrentLOD() const
 	{
-		if (m_meshes.size() == 0 || m_camera.expired())
+		Camera* camera = m_camera.Get();
+		if (m_meshes.size() == 0 || !camera)
 		{
 			return -1;
 		}
 
 		// Use heuristics to determine the best mesh to show
 		glm::vec3 cameraPos;
-		if (m_useReferenceObj)
+		GameObject* referenceObj = m_referenceObj.Get();
+		if (m_useReferenceObj && referenceObj)
 		{
-			cameraPos = m_referenceObj.lock()->GetTransform().GetWorldPosition();
+			cameraPos = referenceObj->GetTransform().GetWorldPosition();
 		}
 		else
 		{
-			cameraPos = m_camera.lock()->GetTransform().GetWorldPosition();
+			cameraPos = camera->GetTransform().GetWorldPosition();
 		}
 
 		float distanceToCamera = glm::length(m_transform.GetWorldPosition() - cameraPos);
@@ -124,164 +132,60 @@ namespace snes
 		}
 	}
 
-	void LODModel::MainDraw(RenderPass renderPass, Camera& camera)
+	void LODModel::MainDraw(RenderSnapshot& snapshot)
 	{
-		if (renderPass == GEOMETRY_PASS)
+		if (m_currentMesh != m_lastRenderedMesh && m_transitionRemainingS <= 0.0f)
 		{
-			if (m_currentMesh != m_lastRenderedMesh && m_transitionRemainingS <= 0.0f)
-			{
-				// The displayed mesh has changed - begin a transition
-				m_transitioningFromMesh = m_lastRenderedMesh;	// Set the last mesh as one to fade out
-				m_lastRenderedMesh = m_currentMesh;
-				m_transitionRemainingS = TRANSITION_DURATION_S;
-			}
+			// The displayed mesh has changed - begin a transition
+			m_transitioningFromMesh = m_lastRenderedMesh;	// Set the last mesh as one to fade out
+			m_lastRenderedMesh = m_currentMesh;
+			m_transitionRemainingS = TRANSITION_DURATION_S;
 		}
 
-		DrawCurrentMesh(renderPass, camera);
-
-		if (m_transitionRemainingS > 0.0f)
-		{
-			// Draw previously selected mesh if transitioning
-			DrawLastMesh(renderPass, camera);
-		}
-
-		glDisable(GL_POLYGON_STIPPLE);
-
-		// Unbind the VBO and VAO
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
-	}
-
-	void LODModel::DrawCurrentMesh(RenderPass renderPass, Camera& camera)
-	{
-		Material* material = m_materials[m_lastRenderedMesh].get();
-
-		if (renderPass == SHADOW_PASS)
+		DrawItem& current = snapshot.AddItem(m_meshes[m_lastRenderedMesh], m_materials[m_lastRenderedMesh], m_transform);
+		Camera* lodCamera = m_camera.Get();
+		if (lodCamera)
 		{
-			//material = m_shadowMaterials[m_lastRenderedMesh].get();
+			current.useLodCamera = true;
+			current.lodCamera = CameraState::Capture(*lodCamera);
 		}
 
-		PrepareTransformUniforms(camera, material);
-		material->PrepareForRendering(m_transform, *m_camera.lock(), *m_meshes[m_lastRenderedMesh]);
-		m_meshes[m_lastRenderedMesh]->PrepareForRendering();
-
 		if (m_transitionRemainingS > 0.0f)
 		{
-			glEnable(GL_POLYGON_STIPPLE);
+			// Fade the selected mesh in, and draw the previously selected mesh in the gaps so it fades out
 			float opacity = 1.0f - (m_transitionRemainingS / TRANSITION_DURATION_S);
-			GenerateStipplePattern(opacity, m_stipplePattern);
-			glPolygonStipple(m_stipplePattern);
-		}
+			current.stippled = true;
+			current.stippleOpacity = opacity;
 
-		// Draw the mesh
-		if (material->GetUsePatches())
-		{
-			glDrawArrays(GL_PATCHES, 0, m_meshes[m_lastRenderedMesh]->GetVertexCount());
-		}
-		else
-		{
-			glDrawArrays(GL_TRIANGLES, 0, m_meshes[m_lastRenderedMesh]->GetVertexCount());
+			DrawItem& last = snapshot.AddItem(m_meshes[m_transitioningFromMesh], m_materials[m_transitioningFromMesh], m_transform);
+			last.stippled = true;
+			last.stippleOpacity = opacity;
+			last.invertStipple = true;
 		}
-
 	}
 
-	void LODModel::DrawLastMesh(RenderPass renderPass, Camera& camera)
+	Handle<Mesh> LODModel::GetMesh(uint lodLevel) const
 	{
-		Material* material = m_materials[m_transitioningFromMesh].get();
-
-		if (renderPass == SHADOW_PASS)
-		{
-			//material = m_shadowMaterials[m_transitioningFromMesh].get();
-		}
-
-		PrepareTransformUniforms(camera, material);
-		material->PrepareForRendering(m_transform, camera, *m_meshes[m_transitioningFromMesh]);
-		m_meshes[m_transitioningFromMesh]->PrepareForRendering();
-
-		if (m_transitionRemainingS > 0.0f)
-		{
-			glEnable(GL_POLYGON_STIPPLE);
-			float opacity = m_transitionRemainingS / TRANSITION_DURATION_S;
-			// Render last mesh with an inverted stipple pattern so that it can fade out while the other mesh fades in, while keeping the object as a whole opaque
-			InvertStipplePattern(m_stipplePattern);
-			glPolygonStipple(m_stipplePattern);
-		}
-
-		// Draw the mesh
-		if (material->GetUsePatches())
+		if (lodLevel < m_meshes.size())
 		{
-			glDrawArrays(GL_PATCHES, 0, m_meshes[m_transitioningFromMesh]->GetVertexCount());
+			return m_meshes[lodLevel].get();
 		}
 		else
 		{
-			glDrawArrays(GL_TRIANGLES, 0, m_meshes[m_transitioningFromMesh]->GetVertexCount());
+			// No valid mesh chosen, return null handle
+			return Handle<Mesh>();
 		}
 	}
 
-	void LODModel::GenerateStipplePattern(float opacity, GLubyte patternOut[128])
-	{
-		// Generate a 32x32 stipple pattern from the 4x4 ordered dithering pattern and opacity
-		for (int l = 0; l < 8; l++)
-		{
-			for (int k = 0; k < 4; k++)
-			{
-				for (int i = 0; i < 4; i++)
-				{
-					GLubyte eightBits = 0;
-					for (int j = 0; j < 4; j++)
-					{
-						if (opacity > STIPPLE_PATTERN[(4 * k) + j])
-						{
-							eightBits = eightBits | (1 << j);
-							eightBits = eightBits | (1 << (j + 4));
-						}
-					}
-					patternOut[(16 * l) + (4 * k) + i] = eightBits;
-				}
-			}
-		}
-	}
-
-	void LODModel::InvertStipplePattern(GLubyte patternOut[128])
-	{
-		// Invert the bits of the stipple pattern
-		for (int i = 0; i < 128; i++)
-		{
-			patternOut[i] = patternOut[i] ^ 255;
-		}
-	}
-
-	void LODModel::PrepareTransformUniforms(Camera& camera, Material* mat)
-	{
-		auto transform = m_gameObject.GetTransform();
-		glm::mat4 scale = glm::scale(glm::mat4(1.0f), transform.GetWorldScale());
-		glm::mat4 translate = glm::translate(glm::mat4(1.0f), transform.GetWorldPosition());
-		glm::vec3 eulerAngles = transform.GetWorldRotationRadians();
-		glm::mat4 eulerRotation = glm::eulerAngleYXZ(eulerAngles.y, eulerAngles.x, eulerAngles.z);
-
-		glm::mat4 modelMat = translate * eulerRotation * scale;
-		glm::mat4 viewMat = camera.GetViewMatrix();
-		glm::mat4 projMat = camera.GetProjMatrix();
-
-		mat->ApplyTransformUniforms(modelMat, viewMat, projMat);
-	}
-
-	const std::weak_ptr<Mesh> LODModel::GetMesh(uint lodLevel) const
+	void LODModel::PickBestMesh()
 	{
-		if (lodLevel < m_meshes.size())
-		{
-			return m_meshes[lodLevel];
-		}
-		else
+		Camera* camera = m_camera.Get();
+		if (!camera)
 		{
-			// No valid mesh chosen, return null pointer
-			return std::weak_ptr<Mesh>();
+			return;
 		}
-	}
 
-	void LODModel::PickBestMesh()
-	{
-		float distanceFromCamera = glm::length(m_camera.lock()->GetTransform().GetWorldPosition() - m_transform.GetWorldPosition());
+		float distanceFromCamera = glm::length(camera->GetTransform().GetWorldPosition() - m_transform.GetWorldPosition());
 
 		m_currentMesh = m_meshes.size() - 1;
 		if (distanceFromCamera < 200)
@@ -330,7 +234,14 @@ namespace snes
 	float LODModel::GetScreenSizeOfMesh(int index)
 	{
 		//https://stackoverflow.com/questions/21648630/radius-of-projected-sphere-in-screen-space
-		float fovy = m_camera.lock()->GetVerticalFoV();
+		Camera* camera = m_camera.Get();
+		if (!camera)
+		{
+			// No camera to measure from, so treat it as being inside the mesh and show the highest LOD
+			return -1.0f;
+		}
+
+		float fovy = camera->GetVerticalFoV();
 
 		// Get the radius of the mesh's encapsulating sphere
 		glm::vec3 worldScale = m_transform.GetWorldScale();
@@ -340,13 +251,14 @@ namespace snes
 		// Get the distance between the camera and the mesh's origin
 		/** Find distance from camera or distance from reference object? */
 		glm::vec3 cameraPos;
-		if (m_useReferenceObj)
+		GameObject* referenceObj = m_referenceObj.Get();
+		if (m_useReferenceObj && referenceObj)
 		{
-			cameraPos = m_referenceObj.lock()->GetTransform().GetWorldPosition();
+			cameraPos = referenceObj->GetTransform().GetWorldPosition();
 		}
 		else
 		{
-			cameraPos = m_camera.lock()->GetTransform().GetWorldPosition();
+			cameraPos = camera->GetTransform().GetWorldPosition();
 		}
 
 		float d = glm::length(m_transform.GetWorldPosition() - cameraPos);
@@ -370,7 +282,7 @@ namespace snes
 		m_totalCost = 0;
 	}
 
-	void LODModel::SortAndSetLODValues()
+	void LODModel::PollInput()
 	{
 		if (Input::GetKeyDown('-'))
 		{
@@ -384,7 +296,12 @@ namespace snes
 		{
 			m_useReferenceObj = !m_useReferenceObj;
 		}
-		
+	}
+
+	void LODModel::SortAndSetLODValues()
+	{
+		PROFILE_FUNCTION();
+
 		// Sort m_lodValues by value
 		std::sort(m_lodValues.begin(), m_lodValues.end(), [](const LODValue& a, const LODValue& b)
 		{
@@ -420,4 +337,27 @@ namespace snes
 		m_totalCost += m_shownMeshCost;
 
 	}
-}
+
+	void LODModel::SaveSnapshot(SnapshotWriter& writer)
+	{
+		writer.WriteComponentRef(m_camera.Get());
+		writer.Write<uint32>((uint32)m_lodFiles.size());
+		for (const auto& lodFiles : m_lodFiles)
+		{
+			writer.WriteAsset(SNAPSHOT_ASSET_MESH, lodFiles.first);
+			writer.WriteAsset(SNAPSHOT_ASSET_MATERIAL, lodFiles.second);
+		}
+	}
+
+	void LODModel::LoadSnapshot(SnapshotReader& reader)
+	{
+		m_camera = reader.ReadComponentRef<Camera>();
+		uint32 lodCount = reader.Read<uint32>();
+		for (uint32 i = 0; i < lodCount && !reader.HasFailed(); i++)
+		{
+			std::string meshPath = reader.ReadAsset();
+			std::string materialPath = reader.ReadAsset();
+			AddLOD(meshPath, materialPath);
+		}
+	}
+}
\ No newline at end of file
@@ -22,30 +22,38 @@ namespace snes
 		LODModel(GameObject& gameObject) : Component(gameObject) { m_instanceCount++; };
 		~LODModel() { m_instanceCount--; };
 
+		/** LOD valuation sorts every LOD in the scene, so it runs at 10Hz rather than on every fixed step */
+		static constexpr uint FIXED_LOGIC_RATE = 10;
+
 		/** Load meshes of all LODs starting with "meshName0.obj" */
 		void Load(std::string modelName);
+		/** Add the next lowest level of detail from a mesh and material file */
+		void AddLOD(const std::string& meshPath, const std::string& materialPath);
 
 		/** Sets the camera from which to render the mesh */
-		void SetCamera(std::weak_ptr<Camera> camera) { m_camera = camera; }
-		void SetReferenceObject(std::weak_ptr<GameObject> object) { m_referenceObj = object; }
+		void SetCamera(Handle<Camera> camera) { m_camera = camera; }
+		void SetReferenceObject(Handle<GameObject> object) { m_referenceObj = object; }
 		void SetCurrentLOD(uint index);
 
 		void FixedLogic() override;
 		void MainLogic() override;
-		void MainDraw(RenderPass renderPass, Camera& camera) override;
+		void MainDraw(RenderSnapshot& snapshot) override;
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
 
 		/** Return the index of the best LOD to show */
 		int GetCurrentLOD() const;
 		int GetLODCount() const { return m_meshes.size(); }
 
-		const std::weak_ptr<Mesh> GetMesh(uint lodLevel) const;
+		Handle<Mesh> GetMesh(uint lodLevel) const;
 
 	public:
+		/** Handle the LOD debug keys. Called on every fixed step, so presses aren't missed between valuations */
+		static void PollInput();
 		static void StartNewFrame();
 		static void SortAndSetLODValues();
 
 	private:
-		const static float STIPPLE_PATTERN[16];
 		/** The transition duration in seconds */
 		const static float TRANSITION_DURATION_S;
 		/** List of the value (benefit/cost) for every LOD of every mesh in the scene */
@@ -58,14 +66,6 @@ namespace snes
 		static float m_maxCost;
 
 	private:
-		void DrawCurrentMesh(RenderPass renderPass, Camera& camera);
-		/** Draw the last mesh with a stipple effect fading out */
-		void DrawLastMesh(RenderPass renderPass, Camera& camera);
-		/** Generate a stipple pattern between 0 (invisible) and 1 (visible) */
-		void GenerateStipplePattern(float opacity, GLubyte patternOut[128]);
-		void InvertStipplePattern(GLubyte patternOut[128]);
-		/** Calculate the model/view/proj matrices and apply them to the material */
-		void PrepareTransformUniforms(Camera& camera, Material* mat);
 		/** Cost/Benefit method for finding the best LOD to show */
 		int CalculateEachLODValue();
 		/** Very cheap and probably incorrect estimation of what LOD to show */
@@ -74,8 +74,8 @@ namespace snes
 		void SetCurrentLOD(LODValue& lodValue);
 
 		/** The camera to render the mesh from */
-		std::weak_ptr<Camera> m_camera;
-		static std::weak_ptr<GameObject> m_referenceObj;
+		Handle<Camera> m_camera;
+		static Handle<GameObject> m_referenceObj;
 		static bool m_useReferenceObj;
 
 		/** List of meshes
@@ -85,6 +85,8 @@ namespace snes
 		std::vector<std::shared_ptr<Material>> m_materials;
 		std::vector<std::shared_ptr<Material>> m_shadowMaterials;
 		std::vector<float> m_costs;
+		/** The mesh and material file of each LOD, for saving to scene snapshots */
+		std::vector<std::pair<std::string, std::string>> m_lodFiles;
 
 		/** Distance from camera that the lowest LOD is used */
 		float m_distanceLow = 100;
@@ -101,8 +103,6 @@ namespace snes
 		/** The index of the mesh being transitioned from */
 		uint m_transitioningFromMesh = 0;
 
-		GLubyte m_stipplePattern[128] = { 0 };
-
 		/** The time remaining until the transition from one LOD to another is finished (in seconds) */
 		float m_transitionRemainingS = 0.0f;
 		/** The cost of the currently selected mesh */
@@ -1,9 +1,10 @@
 #include "stdafx.h"
 #include "MeshRenderer.h"
 #include <Core\GameObject.h>
-#include <GL/glew.h>
+#include <Rendering\RenderSnapshot.h>
 #include <glm/gtx/euler_angles.hpp>
 #include <fstream>
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
@@ -18,39 +19,33 @@ namespace snes
 	{
 	}
 
-	void MeshRenderer::MainDraw(RenderPass renderPass, Camera& camera)
+	void MeshRenderer::MainDraw(RenderSnapshot& snapshot)
 	{
 		if ( !m_material.get() || !m_mesh.get())
 		{
 			return;
 		}
 
-		m_mesh->PrepareForRendering();
-
-		// Set up shaders and uniforms
-		m_material->PrepareForRendering();
-		PrepareTransformUniforms(camera);
-
-		// Draw the mesh
-		glDrawArrays(GL_TRIANGLES, 0, m_mesh->GetVertexCount());
-
-		/** Unbind the VBO and VAO */
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		snapshot.AddItem(m_mesh, m_material, m_transform);
 	}
 
-	void MeshRenderer::PrepareTransformUniforms(Camera& camera)
+	void MeshRenderer::SaveSnapshot(SnapshotWriter& writer)
 	{
-		auto transform = m_gameObject.GetTransform();
-		glm::mat4 scale = glm::scale(glm::mat4(1.0f), transform.GetWorldScale());
-		glm::mat4 translate = glm::translate(glm::mat4(1.0f), transform.GetWorldPosition());
-		glm::vec3 eulerAngles = transform.GetWorldRotationRadians();
-		glm::mat4 eulerRotation = glm::eulerAngleYXZ(eulerAngles.y, eulerAngles.x, eulerAngles.z);
-
-		glm::mat4 modelMat = translate * eulerRotation * scale;
-		glm::mat4 viewMat = camera.GetViewMatrix();
-		glm::mat4 projMat = camera.GetProjMatrix();
+		// Materials are created in code rather than loaded from a file, so only the mesh is saved
+		writer.WriteComponentRef(m_camera.Get());
+		writer.Write<bool>(!m_meshPath.empty());
+		if (!m_meshPath.empty())
+		{
+			writer.WriteAsset(SNAPSHOT_ASSET_MESH, m_meshPath);
+		}
+	}
 
-		m_material->ApplyTransformUniforms(modelMat, viewMat, projMat);
+	void MeshRenderer::LoadSnapshot(SnapshotReader& reader)
+	{
+		m_camera = reader.ReadComponentRef<Camera>();
+		if (reader.Read<bool>())
+		{
+			SetMesh(reader.ReadAsset().c_str());
+		}
 	}
-}
+}
\ No newline at end of file
@@ -11,14 +11,16 @@ namespace snes
 		MeshRenderer(GameObject& gameObject);
 		~MeshRenderer();
 
-		void MainDraw(RenderPass renderPass, Camera& camera) override;
+		void MainDraw(RenderSnapshot& snapshot) override;
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
 
 		/** Sets the mesh to be rendered */
-		void SetMesh(const char* meshFile) { m_mesh = Mesh::GetMesh(meshFile); }
+		void SetMesh(const char* meshFile) { m_meshPath = meshFile; m_mesh = Mesh::GetMesh(meshFile); }
 		/** Returns the mesh */
-		const std::weak_ptr<Mesh> GetMesh() const { return m_mesh; }
+		Handle<Mesh> GetMesh() const { return m_mesh.get(); }
 		/** Sets the camera from which to render the mesh */
-		void SetCamera(std::weak_ptr<Camera> camera) { m_camera = camera; }
+		void SetCamera(Handle<Camera> camera) { m_camera = camera; }
 
 		/** Creates a material for the mesh renderer and returns a weak_ptr to it */
 		template <typename T>
@@ -34,13 +36,12 @@ namespace snes
 		void SetMaterial(std::shared_ptr<T> material) { m_material = material; }
 
 	private:
-		/** Prepare the transformation matrices (MVP) and send them to the shader */
-		void PrepareTransformUniforms(Camera& camera);
-
 		/** The mesh to be rendered */
 		std::shared_ptr<Mesh> m_mesh;
+		/** The file the mesh was loaded from, for saving to scene snapshots */
+		std::string m_meshPath;
 		/** The camera to render the mesh from */
-		std::weak_ptr<Camera> m_camera;
+		Handle<Camera> m_camera;
 		/** The material to render the mesh with */
 		std::shared_ptr<Material> m_material;
 	};
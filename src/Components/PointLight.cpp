@@ -1,6 +1,20 @@
 #include "stdafx.h"
 #include "PointLight.h"
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
-}
+	void PointLight::SaveSnapshot(SnapshotWriter& writer)
+	{
+		writer.Write<glm::vec3>(m_colour);
+		writer.Write<float>(m_linearAttenuation);
+		writer.Write<float>(m_quadraticAttenuation);
+	}
+
+	void PointLight::LoadSnapshot(SnapshotReader& reader)
+	{
+		m_colour = reader.Read<glm::vec3>();
+		m_linearAttenuation = reader.Read<float>();
+		m_quadraticAttenuation = reader.Read<float>();
+	}
+}
\ No newline at end of file
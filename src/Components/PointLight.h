@@ -25,6 +25,9 @@ namespace snes
 		/** @return the quadratic attenuation of the pointlight */
 		float GetQuadraticAttenuation() { return m_quadraticAttenuation; }
 
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
+
 	private:
 		glm::vec3 m_colour;
 		float m_linearAttenuation = 0.1f;
@@ -4,12 +4,13 @@
 #include <Core\GameObject.h>
 #include <Core\FrameTime.h>
 #include <algorithm>
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
 	void Rigidbody::FixedLogic()
 	{
-		//m_velocity.y -= 9.81f * FrameTime::SECONDS_PER_FIXED_LOOP;
+		//m_velocity.y -= 9.81f * FrameTime::GetFixedTimeStep();
 		ApplyDrag();
 		UpdatePosition();
 	}
@@ -18,27 +19,27 @@ namespace snes
 	{
 		if (m_velocity.x > 0)
 		{
-			m_velocity.x = std::max(m_velocity.x - m_drag.x * FrameTime::SECONDS_PER_FIXED_LOOP, 0.0f);
+			m_velocity.x = std::max(m_velocity.x - m_drag.x * FrameTime::GetFixedTimeStep(), 0.0f);
 		}
 		else if (m_velocity.x < 0)
 		{
-			m_velocity.x = std::min(m_velocity.x + m_drag.x * FrameTime::SECONDS_PER_FIXED_LOOP, 0.0f);
+			m_velocity.x = std::min(m_velocity.x + m_drag.x * FrameTime::GetFixedTimeStep(), 0.0f);
 		}
 		if (m_velocity.y > 0)
 		{
-			m_velocity.y = std::max(m_velocity.y - m_drag.y * FrameTime::SECONDS_PER_FIXED_LOOP, 0.0f);
+			m_velocity.y = std::max(m_velocity.y - m_drag.y * FrameTime::GetFixedTimeStep(), 0.0f);
 		}
 		else if (m_velocity.y < 0)
 		{
-			m_velocity.y = std::min(m_velocity.y + m_drag.y * FrameTime::SECONDS_PER_FIXED_LOOP, 0.0f);
+			m_velocity.y = std::min(m_velocity.y + m_drag.y * FrameTime::GetFixedTimeStep(), 0.0f);
 		}
 		if (m_velocity.z > 0)
 		{
-			m_velocity.z = std::max(m_velocity.z - m_drag.z * FrameTime::SECONDS_PER_FIXED_LOOP, 0.0f);
+			m_velocity.z = std::max(m_velocity.z - m_drag.z * FrameTime::GetFixedTimeStep(), 0.0f);
 		}
 		else if (m_velocity.z < 0)
 		{
-			m_velocity.z = std::min(m_velocity.z + m_drag.z * FrameTime::SECONDS_PER_FIXED_LOOP, 0.0f);
+			m_velocity.z = std::min(m_velocity.z + m_drag.z * FrameTime::GetFixedTimeStep(), 0.0f);
 		}
 	}
 
@@ -50,13 +51,13 @@ namespace snes
 	/** Swept AABB Collision using Minkowski's difference */
 	void Rigidbody::HandleCollision(GameObject& other)
 	{
-		std::shared_ptr<Rigidbody> otherRB = other.GetComponent<Rigidbody>();
+		Rigidbody* otherRB = other.GetComponent<Rigidbody>();
 		if (!otherRB)
 		{
 			return;
 		}
-		std::shared_ptr<AABBCollider> thisCollider = m_gameObject.GetComponent<AABBCollider>();
-		std::shared_ptr<AABBCollider> otherCollider = other.GetComponent<AABBCollider>();
+		AABBCollider* thisCollider = m_gameObject.GetComponent<AABBCollider>();
+		AABBCollider* otherCollider = other.GetComponent<AABBCollider>();
 
 		if (!thisCollider || !otherCollider)
 		{
@@ -133,7 +134,7 @@ namespace snes
 	{
 		if (!m_lockPosition)
 		{
-			m_transform.Translate(m_velocity * FrameTime::SECONDS_PER_FIXED_LOOP);
+			m_transform.Translate(m_velocity * FrameTime::GetFixedTimeStep());
 		}
 		else
 		{
@@ -159,4 +160,20 @@ namespace snes
 	{
 		m_drag = vel;
 	}
-}
+
+	void Rigidbody::SaveSnapshot(SnapshotWriter& writer)
+	{
+		writer.Write<glm::vec3>(m_velocity);
+		writer.Write<glm::vec3>(m_drag);
+		writer.Write<float>(m_maxLateralSpeed);
+		writer.Write<bool>(m_lockPosition);
+	}
+
+	void Rigidbody::LoadSnapshot(SnapshotReader& reader)
+	{
+		m_velocity = reader.Read<glm::vec3>();
+		m_drag = reader.Read<glm::vec3>();
+		m_maxLateralSpeed = reader.Read<float>();
+		m_lockPosition = reader.Read<bool>();
+	}
+}
\ No newline at end of file
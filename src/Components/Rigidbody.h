@@ -18,6 +18,8 @@ namespace snes
 
 		void FixedLogic() override;
 		void OnCollision(GameObject& other) override;
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
 
 		/** Check if this object has intersected with the other object,
 		  * and push them apart if the have, triggering OnCollision() for each object. */
@@ -2,6 +2,7 @@
 #include "SphereCollider.h"
 #include "AABBCollider.h"
 #include <glm/gtx/norm.hpp>
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
@@ -73,4 +74,16 @@ namespace snes
 
 		return glm::length2(distance) < (radiusSum * radiusSum);
 	}
-}
+
+	void SphereCollider::SaveSnapshot(SnapshotWriter& writer)
+	{
+		writer.Write<glm::vec3>(m_center);
+		writer.Write<float>(m_radius);
+	}
+
+	void SphereCollider::LoadSnapshot(SnapshotReader& reader)
+	{
+		m_center = reader.Read<glm::vec3>();
+		m_radius = reader.Read<float>();
+	}
+}
\ No newline at end of file
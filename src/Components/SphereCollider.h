@@ -13,12 +13,15 @@ namespace snes
 		/** Set the center and radius of this bounding sphere */
 		void SetBounds(glm::vec3 center, float radius);
 
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
+
 		/** Return whether this bounding box intersects with target collider */
 		bool Intersects(const AABBCollider& target) const override;
 		bool Intersects(const SphereCollider& target) const override;
 
 	private:
-		glm::vec3 m_center;
-		float m_radius;
+		glm::vec3 m_center = glm::vec3(0.0f);
+		float m_radius = 0.0f;
 	};
 }
@@ -4,14 +4,15 @@
 #include <Core\FrameTime.h>
 #include <Core\GameObject.h>
 #include <Core\Input.h>
-#include <GL/glew.h>
+#include <Rendering\RenderSnapshot.h>
 #include <glm/gtx/euler_angles.hpp>
 #include <algorithm>
 #include <fstream>
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
-	std::weak_ptr<GameObject> TessModel::m_referenceObj;
+	Handle<GameObject> TessModel::m_referenceObj;
 
 	bool TessModel::m_useReferenceObj = false;
 	
@@ -27,76 +28,64 @@ namespace snes
 			return;
 		}
 		
-		// Read current LOD mesh file
-		std::string line;
-		std::getline(modelFile, line);
-		m_mesh = Mesh::GetMesh(line.c_str(), true);
+		// Read mesh and material files
+		std::string meshPath;
+		std::string materialPath;
+		std::getline(modelFile, meshPath);
+		std::getline(modelFile, materialPath);
+		SetModel(meshPath, materialPath);
+	}
+
+	void TessModel::SetModel(const std::string& meshPath, const std::string& materialPath)
+	{
+		m_meshPath = meshPath;
+		m_materialPath = materialPath;
+
+		m_mesh = Mesh::GetMesh(meshPath.c_str(), true);
 		if (!m_mesh)
 		{
-			std::cout << "Error opening mesh file: " << line << std::endl;
+			std::cout << "Error opening mesh file: " << meshPath << std::endl;
 			return;
 		}
 
-		// Read current LOD material file
-		std::getline(modelFile, line);
-		m_material = Material::CreateMaterial(line.c_str());
+		m_material = Material::CreateMaterial(materialPath.c_str());
 		if (!m_material)
 		{
-			std::cout << "Error opening material file: " << line << std::endl;
+			std::cout << "Error opening material file: " << materialPath << std::endl;
 			return;
 		}
-		m_shadowMaterial = Material::CreateShadowMaterial(line.c_str());
+		m_shadowMaterial = Material::CreateShadowMaterial(materialPath.c_str());
 	}
 
-	void TessModel::FixedLogic()
+	void TessModel::MainDraw(RenderSnapshot& snapshot)
 	{
-	}
-
-	void TessModel::MainLogic()
-	{
-	}
-
-	void TessModel::MainDraw(RenderPass renderPass, Camera& camera)
-	{
-		Material* material = m_material.get();
-
-		if (renderPass == SHADOW_PASS)
+		if (!m_material.get() || !m_mesh.get())
 		{
-			//material = m_shadowMaterial.get();
+			return;
 		}
 
-		this->PrepareTransformUniforms(camera, material);
-		material->PrepareForRendering(m_transform, camera, *m_mesh);
-		m_mesh->PrepareForRendering();
+		snapshot.AddItem(m_mesh, m_material, m_transform);
+	}
 
-		// Draw the mesh
-		if (material->GetUsePatches())
-		{
-			glDrawArrays(GL_PATCHES, 0, m_mesh->GetVertexCount());
-		}
-		else
+	void TessModel::SaveSnapshot(SnapshotWriter& writer)
+	{
+		writer.WriteComponentRef(m_camera.Get());
+		writer.Write<bool>(!m_meshPath.empty());
+		if (!m_meshPath.empty())
 		{
-			glDrawArrays(GL_TRIANGLES, 0, m_mesh->GetVertexCount());
+			writer.WriteAsset(SNAPSHOT_ASSET_MESH_WITH_NEIGHBOURS, m_meshPath);
+			writer.WriteAsset(SNAPSHOT_ASSET_MATERIAL, m_materialPath);
 		}
-
-		// Unbind the VBO and VAO
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
 	}
 
-	void TessModel::PrepareTransformUniforms(Camera& camera, Material* mat)
+	void TessModel::LoadSnapshot(SnapshotReader& reader)
 	{
-		auto transform = m_gameObject.GetTransform();
-		glm::mat4 scale = glm::scale(glm::mat4(1.0f), transform.GetWorldScale());
-		glm::mat4 translate = glm::translate(glm::mat4(1.0f), transform.GetWorldPosition());
-		glm::vec3 eulerAngles = transform.GetWorldRotationRadians();
-		glm::mat4 eulerRotation = glm::eulerAngleYXZ(eulerAngles.y, eulerAngles.x, eulerAngles.z);
-
-		glm::mat4 modelMat = translate * eulerRotation * scale;
-		glm::mat4 viewMat = camera.GetViewMatrix();
-		glm::mat4 projMat = camera.GetProjMatrix();
-
-		mat->ApplyTransformUniforms(modelMat, viewMat, projMat);
+		m_camera = reader.ReadComponentRef<Camera>();
+		if (reader.Read<bool>())
+		{
+			std::string meshPath = reader.ReadAsset();
+			std::string materialPath = reader.ReadAsset();
+			SetModel(meshPath, materialPath);
+		}
 	}
-
-}
+}
\ No newline at end of file
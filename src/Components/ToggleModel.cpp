@@ -6,6 +6,7 @@
 #include <Core\Input.h>
 #include <glm/gtx/euler_angles.hpp>
 #include <algorithm>
+#include <Core\SceneSnapshot.h>
 
 namespace snes
 {
@@ -69,29 +70,58 @@ namespace snes
 
 	void ToggleModel::MainLogic()
 	{
-		m_lodModel.lock()->MainLogic();
+		LODModel* lodModel = m_lodModel.Get();
+		if (lodModel)
+		{
+			lodModel->MainLogic();
+		}
 	}
 
-	void ToggleModel::MainDraw(RenderPass renderPass, Camera& camera)
+	void ToggleModel::MainDraw(RenderSnapshot& snapshot)
 	{
 		if (m_showTessModel)
 		{
-			m_tessModel.lock()->MainDraw(renderPass, camera);
+			TessModel* tessModel = m_tessModel.Get();
+			if (tessModel)
+			{
+				tessModel->MainDraw(snapshot);
+			}
 		}
 		else
 		{
-			auto lodModel = m_lodModel.lock();
+			LODModel* lodModel = m_lodModel.Get();
+			if (!lodModel)
+			{
+				return;
+			}
 			int indexToRender = std::min(m_lodIndex, lodModel->GetLODCount() - 1);
 			lodModel->SetCurrentLOD(indexToRender);
-			lodModel->MainDraw(renderPass, camera);
+			lodModel->MainDraw(snapshot);
 		}
 	}
 
-	void ToggleModel::SetModels(std::weak_ptr<LODModel> lodModel, std::weak_ptr<TessModel> tessModel)
+	void ToggleModel::SetModels(LODModel* lodModel, TessModel* tessModel)
 	{
 		m_lodModel = lodModel;
 		m_tessModel = tessModel;
-		m_lodModel.lock()->Disable();
-		m_tessModel.lock()->Disable();
+		lodModel->Disable();
+		tessModel->Disable();
+	}
+
+	void ToggleModel::SaveSnapshot(SnapshotWriter& writer)
+	{
+		writer.WriteComponentRef(m_lodModel.Get());
+		writer.WriteComponentRef(m_tessModel.Get());
+		writer.Write<int>(m_lodIndex);
+		writer.Write<bool>(m_showTessModel);
+	}
+
+	void ToggleModel::LoadSnapshot(SnapshotReader& reader)
+	{
+		// The models' enabled states are restored by the snapshot, so SetModels() isn't needed here
+		m_lodModel = reader.ReadComponentRef<LODModel>();
+		m_tessModel = reader.ReadComponentRef<TessModel>();
+		m_lodIndex = reader.Read<int>();
+		m_showTessModel = reader.Read<bool>();
 	}
-}
+}
\ No newline at end of file
@@ -15,13 +15,15 @@ namespace snes
 		void FixedLogic() override;
 		void MainLogic() override;
 
-		void MainDraw(RenderPass renderPass, Camera& camera) override;
+		void MainDraw(RenderSnapshot& snapshot) override;
+		void SaveSnapshot(SnapshotWriter& writer) override;
+		void LoadSnapshot(SnapshotReader& reader) override;
 
-		void SetModels(std::weak_ptr<LODModel> lodModel, std::weak_ptr<TessModel> tessModel);
+		void SetModels(LODModel* lodModel, TessModel* tessModel);
 
 	private:
-		std::weak_ptr<LODModel> m_lodModel;
-		std::weak_ptr<TessModel> m_tessModel;
+		Handle<LODModel> m_lodModel;
+		Handle<TessModel> m_tessModel;
 		int m_lodIndex = 0;
 		bool m_showTessModel = false;
 	};
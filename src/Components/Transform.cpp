@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "Transform.h"
+#include <Core\FrameTime.h>
 #include <Core\GameObject.h>
 #include <glm/gtx/euler_angles.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -12,40 +13,146 @@ namespace snes
 		m_localScale = glm::vec3(1.0f);
 		m_localRotation = glm::vec3(0.0f);
 		m_localPosition = glm::vec3(0.0f);
+		m_previousScale = m_localScale;
+		m_previousRotation = m_localRotation;
+		m_previousPosition = m_localPosition;
+		MarkChanged();
 	}
 	
 	Transform::~Transform()
 	{
 	}
 
+	uint64 Transform::m_fixedStep = 0;
+	bool Transform::m_inFixedStep = false;
+	uint64 Transform::m_latestVersion = 0;
+
+	/** Setting a value moves the transform straight there (e.g. spawning or teleporting), so it's never interpolated.
+	  * Relative changes are interpolated if they happen during a fixed step, and applied to the previous state too otherwise */
+
+	void Transform::SetLocalPosition(glm::vec3 position)
+	{
+		SaveFixedStepState();
+		m_localPosition = position;
+		m_previousPosition = position;
+		MarkChanged();
+	}
+
+	void Transform::SetLocalRotation(glm::vec3 rotation)
+	{
+		SaveFixedStepState();
+		m_localRotation = rotation;
+		m_previousRotation = rotation;
+		MarkChanged();
+	}
+
+	void Transform::SetLocalScale(glm::vec3 scale)
+	{
+		SaveFixedStepState();
+		m_localScale = scale;
+		m_previousScale = scale;
+		MarkChanged();
+	}
+
+	void Transform::Translate(glm::vec3 translation)
+	{
+		SaveFixedStepState();
+		m_localPosition += translation;
+		if (!m_inFixedStep)
+		{
+			m_previousPosition += translation;
+		}
+		MarkChanged();
+	}
+
 	void Transform::Rotate(glm::vec3 rotation)
 	{
-		m_localRotation += rotation; m_dirtyTRS = true;
+		SaveFixedStepState();
+		m_localRotation += rotation;
+		if (!m_inFixedStep)
+		{
+			m_previousRotation += rotation;
+		}
+		MarkChanged();
+	}
+
+	void Transform::Scale(glm::vec3 scale)
+	{
+		SaveFixedStepState();
+		m_localScale *= scale;
+		if (!m_inFixedStep)
+		{
+			m_previousScale *= scale;
+		}
+		MarkChanged();
+	}
+
+	glm::mat4 Transform::ComposeTRS(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+	{
+		glm::mat4 scaleMat = glm::scale(glm::mat4(1.0f), scale);
+		glm::mat4 translate = glm::translate(glm::mat4(1.0f), position);
+		glm::vec3 eulerAngles = rotation / (180.0f / 3.14159f);
+		glm::mat4 eulerRotation = glm::eulerAngleYXZ(eulerAngles.y, eulerAngles.x, eulerAngles.z);
+		return translate * eulerRotation * scaleMat;
 	}
 
 	glm::mat4 Transform::GetTRS()
 	{
-		if (m_dirtyTRS)
+		// Rebuild if this transform or any parent has changed since the matrix was cached
+		uint64 version = GetWorldVersion();
+		if (version != m_trsVersion)
 		{
-			glm::mat4 scale = glm::scale(glm::mat4(1.0f), m_localScale);
-			glm::mat4 translate = glm::translate(glm::mat4(1.0f), m_localPosition);
-			glm::vec3 eulerAngles = m_localRotation / (180.0f / 3.14159f);
-			glm::mat4 eulerRotation = glm::eulerAngleYXZ(eulerAngles.y, eulerAngles.x, eulerAngles.z);
+			glm::mat4 local = ComposeTRS(m_localPosition, m_localRotation, m_localScale);
 
 			auto parent = m_gameObject.GetParent();
 			if (parent)
 			{
-				m_trs = parent->GetTransform().GetTRS() * translate * eulerRotation * scale;
+				m_trs = parent->GetTransform().GetTRS() * local;
 			}
 			else
 			{
-				m_trs = translate * eulerRotation * scale;
+				m_trs = local;
 			}
-			m_dirtyTRS = false;
+			m_trsVersion = version;
 		}
 		return m_trs;
 	}
 
+	uint64 Transform::GetWorldVersion() const
+	{
+		auto parent = m_gameObject.GetParent();
+		if (parent)
+		{
+			return std::max(m_version, parent->GetTransform().GetWorldVersion());
+		}
+		return m_version;
+	}
+
+	glm::mat4 Transform::GetRenderMatrix() const
+	{
+		glm::mat4 local;
+		if (m_stateStep == m_fixedStep)
+		{
+			// Changed during the latest fixed step, so blend from where it was before that step
+			float alpha = FrameTime::GetInterpolationAlpha();
+			local = ComposeTRS(
+				glm::mix(m_previousPosition, m_localPosition, alpha),
+				glm::mix(m_previousRotation, m_localRotation, alpha),
+				glm::mix(m_previousScale, m_localScale, alpha));
+		}
+		else
+		{
+			local = ComposeTRS(m_localPosition, m_localRotation, m_localScale);
+		}
+
+		auto parent = m_gameObject.GetParent();
+		if (parent)
+		{
+			return parent->GetTransform().GetRenderMatrix() * local;
+		}
+		return local;
+	}
+
 	glm::vec3 Transform::GetWorldPosition()
 	{
 		// Get position in relation to translate/rotate/scale of parent(s)
@@ -13,10 +13,10 @@ namespace snes
 		Transform(GameObject& gameObject);
 		~Transform();
 
-		/** Set the element of this transform in local space */
-		void SetLocalPosition(glm::vec3 position) { m_localPosition = position; m_dirtyTRS = true; }
-		void SetLocalRotation(glm::vec3 rotation) { m_localRotation = rotation; m_dirtyTRS = true; }
-		void SetLocalScale(glm::vec3 scale) { m_localScale = scale; m_dirtyTRS = true; }
+		/** Set the element of this transform in local space. This moves it straight there, without interpolation */
+		void SetLocalPosition(glm::vec3 position);
+		void SetLocalRotation(glm::vec3 rotation);
+		void SetLocalScale(glm::vec3 scale);
 
 		/** @return the element of this transform in local space */
 		const glm::vec3& GetLocalPosition() const { return m_localPosition; }
@@ -30,23 +30,72 @@ namespace snes
 		glm::vec3 GetWorldScale() const;
 
 		/** Apply a transformation to this transform in local space */
-		void Translate(glm::vec3 translation) { m_localPosition += translation; m_dirtyTRS = true; }
+		void Translate(glm::vec3 translation);
 		void Rotate(glm::vec3 rotation);
-		void Scale(glm::vec3 scale) { m_localScale *= scale; m_dirtyTRS = true; }
+		void Scale(glm::vec3 scale);
 
 		/** @return the transform-rotate-scale matrix of the transform */
 		glm::mat4 GetTRS();
 
+		/** @return a number that changes whenever this transform or any of its parents changes,
+		  * so cached world-space data can be rebuilt only when it's out of date */
+		uint64 GetWorldVersion() const;
+
+		/** @return the world matrix to draw this transform with: its state blended between the previous and current
+		  * fixed step by FrameTime::GetInterpolationAlpha(), so movement stays smooth at any fixed logic rate */
+		glm::mat4 GetRenderMatrix() const;
+
+		/** Mark the start and end of a FixedLogic loop. Translate/Rotate/Scale during a loop are interpolated when drawn;
+		  * changes made outside one (e.g. in MainLogic) are already per-frame, so they show up immediately */
+		static void BeginFixedStep() { ++m_fixedStep; m_inFixedStep = true; }
+		static void EndFixedStep() { m_inFixedStep = false; }
+
 		GameObject& GetGameObject() { return m_gameObject; }
 
 	private:
+		/** Keep the state from the start of the current fixed step, the first time it changes during the step */
+		void SaveFixedStepState()
+		{
+			if (m_inFixedStep && m_stateStep != m_fixedStep)
+			{
+				m_previousPosition = m_localPosition;
+				m_previousRotation = m_localRotation;
+				m_previousScale = m_localScale;
+				m_stateStep = m_fixedStep;
+			}
+		}
+
+		/** Give this transform a new version after a change */
+		void MarkChanged() { m_version = ++m_latestVersion; }
+
+		/** @return a transform-rotate-scale matrix in local space */
+		static glm::mat4 ComposeTRS(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+
+		/** The number of fixed steps begun since startup */
+		static uint64 m_fixedStep;
+		/** Whether a fixed step is running */
+		static bool m_inFixedStep;
+		/** The last version handed out to any transform. Versions only ever increase, so the highest version
+		  * along a parent chain changes whenever any transform in the chain does */
+		static uint64 m_latestVersion;
+
 		glm::vec3 m_localPosition;
 		glm::vec3 m_localRotation;
 		glm::vec3 m_localScale;
 		GameObject& m_gameObject;
 
-		/** Nasty speed-up hack */
+		/** Local state at the start of the fixed step this transform last changed in */
+		glm::vec3 m_previousPosition;
+		glm::vec3 m_previousRotation;
+		glm::vec3 m_previousScale;
+		/** The fixed step the previous state was saved in. The state only needs blending if that's the latest step */
+		uint64 m_stateStep = 0;
+
+		/** The version given to this transform by its last change */
+		uint64 m_version;
+
+		/** The world matrix as of m_trsVersion */
 		glm::mat4 m_trs;
-		bool m_dirtyTRS = true;
+		uint64 m_trsVersion = 0;
 	};
 }
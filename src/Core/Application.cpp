@@ -1,5 +1,12 @@
 #include "stdafx.h"
 #include "Application.h"
+#include "Profiler.h"
+#include <Components\LODModel.h>
+#include <Rendering\DynamicResolution.h>
+#include <Rendering\GLState.h>
+#include <Rendering\GraphicsDevice.h>
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <GL/glew.h>
 #include <GL/freeglut.h>
@@ -28,8 +35,18 @@ namespace snes
 
 	FrameTime Application::m_frameTime;
 	Input Application::m_input;
+	InputRecorder Application::m_inputRecorder;
 	Scene Application::m_currentScene;
 	Screen Application::m_screen;
+	std::atomic<uint64> Application::m_publishedScreenSize(0);
+	std::unique_ptr<StressBenchmark> Application::m_benchmark;
+	RenderSnapshotBuffer Application::m_snapshots;
+	bool Application::m_threaded = false;
+	std::thread Application::m_simulationThread;
+	std::atomic<bool> Application::m_simulating(false);
+	std::atomic<bool> Application::m_exitRequested(false);
+	bool Application::m_lateCameraUpdate = false;
+	uint64 Application::m_reflectedInputSequence = 0;
 
 	GLuint vertexBuffer;
 
@@ -42,15 +59,48 @@ namespace snes
             m_argv.push_back(argv[i]);
         }
 
-        // Get window size from args
+        // Get window size and options from args
         int windowWidth = 1280;
         int windowHeight = 1024;
-		m_screen.SetResolution(windowWidth, windowHeight);
-        if (argc > 1)
-        {
-            windowWidth = std::stoi(argv[0]);
-            windowHeight = std::stoi(argv[1]);
-        }
+		ParseArguments(windowWidth, windowHeight);
+
+		if (!m_replayPath.empty())
+		{
+			if (!m_recordPath.empty())
+			{
+				std::cout << "Warning: --record is ignored while replaying" << std::endl;
+				m_recordPath.clear();
+			}
+			if (m_inputRecorder.LoadReplay(m_replayPath))
+			{
+				Input::SetRecorder(&m_inputRecorder);
+				// The late camera update would mix live mouse movement into the replay
+				m_lateCameraUpdate = false;
+			}
+		}
+		else if (!m_recordPath.empty())
+		{
+			m_inputRecorder.StartRecording();
+			Input::SetRecorder(&m_inputRecorder);
+		}
+
+		if (!m_tracePath.empty())
+		{
+#if SNES_PROFILING
+			// Start before anything loads, so asset loading shows up in the trace
+			Profiler::Start();
+#else
+			std::cout << "Warning: Profiling is compiled out of this build, --trace is ignored" << std::endl;
+#endif
+		}
+		SetScreenSize(windowWidth, windowHeight);
+
+		if (m_headless)
+		{
+			// No window or GL context: GPU work is skipped and counted by GraphicsDevice
+			InitialiseScene();
+			return;
+		}
 
         // Initialise glut and display window
         glutInit(&argc, argv);
@@ -65,6 +115,8 @@ namespace snes
 			std::cout << "ERROR: Cannot initialize glew!";
 			exit(1);
 		}
+		GraphicsDevice::SetAvailable(true);
+		GLState::Invalidate();
 
 		// Set glut input settings
 		glutSetKeyRepeat(GLUT_KEY_REPEAT_OFF);
@@ -82,19 +134,19 @@ namespace snes
 
 
         //glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glEnable(GL_BLEND);
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_CULL_FACE);
+        GLState::SetEnabled(GL_BLEND, true);
+        GLState::SetEnabled(GL_DEPTH_TEST, true);
+        GLState::SetEnabled(GL_CULL_FACE, true);
         glCullFace(GL_BACK);
 
 #if OPENGL_DEBUG == 1
-		glEnable(GL_DEBUG_OUTPUT);
-		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		GLState::SetEnabled(GL_DEBUG_OUTPUT, true);
+		GLState::SetEnabled(GL_DEBUG_OUTPUT_SYNCHRONOUS, true);
 		glDebugMessageCallback(openglCallbackFunction, nullptr);
 		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, NULL, true);
 #endif
 
-		m_currentScene.InitialiseScene();
+		InitialiseScene();
     }
 
 
@@ -102,6 +154,132 @@ namespace snes
     {
     }
 
+	void Application::InitialiseScene()
+	{
+		if (m_runBenchmark)
+		{
+			m_currentScene.InitialiseStressScene(m_stressSettings);
+			m_benchmark = std::make_unique<StressBenchmark>(m_stressSettings, m_frameBudget > 0 ? m_frameBudget : DEFAULT_BENCHMARK_FRAMES);
+		}
+		else
+		{
+			m_currentScene.InitialiseScene(m_scenePath);
+		}
+
+		if (!m_saveScenePath.empty())
+		{
+			m_currentScene.SaveSnapshot(m_saveScenePath);
+		}
+	}
+
+	void Application::ParseArguments(int& outWindowWidth, int& outWindowHeight)
+	{
+		for (uint i = 1; i < m_argv.size(); ++i)
+		{
+			const std::string& arg = m_argv[i];
+			bool hasValue = (i + 1) < m_argv.size();
+
+			if (arg == "--width" && hasValue)
+			{
+				outWindowWidth = std::max(std::atoi(m_argv[++i].c_str()), 1);
+			}
+			else if (arg == "--height" && hasValue)
+			{
+				outWindowHeight = std::max(std::atoi(m_argv[++i].c_str()), 1);
+			}
+			else if (arg == "--scene" && hasValue)
+			{
+				m_scenePath = m_argv[++i];
+			}
+			else if (arg == "--save-scene" && hasValue)
+			{
+				m_saveScenePath = m_argv[++i];
+			}
+			else if (arg == "--headless")
+			{
+				m_headless = true;
+			}
+			else if (arg == "--frames" && hasValue)
+			{
+				m_frameBudget = (uint)std::max(std::atoi(m_argv[++i].c_str()), 0);
+			}
+			else if (arg == "--benchmark")
+			{
+				m_runBenchmark = true;
+			}
+			else if (arg == "--spheres" && hasValue)
+			{
+				m_stressSettings.lodSpheres = (uint)std::max(std::atoi(m_argv[++i].c_str()), 0);
+			}
+			else if (arg == "--lights" && hasValue)
+			{
+				m_stressSettings.pointLights = (uint)std::max(std::atoi(m_argv[++i].c_str()), 0);
+			}
+			else if (arg == "--rigidbodies" && hasValue)
+			{
+				m_stressSettings.rigidbodies = (uint)std::max(std::atoi(m_argv[++i].c_str()), 0);
+			}
+			else if (arg == "--depth" && hasValue)
+			{
+				m_stressSettings.hierarchyDepth = (uint)std::max(std::atoi(m_argv[++i].c_str()), 1);
+			}
+			else if (arg == "--output" && hasValue)
+			{
+				m_benchmarkOutputPath = m_argv[++i];
+			}
+			else if (arg == "--fixed-rate" && hasValue)
+			{
+				FrameTime::SetFixedLogicRate((uint)std::max(std::atoi(m_argv[++i].c_str()), 1));
+			}
+			else if (arg == "--max-fixed-loops" && hasValue)
+			{
+				FrameTime::SetMaxFixedLoopsPerFrame((uint)std::max(std::atoi(m_argv[++i].c_str()), 1));
+			}
+			else if (arg == "--lod-rate" && hasValue)
+			{
+				SystemScheduler::SetTickRate(SystemScheduler::GetSystem<LODModel>(), (uint)std::max(std::atoi(m_argv[++i].c_str()), 0));
+			}
+			else if (arg == "--adaptive-pacing")
+			{
+				FrameTime::UseAdaptivePacing(true);
+			}
+			else if (arg == "--dynamic-resolution" && hasValue)
+			{
+				DynamicResolution::SetTargetGpuTime((float)std::atof(m_argv[++i].c_str()));
+			}
+			else if (arg == "--threaded")
+			{
+				m_threaded = true;
+			}
+			else if (arg == "--low-latency")
+			{
+				m_lateCameraUpdate = true;
+			}
+			else if (arg == "--record" && hasValue)
+			{
+				m_recordPath = m_argv[++i];
+			}
+			else if (arg == "--replay" && hasValue)
+			{
+				m_replayPath = m_argv[++i];
+			}
+			else if (arg == "--trace" && hasValue)
+			{
+				m_tracePath = m_argv[++i];
+			}
+			else if (i == 1 && hasValue && std::isdigit(arg[0]))
+			{
+				// Legacy "<width> <height>" form
+				outWindowWidth = std::max(std::atoi(arg.c_str()), 1);
+				outWindowHeight = std::max(std::atoi(m_argv[++i].c_str()), 1);
+			}
+			else
+			{
+				std::cout << "Warning: Unrecognised argument " << arg << std::endl;
+			}
+		}
+	}
+
 	void Application::Run()
 	{
 		if (m_running)
@@ -111,43 +289,259 @@ namespace snes
 
 		m_running = true;
 
-		glutMainLoop();
+		if (m_headless)
+		{
+			RunHeadless();
+		}
+		else
+		{
+			if (m_threaded)
+			{
+				m_simulating = true;
+				m_simulationThread = std::thread(SimulationLoop);
+			}
+
+			glutMainLoop();
+
+			if (m_simulationThread.joinable())
+			{
+				m_simulating = false;
+				m_simulationThread.join();
+			}
+		}
+
+		if (m_benchmark)
+		{
+			m_benchmark->WriteResults(m_benchmarkOutputPath, m_currentScene);
+			m_benchmark.reset();
+		}
+
+		// Headless frames aren't paced, so there are no stats to report
+		FrameTime::GetStats().Print(std::cout);
+
+		if (m_inputRecorder.IsRecording())
+		{
+			m_inputRecorder.SaveRecording(m_recordPath);
+		}
+		else if (m_inputRecorder.IsReplaying())
+		{
+			std::cout << "Replayed " << m_inputRecorder.GetFrameCount() << " of " << m_inputRecorder.GetReplayLength() << " recorded frames, "
+				<< m_inputRecorder.GetDesyncCount() << " diverged from the recording" << std::endl;
+		}
+		Input::SetRecorder(nullptr);
+
+#if SNES_PROFILING
+		if (!m_tracePath.empty())
+		{
+			Profiler::Stop();
+			Profiler::WriteChromeTrace(m_tracePath);
+		}
+#endif
 
 		m_running = false;
 	}
 
+	void Application::RunHeadless()
+	{
+		auto start = Clock::now();
+		uint frame = 0;
+
+		while (m_running && (m_benchmark ? !m_benchmark->IsFinished() : (m_frameBudget == 0 || frame < m_frameBudget)))
+		{
+			PROFILE_FRAME();
+			if (!StartNewFrame(true))
+			{
+				break;
+			}
+			UpdateScene();
+			m_currentScene.Render(m_snapshots.GetReadSnapshot());
+			if (m_benchmark)
+			{
+				m_benchmark->RecordFrame(m_currentScene);
+			}
+			++frame;
+		}
+
+		std::chrono::duration<double> wallTime = Clock::now() - start;
+		double simulatedTime = frame * (double)FrameTime::GetFixedTimeStep();
+		std::cout << "Headless run: " << frame << " frames, "
+			<< simulatedTime << "s simulated in " << wallTime.count() << "s ("
+			<< (frame > 0 ? wallTime.count() * MS_IN_S / frame : 0.0) << "ms/frame)" << std::endl;
+		std::cout << "Skipped GPU work: " << GraphicsDevice::GetSkippedUploads() << " uploads ("
+			<< GraphicsDevice::GetSkippedUploadBytes() << " bytes), "
+			<< GraphicsDevice::GetSkippedShaders() << " shader programs, "
+			<< GraphicsDevice::GetSkippedDraws() << " frames of draws" << std::endl;
+	}
+
 	void Application::Exit()
 	{
 		m_running = false;
 
-		glutLeaveMainLoop();
+		if (!m_headless)
+		{
+			glutLeaveMainLoop();
+		}
 	}
 
     void Application::Resize(int width, int height)
     {
-		m_screen.SetResolution(width, height);
+		SetScreenSize(width, height);
     }
 
+	void Application::SetScreenSize(int width, int height)
+	{
+		m_screen.SetResolution(width, height);
+		m_publishedScreenSize.store(((uint64)(uint32)width << 32) | (uint32)height);
+	}
+
 	void Application::GetScreenSize(uint& outWidth, uint& outHeight)
 	{
-		outWidth = m_screen.GetWidth();
-		outHeight = m_screen.GetHeight();
+		uint64 size = m_publishedScreenSize.load();
+		outWidth = (uint)(size >> 32);
+		outHeight = (uint)(size & 0xFFFFFFFF);
 	}
 
     void Application::Display()
     {
+		PROFILE_FUNCTION();
+
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glViewport(0, 0, m_screen.GetWidth(), m_screen.GetHeight());
+        GLState::SetViewport(0, 0, m_screen.GetWidth(), m_screen.GetHeight());
 
-		m_currentScene.MainDraw();
+		const RenderSnapshot& snapshot = m_snapshots.GetReadSnapshot();
+		uint64 reflectedSequence = snapshot.inputSequence;
+		if (m_lateCameraUpdate && snapshot.camera.mouseLook != glm::vec2(0.0f))
+		{
+			// Turn the camera by the mouse movement that arrived after the snapshot's logic ran (possibly still waiting for ProcessEvents())
+			uint64 mouseSequence;
+			glm::ivec2 lateTravel = Input::GetQueuedMouseTravel(mouseSequence) - snapshot.mouseTravel;
+			m_currentScene.Render(snapshot, snapshot.camera.WithMouseLook(glm::vec2(lateTravel)));
+			// Only mouse movement is applied early, so keys and buttons queued after the newest move are left to be timed
+			// when the snapshot that applies them is drawn
+			reflectedSequence = std::max(reflectedSequence, mouseSequence);
+		}
+		else
+		{
+			m_currentScene.Render(snapshot);
+		}
+		RecordInputLatency(reflectedSequence, Clock::now());
 
         glutSwapBuffers();
+
+		if (m_benchmark)
+		{
+			m_benchmark->RecordFrame(m_currentScene);
+			if (m_benchmark->IsFinished())
+			{
+				glutLeaveMainLoop();
+			}
+		}
     }
 
+	void Application::RecordInputLatency(uint64 reflectedSequence, Clock::time_point submitted)
+	{
+		if (reflectedSequence <= m_reflectedInputSequence)
+		{
+			// Nothing new since the last frame
+			return;
+		}
+
+		// The oldest event this frame is the first to show, as long as its timestamp is still remembered
+		uint64 oldestSequence = m_reflectedInputSequence + 1;
+		if (reflectedSequence - oldestSequence >= Input::EVENT_TIME_HISTORY)
+		{
+			oldestSequence = reflectedSequence - Input::EVENT_TIME_HISTORY + 1;
+		}
+		m_reflectedInputSequence = reflectedSequence;
+
+		float latencyMs = std::chrono::duration<float, std::milli>(submitted - Input::GetEventTime(oldestSequence)).count();
+		FrameTime::GetStats().RecordInputLatency(latencyMs);
+		PROFILE_COUNTER("Input latency (ms)", latencyMs);
+	}
+
 	void Application::MainLogic()
 	{
-		m_frameTime.StartNewFrame();
+		if (m_threaded)
+		{
+			// The simulation paces itself on its own thread, so only redraw once it has published a new frame
+			if (m_snapshots.WaitForSnapshot(std::chrono::milliseconds(100)))
+			{
+				glutPostRedisplay();
+			}
+		}
+		else
+		{
+			PROFILE_FRAME();
+			PROFILE_FUNCTION();
+
+			if (StartNewFrame(false))
+			{
+				UpdateScene();
+				glutPostRedisplay();
+			}
+			else
+			{
+				m_exitRequested = true;
+			}
+		}
+
+		// Cursor warps and exiting touch the window, so they happen here rather than wherever the scene asked for them
+		Input::ApplyPendingWarp();
+		if (m_exitRequested)
+		{
+			glutLeaveMainLoop();
+		}
+	}
+
+	void Application::SimulationLoop()
+	{
+		while (m_simulating)
+		{
+			PROFILE_FRAME();
+			if (!StartNewFrame(false))
+			{
+				m_exitRequested = true;
+				break;
+			}
+			UpdateScene();
+		}
+	}
+
+	bool Application::StartNewFrame(bool fixedStep)
+	{
+		if (m_inputRecorder.IsReplaying())
+		{
+			if (!m_inputRecorder.BeginReplayedFrame())
+			{
+				return false;
+			}
+			m_frameTime.StartReplayedFrame(m_inputRecorder.GetReplayedFrameDuration());
+			return true;
+		}
+
+		if (fixedStep)
+		{
+			m_frameTime.StartNewFixedFrame();
+		}
+		else
+		{
+			m_frameTime.StartNewFrame();
+		}
+
+		if (m_inputRecorder.IsRecording())
+		{
+			m_inputRecorder.BeginRecordedFrame(FrameTime::GetLastFrameDurationNs());
+		}
+		return true;
+	}
+
+	void Application::UpdateScene()
+	{
+		PROFILE_FUNCTION();
+
+		// Apply the input received since the last frame
+		m_input.ProcessEvents();
 
 		// Run FixedLogic on all components in the scene as many times as necessary
 		for (uint i = 0; i < m_frameTime.GetPendingFixedLogicLoops(); ++i)
@@ -158,15 +552,20 @@ namespace snes
 		// Run MainLogic on all components in the scene
 		m_currentScene.MainLogic();
 
-		// Clear keys pressed up/down
-		m_input.RefreshInputs();
+		// Hand the frame over to be drawn
+		m_currentScene.CaptureRenderState(m_snapshots.GetWriteSnapshot());
+		m_snapshots.Publish();
+
+		// Every event and warp the frame will see has happened by now
+		m_inputRecorder.EndFrame();
 
 		if (m_input.GetKeyDown(GLUT_KEY_DELETE))
 		{
-			glutExit();
+			m_exitRequested = true;
 		}
-		
-		glutPostRedisplay();
+
+		// Clear keys pressed up/down
+		m_input.RefreshInputs();
 	}
 
 	void Application::KeyboardDown(unsigned char key, int /*x*/, int /*y*/)
@@ -1,8 +1,12 @@
 #pragma once
 #include "FrameTime.h"
 #include "Input.h"
+#include "InputRecorder.h"
 #include "Scene.h"
 #include "Screen.h"
+#include <Benchmarks\StressBenchmark.h>
+#include <atomic>
+#include <thread>
 
 namespace snes
 {
@@ -12,17 +16,59 @@ namespace snes
         Application(int argc, char* argv[]);
         ~Application();
 
-		/** Start the glut main loop */
+		/** Start the glut main loop, or the headless loop when running headless */
         void Run();
 		/** Exit the glut main loop and terminate the program */
         void Exit();
 
-		/** Return the window width and height in pixels */
+		/** Return the window width and height in pixels. Safe to call from any thread */
 		static void GetScreenSize(uint& outWidth, uint& outHeight);
 
     private:
+		/** Read the window size and options from the command line
+		  *   <width> <height>, --width N, --height N: window size
+		  *   --scene <file>: load the scene from a snapshot instead of building the demo scene
+		  *   --save-scene <file>: save the scene to a snapshot once it has been initialised
+		  *   --headless: simulate without a window or GL context, one fixed logic loop per frame
+		  *   --frames N: stop after N frames (0 runs until Exit() is called)
+		  *   --benchmark: build a stress scene and write per-phase timings to a JSON file once the frames have run
+		  *   --spheres N, --lights N, --rigidbodies N, --depth N: stress scene settings
+		  *   --output <file>: where to write the benchmark results
+		  *   --trace <file>: record a profile of the run and write it as a Chrome trace on exit. Each thread keeps
+		  *     its most recent events (see ProfileBuffer::CAPACITY), so a long run's trace starts part way through
+		  *   --fixed-rate N: run FixedLogic N times per second (default 60)
+		  *   --max-fixed-loops N: the most FixedLogic loops a frame may run to catch up
+		  *   --lod-rate N: run LOD valuation N times per second (default 10, 0 for every fixed step)
+		  *   --adaptive-pacing: drop to half the max FPS while frames can't keep up with it
+		  *   --dynamic-resolution N: render below the window's resolution when the GPU takes over N milliseconds a frame
+		  *   --threaded: run the simulation on its own thread, so each frame's logic overlaps the previous frame's draw
+		  *   --low-latency: turn the camera by mouse movement received after the frame's logic, just before it's drawn
+		  *   --record <file>: record the input and frame durations of the run, and write them to a file on exit
+		  *   --replay <file>: replay a recording instead of live input and timing, and stop when it runs out */
+		void ParseArguments(int& outWindowWidth, int& outWindowHeight);
+
 		/** Resize the screen */
         static void Resize(int width, int height);
+		/** Set the screen's size, and publish it for GetScreenSize() */
+		static void SetScreenSize(int width, int height);
+		/** Build the stress scene, the snapshot scene or the demo scene, and save it if asked to */
+		void InitialiseScene();
+		/** Step the scene for a headless run until the frame budget is used up, then print a summary */
+		void RunHeadless();
+		/** Start a frame with the frame limiter, a fixed time step or the replayed frame duration, recording it if asked to
+		  * @param fixedStep: use a fixed time step rather than the clock
+		  * @return false if the replay has run out of frames */
+		static bool StartNewFrame(bool fixedStep);
+		/** Run this frame's FixedLogic loops and MainLogic on the scene, then publish its render snapshot */
+		static void UpdateScene();
+		/** Simulation thread function: paces and updates the scene until m_simulating is cleared */
+		static void SimulationLoop();
+
+		/** Record how long the oldest input event first shown by a frame waited to be submitted
+		  * @param reflectedSequence: the sequence number of the newest input event the frame shows
+		  * @param submitted: when the frame's draw calls finished being issued */
+		static void RecordInputLatency(uint64 reflectedSequence, Clock::time_point submitted);
+
 		/** Glut Display callback function */
         static void Display();
 		/** Glut Main Loop callback function */
@@ -36,14 +82,60 @@ namespace snes
 		/** Glut Mouse move callback function */
 		static void MouseMove(int x, int y);
 
+		/** The number of frames a benchmark records when no frame budget is given */
+		static constexpr uint DEFAULT_BENCHMARK_FRAMES = 600;
+
 		static FrameTime m_frameTime;
 		static Input m_input;
+		static InputRecorder m_inputRecorder;
 		static Scene m_currentScene;
 		static Screen m_screen;
+		/** The screen's width (high 32 bits) and height (low 32 bits), read by the simulation and render threads while the
+		  * glut thread resizes the screen. Packed together so a reader never sees the width of one size and the height of another */
+		static std::atomic<uint64> m_publishedScreenSize;
+		/** The running benchmark, if any */
+		static std::unique_ptr<StressBenchmark> m_benchmark;
+		/** Snapshots passed from the scene's logic to Display() */
+		static RenderSnapshotBuffer m_snapshots;
+
+		/** Run the simulation on its own thread rather than in the glut idle callback */
+		static bool m_threaded;
+		static std::thread m_simulationThread;
+		/** Cleared to stop the simulation thread */
+		static std::atomic<bool> m_simulating;
+		/** Set by the simulation when the exit key is pressed, and acted on by the glut thread */
+		static std::atomic<bool> m_exitRequested;
+
+		/** Apply mouse look to the camera again just before drawing, with input the snapshot didn't see */
+		static bool m_lateCameraUpdate;
+		/** The newest input event shown by a submitted frame. Only touched by Display() */
+		static uint64 m_reflectedInputSequence;
 
         int m_argc;
         std::vector<std::string> m_argv;
 
+		/** Scene snapshot to load at startup, if any */
+		std::string m_scenePath;
+		/** Scene snapshot to save after startup, if any */
+		std::string m_saveScenePath;
+
+		/** Run without a window or GL context */
+		bool m_headless = false;
+		/** The number of frames to run before returning from Run(), or 0 for no limit */
+		uint m_frameBudget = 0;
+		/** Build a stress scene and benchmark it */
+		bool m_runBenchmark = false;
+		/** The stress scene to build when benchmarking */
+		StressSceneSettings m_stressSettings;
+		/** Where to write the benchmark results */
+		std::string m_benchmarkOutputPath = "benchmark.json";
+		/** Where to write the profiler trace, if anywhere */
+		std::string m_tracePath;
+		/** Where to write the input recording, if anywhere */
+		std::string m_recordPath;
+		/** The input recording to replay, if any */
+		std::string m_replayPath;
+
         /** Application state */
         bool m_running;
 
@@ -7,6 +7,7 @@ namespace snes
 	Component::Component(GameObject& gameObject)
 		: m_gameObject(gameObject)
 		, m_transform(gameObject.GetTransform())
+		, m_handleId(HandleTable<Component>::Register(this))
 	{
 
 	}
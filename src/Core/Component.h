@@ -1,25 +1,42 @@
 #pragma once
+#include "Handle.h"
+#include <type_traits>
 
 namespace snes
 {
 	class GameObject;
 	class Transform;
-	class Camera;
+	class RenderSnapshot;
+	class SnapshotReader;
+	class SnapshotWriter;
+	template <typename Base> class TypedPool;
 
-	enum RenderPass
+	/** The per-frame update phases a component can be registered for */
+	enum UpdatePhase
 	{
-		GEOMETRY_PASS,
-		SHADOW_PASS
+		FIXED_LOGIC_PHASE,
+		MAIN_LOGIC_PHASE,
+		MAIN_DRAW_PHASE,
+		UPDATE_PHASE_COUNT
 	};
 
 	/** Component base class
 	  * Inherit from this to create new component types */
-	class Component : public std::enable_shared_from_this<Component>
+	class Component
 	{
 	public:
+		/** Handles to any component type resolve through the Component handle table */
+		typedef Component HandleBase;
+
+		/** The number of times per second FixedLogic() is called on this type, or 0 to call it on every fixed step.
+		  * Redeclare this in a component type to tick it less often (see SystemScheduler) */
+		static constexpr uint FIXED_LOGIC_RATE = 0;
+
 		Component(GameObject& gameObject);
+		~Component() { HandleTable<Component>::Release(m_handleId); }
 
-		~Component() {}
+		Component(const Component&) = delete;
+		Component& operator=(const Component&) = delete;
 
 		/** Component function called once as soon as the component is created */
 		virtual void Awake() {};
@@ -33,8 +50,10 @@ namespace snes
 		/** Component function called at a variable interval equal to the time taken for last frame to process */
 		virtual void MainLogic() {};
 
-		/** Component function called at the end of each frame */
-		virtual void MainDraw(RenderPass renderPass, Camera& camera) {};
+		/** Component function called at the end of each frame to add what it draws to the frame's render snapshot.
+		  * The snapshot is drawn later (possibly on another thread while the next frame's logic runs), so this
+		  * must only copy state into it and never issue GL calls itself */
+		virtual void MainDraw(RenderSnapshot& snapshot) {};
 
 		/** Component function called whenever the component or parent GameObject is destroyed */
 		virtual void OnDestroy() {};
@@ -42,9 +61,17 @@ namespace snes
 		/** Component function called whenever a collider component attached to this game object is collided with */
 		virtual void OnCollision(GameObject& other) {};
 
+		/** Write this component's parameters to a scene snapshot */
+		virtual void SaveSnapshot(SnapshotWriter& writer) {};
+		/** Read this component's parameters from a scene snapshot, in the order SaveSnapshot() wrote them */
+		virtual void LoadSnapshot(SnapshotReader& reader) {};
+
 		/** @return this component's GameObject's transform */
 		Transform& GetTransform() { return m_transform; }
 
+		/** @return the id used to create handles to this component */
+		HandleId GetHandleId() const { return m_handleId; }
+
 		void Enable() { m_enabled = true; }
 		void Disable() { m_enabled = false; }
 		bool IsEnabled() { return m_enabled; }
@@ -54,5 +81,30 @@ namespace snes
 		Transform& m_transform;
 
 		bool m_enabled = true;
+
+	private:
+		friend class ComponentPhases;
+		friend class GameObject;
+
+		/** This component's position in each ComponentPhases list, or -1 if it isn't registered for that phase */
+		int m_phaseIndex[UPDATE_PHASE_COUNT] = { -1, -1, -1 };
+		/** The pool this component was allocated from */
+		TypedPool<Component>* m_pool = nullptr;
+		/** This component's slot in the Component handle table */
+		HandleId m_handleId;
 	};
+
+	/** Compile-time checks for whether a component type overrides a per-frame hook.
+	  * If T doesn't override the hook, &T::Hook still names Component's empty implementation. */
+	template <typename T>
+	struct OverridesFixedLogic : std::integral_constant<bool,
+		!std::is_same<decltype(&T::FixedLogic), void (Component::*)()>::value> {};
+
+	template <typename T>
+	struct OverridesMainLogic : std::integral_constant<bool,
+		!std::is_same<decltype(&T::MainLogic), void (Component::*)()>::value> {};
+
+	template <typename T>
+	struct OverridesMainDraw : std::integral_constant<bool,
+		!std::is_same<decltype(&T::MainDraw), void (Component::*)(RenderSnapshot&)>::value> {};
 }
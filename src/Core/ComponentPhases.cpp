@@ -0,0 +1,111 @@
+#include "stdafx.h"
+#include "ComponentPhases.h"
+
+namespace snes
+{
+	void ComponentPhases::Add(UpdatePhase phase, Component& component)
+	{
+		component.m_phaseIndex[phase] = m_components[phase].size();
+		m_components[phase].push_back(&component);
+	}
+
+	void ComponentPhases::Unregister(Component& component)
+	{
+		for (int phase = 0; phase < UPDATE_PHASE_COUNT; phase++)
+		{
+			int index = component.m_phaseIndex[phase];
+			if (index >= 0)
+			{
+				m_components[phase][index] = nullptr;
+				m_removedCount[phase]++;
+				component.m_phaseIndex[phase] = -1;
+			}
+		}
+	}
+
+	void ComponentPhases::Clear()
+	{
+		for (int phase = 0; phase < UPDATE_PHASE_COUNT; phase++)
+		{
+			m_components[phase].clear();
+			m_removedCount[phase] = 0;
+		}
+		m_fixedLogicSystems.clear();
+	}
+
+	void ComponentPhases::Compact(UpdatePhase phase)
+	{
+		if (m_removedCount[phase] == 0)
+		{
+			return;
+		}
+
+		std::vector<Component*>& components = m_components[phase];
+		uint count = 0;
+		for (uint i = 0; i < components.size(); i++)
+		{
+			Component* component = components[i];
+			if (component)
+			{
+				if (phase == FIXED_LOGIC_PHASE)
+				{
+					m_fixedLogicSystems[count] = m_fixedLogicSystems[i];
+				}
+				component->m_phaseIndex[phase] = count;
+				components[count++] = component;
+			}
+		}
+		components.resize(count);
+		if (phase == FIXED_LOGIC_PHASE)
+		{
+			m_fixedLogicSystems.resize(count);
+		}
+		m_removedCount[phase] = 0;
+	}
+
+	void ComponentPhases::FixedLogic()
+	{
+		Compact(FIXED_LOGIC_PHASE);
+
+		// Index loop, as components may be added or removed during the phase
+		std::vector<Component*>& components = m_components[FIXED_LOGIC_PHASE];
+		for (uint i = 0; i < components.size(); i++)
+		{
+			Component* component = components[i];
+			if (component && component->IsEnabled() && SystemScheduler::IsDue(m_fixedLogicSystems[i]))
+			{
+				component->FixedLogic();
+			}
+		}
+	}
+
+	void ComponentPhases::MainLogic()
+	{
+		Compact(MAIN_LOGIC_PHASE);
+
+		std::vector<Component*>& components = m_components[MAIN_LOGIC_PHASE];
+		for (uint i = 0; i < components.size(); i++)
+		{
+			Component* component = components[i];
+			if (component && component->IsEnabled())
+			{
+				component->MainLogic();
+			}
+		}
+	}
+
+	void ComponentPhases::MainDraw(RenderSnapshot& snapshot)
+	{
+		Compact(MAIN_DRAW_PHASE);
+
+		std::vector<Component*>& components = m_components[MAIN_DRAW_PHASE];
+		for (uint i = 0; i < components.size(); i++)
+		{
+			Component* component = components[i];
+			if (component && component->IsEnabled())
+			{
+				component->MainDraw(snapshot);
+			}
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Component.h"
+#include "SystemScheduler.h"
+
+namespace snes
+{
+	/** Component Phases
+	  * Keeps a compact list of the components registered for each update phase.
+	  * A component is only registered for a phase if its type overrides that phase's hook,
+	  * so each phase iterates the components with work to do instead of walking the whole hierarchy.
+	  * FixedLogic entries also remember their type's SystemScheduler system, and are skipped on steps it isn't due. */
+	class ComponentPhases
+	{
+	public:
+		ComponentPhases() {};
+		~ComponentPhases() {};
+
+		/** Register a component for every phase its type overrides */
+		template <typename T>
+		void Register(T& component)
+		{
+			if (OverridesFixedLogic<T>::value)
+			{
+				Add(FIXED_LOGIC_PHASE, component);
+				m_fixedLogicSystems.push_back(SystemScheduler::GetSystem<T>());
+			}
+			if (OverridesMainLogic<T>::value)
+			{
+				Add(MAIN_LOGIC_PHASE, component);
+			}
+			if (OverridesMainDraw<T>::value)
+			{
+				Add(MAIN_DRAW_PHASE, component);
+			}
+		}
+
+		/** Remove a component from every phase it is registered for.
+		  * Its entries are cleared immediately and the lists are compacted before the phase next runs. */
+		void Unregister(Component& component);
+
+		/** Remove every component from every phase */
+		void Clear();
+
+		/** Run FixedLogic on all enabled components registered for it whose system is due this step */
+		void FixedLogic();
+		/** Run MainLogic on all enabled components registered for it */
+		void MainLogic();
+		/** Run MainDraw on all enabled components registered for it, capturing their draws into a snapshot */
+		void MainDraw(RenderSnapshot& snapshot);
+
+	private:
+		void Add(UpdatePhase phase, Component& component);
+		/** Remove the cleared entries left by Unregister() from a phase's list, preserving order */
+		void Compact(UpdatePhase phase);
+
+		std::vector<Component*> m_components[UPDATE_PHASE_COUNT];
+		/** The number of cleared entries waiting to be compacted in each phase's list */
+		uint m_removedCount[UPDATE_PHASE_COUNT] = { 0, 0, 0 };
+		/** The system each entry in the FixedLogic list belongs to, in the same order */
+		std::vector<SystemScheduler::SystemId> m_fixedLogicSystems;
+	};
+}
@@ -0,0 +1,149 @@
+#include "stdafx.h"
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+namespace snes
+{
+	constexpr float FrameStats::HISTOGRAM_BOUNDS[];
+	constexpr uint FrameStats::HISTOGRAM_BUCKETS;
+
+	FrameStats::FrameStats()
+	{
+		// 10 seconds at 60 FPS, and a hitch is anything that misses two 60 FPS frames
+		SetWindowSize(600);
+		m_hitchThresholdMs = 2000.0f / 60.0f;
+	}
+
+	void FrameStats::RecordFrame(float frameMs, float sleepMs, uint fixedLoops, float droppedMs)
+	{
+		m_window[m_windowNext] = frameMs;
+		m_windowNext = (m_windowNext + 1) % m_window.size();
+		m_windowCount = std::min(m_windowCount + 1, (uint)m_window.size());
+
+		uint bucket = 0;
+		while (bucket < HISTOGRAM_BUCKETS - 1 && frameMs > HISTOGRAM_BOUNDS[bucket])
+		{
+			++bucket;
+		}
+		++m_histogram[bucket];
+
+		++m_frameCount;
+		if (frameMs > m_hitchThresholdMs)
+		{
+			++m_hitchCount;
+		}
+		if (fixedLoops > 1)
+		{
+			++m_catchUpCount;
+		}
+		m_maxFixedLoops = std::max(m_maxFixedLoops, fixedLoops);
+		if (droppedMs > 0.0f)
+		{
+			++m_droppedFrameCount;
+			m_totalDroppedMs += droppedMs;
+		}
+		m_totalSleepMs += sleepMs;
+		m_totalFrameMs += frameMs;
+	}
+
+	void FrameStats::RecordInputLatency(float latencyMs)
+	{
+		m_latencyWindow[m_latencyWindowNext] = latencyMs;
+		m_latencyWindowNext = (m_latencyWindowNext + 1) % m_latencyWindow.size();
+		m_latencyWindowCount = std::min(m_latencyWindowCount + 1, (uint)m_latencyWindow.size());
+		++m_latencyCount;
+	}
+
+	void FrameStats::SetWindowSize(uint frames)
+	{
+		m_window.assign(std::max(frames, 1u), 0.0f);
+		m_windowNext = 0;
+		m_windowCount = 0;
+		m_latencyWindow.assign(std::max(frames, 1u), 0.0f);
+		m_latencyWindowNext = 0;
+		m_latencyWindowCount = 0;
+	}
+
+	FrameStatsSummary FrameStats::GetSummary() const
+	{
+		return Summarise(m_window, m_windowCount);
+	}
+
+	FrameStatsSummary FrameStats::GetInputLatencySummary() const
+	{
+		return Summarise(m_latencyWindow, m_latencyWindowCount);
+	}
+
+	FrameStatsSummary FrameStats::Summarise(const std::vector<float>& window, uint count)
+	{
+		FrameStatsSummary summary;
+		if (count == 0)
+		{
+			return summary;
+		}
+
+		std::vector<float> sorted(window.begin(), window.begin() + count);
+		std::sort(sorted.begin(), sorted.end());
+
+		// Nearest-rank percentiles
+		auto percentile = [&sorted](float p)
+		{
+			uint rank = (uint)std::ceil(p * sorted.size());
+			return sorted[std::max(rank, 1u) - 1];
+		};
+
+		summary.frames = count;
+		summary.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0f) / count;
+		summary.p50 = percentile(0.5f);
+		summary.p95 = percentile(0.95f);
+		summary.p99 = percentile(0.99f);
+		summary.max = sorted.back();
+		return summary;
+	}
+
+	void FrameStats::Print(std::ostream& out) const
+	{
+		if (m_frameCount == 0)
+		{
+			return;
+		}
+
+		FrameStatsSummary summary = GetSummary();
+		std::streamsize precision = out.precision();
+		out << std::fixed << std::setprecision(2);
+
+		out << "Frame times over the last " << summary.frames << " frames (ms): mean " << summary.mean
+			<< ", p50 " << summary.p50 << ", p95 " << summary.p95 << ", p99 " << summary.p99 << ", max " << summary.max << std::endl;
+		out << "Frames: " << m_frameCount << ", hitches (> " << m_hitchThresholdMs << "ms): " << m_hitchCount
+			<< ", catch-up frames: " << m_catchUpCount << " (max " << m_maxFixedLoops << " fixed loops)" << std::endl;
+		out << "Time waiting in frame limiter: " << m_totalSleepMs << "ms ("
+			<< (m_totalFrameMs > 0.0 ? 100.0 * m_totalSleepMs / m_totalFrameMs : 0.0) << "% of frame time)" << std::endl;
+		out << "Simulation time dropped by the fixed loop limit: " << m_totalDroppedMs << "ms over " << m_droppedFrameCount << " frames" << std::endl;
+		if (m_latencyCount > 0)
+		{
+			FrameStatsSummary latency = GetInputLatencySummary();
+			out << "Input-to-submit latency over the last " << latency.frames << " inputs (ms): mean " << latency.mean
+				<< ", p50 " << latency.p50 << ", p95 " << latency.p95 << ", p99 " << latency.p99 << ", max " << latency.max << std::endl;
+		}
+
+		out << "Frame time histogram:" << std::endl;
+		for (uint bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket)
+		{
+			if (bucket < HISTOGRAM_BUCKETS - 1)
+			{
+				out << "  <= " << std::setw(6) << HISTOGRAM_BOUNDS[bucket] << "ms: ";
+			}
+			else
+			{
+				out << "   > " << std::setw(6) << HISTOGRAM_BOUNDS[bucket - 1] << "ms: ";
+			}
+			out << m_histogram[bucket] << std::endl;
+		}
+
+		out.unsetf(std::ios::fixed);
+		out.precision(precision);
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+namespace snes
+{
+	/** Frame Stats Summary
+	  * Percentiles over a FrameStats window (frame times or input latencies), in milliseconds */
+	struct FrameStatsSummary
+	{
+		uint frames = 0;
+		float mean = 0.0f;
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+	};
+
+	/** Frame Stats
+	  * Rolling frame-pacing statistics, recorded by FrameTime every frame.
+	  * Percentiles cover the last few frames (the window), while the histogram and counters cover the whole run,
+	  * so they show how evenly frames are paced rather than just the average FPS. */
+	class FrameStats
+	{
+	public:
+		/** Upper bounds of each histogram bucket in milliseconds. The last bucket holds everything above the final bound */
+		static constexpr float HISTOGRAM_BOUNDS[] = { 4.0f, 8.0f, 12.0f, 16.7f, 20.0f, 25.0f, 33.4f, 50.0f, 100.0f };
+		static constexpr uint HISTOGRAM_BUCKETS = sizeof(HISTOGRAM_BOUNDS) / sizeof(float) + 1;
+
+		FrameStats();
+		~FrameStats() {};
+
+		/** Record a finished frame
+		  * @param frameMs: the time since the last frame started, including any sleep
+		  * @param sleepMs: the time the frame limiter spent sleeping
+		  * @param fixedLoops: the number of FixedLogic loops the frame has to run
+		  * @param droppedMs: simulation time dropped because the frame hit the FixedLogic loop limit */
+		void RecordFrame(float frameMs, float sleepMs, uint fixedLoops, float droppedMs = 0.0f);
+		/** Record the time from an input event being received to the first frame showing it being submitted.
+		  * Called by the renderer, which may be a different thread to the one recording frames */
+		void RecordInputLatency(float latencyMs);
+
+		/** Set the number of recent frames percentiles are calculated over (clears the current window) */
+		void SetWindowSize(uint frames);
+		/** Set the frame time (in milliseconds) above which a frame counts as a hitch */
+		void SetHitchThreshold(float frameMs) { m_hitchThresholdMs = frameMs; }
+
+		/** @return percentiles of the frame times in the current window */
+		FrameStatsSummary GetSummary() const;
+		/** @return percentiles of the input latencies in the current window */
+		FrameStatsSummary GetInputLatencySummary() const;
+		/** @return the number of frames recorded in a histogram bucket */
+		uint64 GetHistogramCount(uint bucket) const { return m_histogram[bucket]; }
+
+		/** @return the number of frames recorded since startup */
+		uint64 GetFrameCount() const { return m_frameCount; }
+		/** @return the number of frames slower than the hitch threshold */
+		uint64 GetHitchCount() const { return m_hitchCount; }
+		/** @return the number of frames that had to run more than one FixedLogic loop to catch up */
+		uint64 GetCatchUpCount() const { return m_catchUpCount; }
+		/** @return the most FixedLogic loops run in a single frame */
+		uint GetMaxFixedLoops() const { return m_maxFixedLoops; }
+		/** @return the total time spent waiting (sleeping and spinning) in the frame limiter, in milliseconds */
+		double GetTotalSleepTime() const { return m_totalSleepMs; }
+		/** @return the total simulation time dropped by the FixedLogic loop limit, in milliseconds */
+		double GetTotalDroppedTime() const { return m_totalDroppedMs; }
+		/** @return the number of frames that hit the FixedLogic loop limit */
+		uint64 GetDroppedFrameCount() const { return m_droppedFrameCount; }
+		/** @return the total time covered by recorded frames, in milliseconds */
+		double GetTotalFrameTime() const { return m_totalFrameMs; }
+
+		/** @return the number of input latencies recorded since startup */
+		uint64 GetInputLatencyCount() const { return m_latencyCount; }
+
+		/** Print the window's percentiles, the histogram and the counters */
+		void Print(std::ostream& out) const;
+
+	private:
+		/** @return percentiles of the first count values in a window */
+		static FrameStatsSummary Summarise(const std::vector<float>& window, uint count);
+
+		/** The most recent frame times, oldest overwritten first */
+		std::vector<float> m_window;
+		/** Where the next frame time is written in the window */
+		uint m_windowNext = 0;
+		/** The number of valid frames in the window */
+		uint m_windowCount = 0;
+
+		/** The most recent input latencies, in the same way as the frame times */
+		std::vector<float> m_latencyWindow;
+		uint m_latencyWindowNext = 0;
+		uint m_latencyWindowCount = 0;
+		uint64 m_latencyCount = 0;
+
+		uint64 m_histogram[HISTOGRAM_BUCKETS] = {};
+
+		float m_hitchThresholdMs;
+		uint64 m_frameCount = 0;
+		uint64 m_hitchCount = 0;
+		uint64 m_catchUpCount = 0;
+		uint m_maxFixedLoops = 0;
+		uint64 m_droppedFrameCount = 0;
+		double m_totalSleepMs = 0.0;
+		double m_totalDroppedMs = 0.0;
+		double m_totalFrameMs = 0.0;
+	};
+}
@@ -6,8 +6,22 @@
 namespace snes
 {
 	float FrameTime::m_deltaTime = 0.0f;
+	std::chrono::nanoseconds FrameTime::m_frameDuration(0);
+	uint FrameTime::m_fixedLogicRate = FrameTime::DEFAULT_FIXED_LOGIC_LOOPS_PER_SECOND;
+	float FrameTime::m_fixedTimeStep = 1.0f / FrameTime::DEFAULT_FIXED_LOGIC_LOOPS_PER_SECOND;
+	std::chrono::nanoseconds FrameTime::m_nsPerFixedLogicLoop(NS_IN_S / FrameTime::DEFAULT_FIXED_LOGIC_LOOPS_PER_SECOND);
+	float FrameTime::m_interpolationAlpha = 0.0f;
 	uint FrameTime::m_maxFPS = 60;
 	bool FrameTime::m_limitFPS = true;
+	bool FrameTime::m_adaptivePacing = false;
+	bool FrameTime::m_halfRate = false;
+	std::chrono::nanoseconds FrameTime::m_averageWorkDuration(0);
+	std::chrono::nanoseconds FrameTime::m_sleepSlack(0);
+	bool FrameTime::m_sleepCalibrated = false;
+	uint FrameTime::m_maxFixedLoopsPerFrame = FrameTime::DEFAULT_MAX_FIXED_LOOPS_PER_FRAME;
+	std::chrono::nanoseconds FrameTime::m_droppedTime(0);
+	constexpr std::chrono::nanoseconds FrameTime::MAX_SLEEP_SLACK;
+	FrameStats FrameTime::m_stats;
 
 	FrameTime::FrameTime()
 	{
@@ -21,48 +35,159 @@ namespace snes
 
 	void FrameTime::StartNewFrame()
 	{
-		auto thisFrameStart = Clock::now();
-		std::chrono::duration<uint64, std::nano> frameDuration = thisFrameStart - m_lastFrameStart;
-		
+		Clock::time_point thisFrameStart = Clock::now();
+		std::chrono::nanoseconds frameDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(thisFrameStart - m_lastFrameStart);
+		std::chrono::nanoseconds sleepDuration(0);
+
 		// If the last frame was faster than our max FPS allows, wait until the next frame is due
 		if (m_limitFPS)
 		{
-			std::chrono::duration<uint64, std::nano> minFrameDuration(NS_IN_S / m_maxFPS);
+			UpdateAdaptivePacing(frameDuration);
+
+			std::chrono::nanoseconds minFrameDuration(NS_IN_S / GetPacedFPS());
 			if (frameDuration < minFrameDuration)
 			{
-				// @TODO: sleep_for() isn't very precise
-				uint64 timeToWaitNS = minFrameDuration.count() - frameDuration.count();
-				std::this_thread::sleep_for(std::chrono::nanoseconds(timeToWaitNS));
-				thisFrameStart = Clock::now();
-
-				// spin-locking is grooooosssss but is more accurate
-				/*bool sleep = true;
-				while (sleep)
-				{
-					std::this_thread::yield();
-					thisFrameStart = Clock::now();
-					if (thisFrameStart > m_lastFrameStart + minFrameDuration)
-					{
-						sleep = false;
-					}
-				}*/
-
-				frameDuration = thisFrameStart - m_lastFrameStart;
+				Clock::time_point waitStart = thisFrameStart;
+				thisFrameStart = WaitUntil(m_lastFrameStart + minFrameDuration);
+				sleepDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(thisFrameStart - waitStart);
+				frameDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(thisFrameStart - m_lastFrameStart);
 			}
 		}
 
+		m_lastFrameStart = thisFrameStart;
+		std::chrono::nanoseconds droppedDuration = AdvanceSimulation(frameDuration);
+
+		m_stats.RecordFrame((float)frameDuration.count() / NS_IN_MS, (float)sleepDuration.count() / NS_IN_MS,
+			m_pendingFixedLogicLoops, (float)droppedDuration.count() / NS_IN_MS);
+	}
+
+	void FrameTime::StartReplayedFrame(std::chrono::nanoseconds frameDuration)
+	{
+		Clock::time_point thisFrameStart = Clock::now();
+		std::chrono::nanoseconds wallDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(thisFrameStart - m_lastFrameStart);
 		m_lastFrameStart = thisFrameStart;
 
+		std::chrono::nanoseconds droppedDuration = AdvanceSimulation(frameDuration);
+
+		m_stats.RecordFrame((float)wallDuration.count() / NS_IN_MS, 0.0f, m_pendingFixedLogicLoops, (float)droppedDuration.count() / NS_IN_MS);
+	}
+
+	std::chrono::nanoseconds FrameTime::AdvanceSimulation(std::chrono::nanoseconds frameDuration)
+	{
 		// Calculate the duration of the last frame
+		m_frameDuration = frameDuration;
 		m_deltaTime = (float)frameDuration.count() / NS_IN_S;
 
 		// Calculate the number of fixed logic loops required tis frame to stay at the desired rate
 		m_fixedLogicTimeRemaining += frameDuration;
-		m_pendingFixedLogicLoops = 0;
-		while (m_fixedLogicTimeRemaining > NS_PER_FIXED_LOGIC_LOOP)
+		m_pendingFixedLogicLoops = (uint)(m_fixedLogicTimeRemaining / m_nsPerFixedLogicLoop);
+		m_fixedLogicTimeRemaining -= m_nsPerFixedLogicLoop * m_pendingFixedLogicLoops;
+
+		// Don't let a long frame snowball into longer and longer catch-up frames: drop whatever is over the limit
+		std::chrono::nanoseconds droppedDuration(0);
+		if (m_pendingFixedLogicLoops > m_maxFixedLoopsPerFrame)
+		{
+			droppedDuration = m_nsPerFixedLogicLoop * (m_pendingFixedLogicLoops - m_maxFixedLoopsPerFrame);
+			m_droppedTime += droppedDuration;
+			m_pendingFixedLogicLoops = m_maxFixedLoopsPerFrame;
+		}
+
+		// Whatever is left over is how far we are towards the next fixed loop
+		m_interpolationAlpha = std::min((float)m_fixedLogicTimeRemaining.count() / m_nsPerFixedLogicLoop.count(), 1.0f);
+
+		return droppedDuration;
+	}
+
+	void FrameTime::SetFixedLogicRate(uint loopsPerSecond)
+	{
+		m_fixedLogicRate = std::max(loopsPerSecond, 1u);
+		m_fixedTimeStep = 1.0f / m_fixedLogicRate;
+		m_nsPerFixedLogicLoop = std::chrono::nanoseconds(NS_IN_S / m_fixedLogicRate);
+	}
+
+	Clock::time_point FrameTime::WaitUntil(Clock::time_point target)
+	{
+		if (!m_sleepCalibrated)
+		{
+			m_sleepSlack = CalibrateSleepSlack();
+			m_sleepCalibrated = true;
+		}
+
+		Clock::time_point now = Clock::now();
+
+		// sleep_for() only promises to sleep for at least the requested time, so wake up early by the timer slack
+		Clock::time_point wakeTarget = target - m_sleepSlack;
+		if (wakeTarget > now)
+		{
+			std::this_thread::sleep_for(wakeTarget - now);
+			now = Clock::now();
+
+			// Keep the slack calibrated: grow straight away after oversleeping, and shrink slowly otherwise
+			std::chrono::nanoseconds overshoot = std::chrono::duration_cast<std::chrono::nanoseconds>(now - wakeTarget);
+			if (overshoot > m_sleepSlack)
+			{
+				m_sleepSlack = std::min(overshoot, MAX_SLEEP_SLACK);
+			}
+			else
+			{
+				m_sleepSlack -= (m_sleepSlack - (overshoot + overshoot / 4)) / 16;
+			}
+		}
+
+		// Spin for the rest, which is far more precise than sleeping
+		while (now < target)
 		{
-			m_fixedLogicTimeRemaining -= NS_PER_FIXED_LOGIC_LOOP;
-			++m_pendingFixedLogicLoops;
+			std::this_thread::yield();
+			now = Clock::now();
 		}
+
+		return now;
+	}
+
+	std::chrono::nanoseconds FrameTime::CalibrateSleepSlack()
+	{
+		// Use the worst overshoot of a few short sleeps, plus a margin
+		const std::chrono::milliseconds sleepTime(1);
+		std::chrono::nanoseconds slack(0);
+		for (uint i = 0; i < 5; ++i)
+		{
+			Clock::time_point start = Clock::now();
+			std::this_thread::sleep_for(sleepTime);
+			slack = std::max(slack, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start - sleepTime));
+		}
+		return std::min(slack + slack / 4, MAX_SLEEP_SLACK);
+	}
+
+	void FrameTime::UpdateAdaptivePacing(std::chrono::nanoseconds workDuration)
+	{
+		// Smooth over roughly 16 frames so a single hitch doesn't change the rate
+		m_averageWorkDuration += (workDuration - m_averageWorkDuration) / 16;
+
+		if (!m_adaptivePacing)
+		{
+			m_halfRate = false;
+			return;
+		}
+
+		// Drop to half rate once frames miss the full rate by more than 5%, and only go back once they
+		// comfortably fit in it again, so the rate doesn't flip every frame
+		std::chrono::nanoseconds fullRateDuration(NS_IN_S / m_maxFPS);
+		if (!m_halfRate && m_averageWorkDuration > fullRateDuration + fullRateDuration / 20)
+		{
+			m_halfRate = true;
+		}
+		else if (m_halfRate && m_averageWorkDuration < fullRateDuration * 4 / 5)
+		{
+			m_halfRate = false;
+		}
+	}
+
+	void FrameTime::StartNewFixedFrame()
+	{
+		m_frameDuration = m_nsPerFixedLogicLoop;
+		m_deltaTime = m_fixedTimeStep;
+		m_pendingFixedLogicLoops = 1;
+		// The frame ends exactly on a fixed loop, so the current state is the one to show
+		m_interpolationAlpha = 1.0f;
 	}
-}
+}
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
+#include "FrameStats.h"
+#include <algorithm>
 #include <chrono>
 
 namespace snes
@@ -17,45 +19,124 @@ namespace snes
 		FrameTime();
 		~FrameTime();
 
-		/** The number of times FixedLogic() will be called on all components per second */
-		static constexpr uint8 FIXED_LOGIC_LOOPS_PER_SECOND = 60;
-		/** The time step between fixed logic loops */
-		static constexpr float SECONDS_PER_FIXED_LOOP = 1.0f / FIXED_LOGIC_LOOPS_PER_SECOND;
+		/** The number of times FixedLogic() is called on all components per second, unless changed with SetFixedLogicRate() */
+		static constexpr uint DEFAULT_FIXED_LOGIC_LOOPS_PER_SECOND = 60;
+
+		/** The default limit on FixedLogic loops per frame */
+		static constexpr uint DEFAULT_MAX_FIXED_LOOPS_PER_FRAME = 5;
 
 		/** Marks the start of a new frame by doing the following:
-		  * Sleeps until the maximum FPS is hit (optional)
+		  * Waits until the frame is due if the FPS is limited (sleeping, then spinning for the last stretch)
 		  * Calculates the duration of the frame
-		  * Calculates the number of FixedLogic loops to run this frame */
+		  * Calculates the number of FixedLogic loops to run this frame, dropping any time beyond the per-frame limit */
 		void StartNewFrame();
 
+		/** Marks the start of a new frame that lasts exactly one fixed logic loop, without sleeping or reading the clock.
+		  * Used when simulating headless, so runs are deterministic and go as fast as the simulation allows */
+		void StartNewFixedFrame();
+
+		/** Marks the start of a new frame with a duration taken from a recording (see InputRecorder), without sleeping.
+		  * The simulation steps exactly as it did when recorded, while the stats measure how long frames really take */
+		void StartReplayedFrame(std::chrono::nanoseconds frameDuration);
+
 		/** @return the number of fixed logic loops to be completed this frame */
 		uint GetPendingFixedLogicLoops() { return m_pendingFixedLogicLoops; }
 
 		/** @return the duration of the last frame (in seconds) */
 		static float GetLastFrameDuration() { return m_deltaTime; }
+		/** @return the exact duration of the last frame, as used to work out the fixed logic loops */
+		static std::chrono::nanoseconds GetLastFrameDurationNs() { return m_frameDuration; }
+
+		/** Set the number of times FixedLogic() is called per second. Lower rates save simulation time, and
+		  * rendering stays smooth as long as renderers draw interpolated transforms (see Transform::GetRenderMatrix()) */
+		static void SetFixedLogicRate(uint loopsPerSecond);
+		/** @return the number of times FixedLogic() is called per second */
+		static uint GetFixedLogicRate() { return m_fixedLogicRate; }
+		/** @return the time step between fixed logic loops (in seconds) */
+		static float GetFixedTimeStep() { return m_fixedTimeStep; }
+		/** @return how far the current frame is between the last fixed logic loop and the next one, from 0 to 1.
+		  * Used to blend between the previous and current fixed-step states when rendering */
+		static float GetInterpolationAlpha() { return m_interpolationAlpha; }
+
+		/** @return rolling frame-pacing statistics, updated every StartNewFrame() */
+		static FrameStats& GetStats() { return m_stats; }
 
 		/** Set the maximum allowable FPS */
-		static void SetMaxFPS(uint maxFPS) { m_maxFPS = maxFPS; }
-		static bool UseMaxFPS(bool set) { m_limitFPS = set; }
+		static void SetMaxFPS(uint maxFPS) { m_maxFPS = std::max(maxFPS, 1u); }
+		/** Set whether to limit the FPS to the max FPS */
+		static void UseMaxFPS(bool set) { m_limitFPS = set; }
+		/** Set whether to drop to half the max FPS while frames can't keep up with it, rather than
+		  * alternating between fast and slow frames (like adaptive v-sync). Only applies when the FPS is limited */
+		static void UseAdaptivePacing(bool set) { m_adaptivePacing = set; }
+		/** @return the FPS frames are currently being paced to (the max FPS, or half of it while adaptive pacing has kicked in) */
+		static uint GetPacedFPS() { return m_halfRate ? std::max(m_maxFPS / 2, 1u) : m_maxFPS; }
+
+		/** Set the most FixedLogic loops a single frame may run. After a long frame, any time beyond this is dropped
+		  * (the simulation runs slower than real time) instead of spiralling into ever longer catch-up frames */
+		static void SetMaxFixedLoopsPerFrame(uint maxLoops) { m_maxFixedLoopsPerFrame = std::max(maxLoops, 1u); }
+		/** @return the most FixedLogic loops a single frame may run */
+		static uint GetMaxFixedLoopsPerFrame() { return m_maxFixedLoopsPerFrame; }
+		/** @return the total simulation time dropped by the per-frame FixedLogic limit (in seconds) */
+		static double GetDroppedTime() { return (double)m_droppedTime.count() / NS_IN_S; }
 
 	private:
-		static constexpr std::chrono::nanoseconds NS_PER_FIXED_LOGIC_LOOP{ NS_IN_S / FIXED_LOGIC_LOOPS_PER_SECOND };
+		/** Measure how far sleep_for() overshoots on this machine, to know how early to wake up and spin */
+		static std::chrono::nanoseconds CalibrateSleepSlack();
+		/** Wait until the given time, sleeping for as long as the timer slack allows and spinning for the rest
+		  * @return the time the wait finished */
+		static Clock::time_point WaitUntil(Clock::time_point target);
+		/** Switch between the full and half paced rate based on how long frames take to run, excluding sleep */
+		static void UpdateAdaptivePacing(std::chrono::nanoseconds workDuration);
+		/** Move the simulation clock on by a frame: set the delta time, and work out the FixedLogic loops to run and how far
+		  * between loops the frame ends
+		  * @return the simulation time dropped by the per-frame FixedLogic limit */
+		std::chrono::nanoseconds AdvanceSimulation(std::chrono::nanoseconds frameDuration);
+
+		/** The most time to spend spinning before a frame. Coarser timers than this (e.g. the default 15.6ms
+		  * Windows timer) spin for this long and sleep for the rest, at the cost of some precision */
+		static constexpr std::chrono::nanoseconds MAX_SLEEP_SLACK{ 4 * NS_IN_MS };
 		/** The time taken (in seconds) for the last frame to complete */
 		static float m_deltaTime;
+		/** The time taken for the last frame to complete */
+		static std::chrono::nanoseconds m_frameDuration;
+		/** The number of fixed logic loops per second */
+		static uint m_fixedLogicRate;
+		/** The time step between fixed logic loops (in seconds) */
+		static float m_fixedTimeStep;
+		/** The time step between fixed logic loops */
+		static std::chrono::nanoseconds m_nsPerFixedLogicLoop;
+		/** How far the current frame is between fixed logic loops */
+		static float m_interpolationAlpha;
 		/** The maximum FPS allowed */
 		static uint m_maxFPS;
 		/** Whether to limit the game to the max FPS */
 		static bool m_limitFPS;
+		/** Whether to drop to half rate while frames can't keep up */
+		static bool m_adaptivePacing;
+		/** Whether frames are currently paced to half the max FPS */
+		static bool m_halfRate;
+		/** Smoothed time frames spend working (not sleeping), for adaptive pacing */
+		static std::chrono::nanoseconds m_averageWorkDuration;
+		/** How long before a frame is due to stop sleeping and start spinning */
+		static std::chrono::nanoseconds m_sleepSlack;
+		/** Whether the sleep slack has been measured yet */
+		static bool m_sleepCalibrated;
+		/** The most FixedLogic loops a frame may run */
+		static uint m_maxFixedLoopsPerFrame;
+		/** Simulation time dropped by the FixedLogic limit since startup */
+		static std::chrono::nanoseconds m_droppedTime;
+		/** Frame-pacing statistics */
+		static FrameStats m_stats;
 
 		/** The number of fixed logic loops to compete this frame */
 		uint m_pendingFixedLogicLoops = 0;
 
 		/** The time remaining until the next FixedLogic() call */
-		std::chrono::nanoseconds m_fixedLogicTimeRemaining;
+		std::chrono::nanoseconds m_fixedLogicTimeRemaining{ 0 };
 		/** The time that the application started running */
-		std::chrono::steady_clock::time_point m_applicationStart;
+		Clock::time_point m_applicationStart;
 		/** The time that the last frame began */
-		std::chrono::steady_clock::time_point m_lastFrameStart;
+		Clock::time_point m_lastFrameStart;
 
 	};
 }
@@ -4,25 +4,29 @@
 
 namespace snes
 {
-	GameObject::GameObject(std::shared_ptr<GameObject> parent)
+	GameObject::GameObject(GameObject* parent, ObjectPools& pools, ComponentPhases& phases)
 		: m_parent(parent)
 		, m_transform(*this)
+		, m_pools(pools)
+		, m_phases(phases)
+		, m_handleId(HandleTable<GameObject>::Register(this))
 	{
 	}
 	
-	std::weak_ptr<GameObject> GameObject::AddChild()
+	GameObject* GameObject::AddChild()
 	{
-		std::shared_ptr<GameObject> child = std::make_shared<GameObject>(shared_from_this());
+		GameObject* child = m_pools.Get<GameObject>().Create(this, m_pools, m_phases);
+		child->m_siblingIndex = m_children.size();
 		m_children.push_back(child);
 		return child;
 	}
 
-	std::vector<std::weak_ptr<GameObject>> GameObject::GetAllChildren()
+	std::vector<GameObject*> GameObject::GetAllChildren()
 	{
-		std::vector<std::weak_ptr<GameObject>> allChildren;
+		std::vector<GameObject*> allChildren;
 		for (auto& child : m_children)
 		{
-			std::vector<std::weak_ptr<GameObject>> grandChildren = child->GetAllChildren();
+			std::vector<GameObject*> grandChildren = child->GetAllChildren();
 			for (auto& grandChild : grandChildren)
 			{
 				allChildren.push_back(grandChild);
@@ -32,67 +36,51 @@ namespace snes
 		return allChildren;
 	}
 
-	void GameObject::FixedLogic()
+	void GameObject::OnCollision(GameObject& other)
 	{
 		for (auto& child : m_children)
 		{
-			child->FixedLogic();
+			child->OnCollision(other);
 		}
 
 		for (auto& component : m_components)
 		{
 			if (component->IsEnabled())
 			{
-				component->FixedLogic();
+				component->OnCollision(other);
 			}
 		}
 	}
 
-	void GameObject::MainLogic()
+	void GameObject::Destroy()
 	{
-		for (auto& child : m_children)
+		// Swap-remove from the parent's children so destroying a child is O(1)
+		if (m_parent)
 		{
-			child->MainLogic();
+			auto& siblings = m_parent->m_children;
+			GameObject* last = siblings.back();
+			siblings[m_siblingIndex] = last;
+			last->m_siblingIndex = m_siblingIndex;
+			siblings.pop_back();
 		}
 
-		for (auto& component : m_components)
-		{
-			if (component->IsEnabled())
-			{
-				component->MainLogic();
-			}
-		}
+		DestroyHierarchy();
 	}
 
-	void GameObject::MainDraw(RenderPass renderPass, Camera& camera)
+	void GameObject::DestroyHierarchy()
 	{
-		for (auto& child : m_children)
-		{
-			child->MainDraw(renderPass, camera);
-		}
-
-		for (auto& component : m_components)
+		for (GameObject* child : m_children)
 		{
-			if (component->IsEnabled())
-			{
-				component->MainDraw(renderPass, camera);
-			}
+			child->DestroyHierarchy();
 		}
-	}
 
-	void GameObject::OnCollision(GameObject& other)
-	{
-		for (auto& child : m_children)
+		for (Component* component : m_components)
 		{
-			child->OnCollision(other);
+			component->OnDestroy();
+			m_phases.Unregister(*component);
+			component->m_pool->Destroy(component);
 		}
 
-		for (auto& component : m_components)
-		{
-			if (component->IsEnabled())
-			{
-				component->OnCollision(other);
-			}
-		}
+		m_pools.Get<GameObject>().Destroy(this);
 	}
 }
\ No newline at end of file
@@ -1,37 +1,50 @@
 #pragma once
+#include "ComponentPhases.h"
+#include "ObjectPool.h"
 #include <Components\Transform.h>
 
 namespace snes
 {
 
 
-	class GameObject : public std::enable_shared_from_this<GameObject>
+	class GameObject
 	{
 	public:
-		GameObject(std::shared_ptr<GameObject> parent);
-		~GameObject() {};
-
-		/** Run logic on all children and components at a fixed rate (60 times a second guaranteed, catch-up enabled) */
-		void FixedLogic();
-		/** Run logic on all children and components every frame */
-		void MainLogic();
-		/** Run MainDraw on all children and components every frame */
-		void MainDraw(RenderPass renderPass, Camera& camera);
+		typedef GameObject HandleBase;
+
+		GameObject(GameObject* parent, ObjectPools& pools, ComponentPhases& phases);
+		~GameObject() { HandleTable<GameObject>::Release(m_handleId); };
+
+		GameObject(const GameObject&) = delete;
+		GameObject& operator=(const GameObject&) = delete;
+
 		/** Run OnCollision events on all children and components */
 		void OnCollision(GameObject& other);
 
 		/** @return this GameObject's parent GameObject */
-		std::shared_ptr<GameObject> GetParent() { return m_parent; }
+		GameObject* GetParent() { return m_parent; }
 		/** @return this GameObject's transform */
 		Transform& GetTransform() { return m_transform; }
+		/** @return the id used to create handles to this GameObject */
+		HandleId GetHandleId() const { return m_handleId; }
 
-		/** Add a component to this GameObject, calling its Awake() function
-		  * @return a weak_ptr to the component */
+		/** Mark this GameObject as never moving (or not), so the shadows of what it draws are drawn once and cached.
+		  * Its parents should be static too. Moving it anyway is allowed, but redraws the cache */
+		void SetStatic(bool isStatic) { m_static = isStatic; }
+		/** @return true if this GameObject is marked as never moving */
+		bool IsStatic() const { return m_static; }
+
+		/** Add a component to this GameObject, registering it for the update phases it overrides
+		  * and calling its Awake() function
+		  * @return the component, which stays valid until it or this GameObject is destroyed */
 		template <typename T>
-		std::weak_ptr<T> AddComponent()
+		T* AddComponent()
 		{
-			std::shared_ptr<T> component = std::make_shared<T>(*this);
-			m_components.emplace_back(component);
+			ObjectPool<T, Component>& pool = m_pools.Get<T, Component>();
+			T* component = pool.Create(*this);
+			component->m_pool = &pool;
+			m_components.push_back(component);
+			m_phases.Register(*component);
 
 			if (component->IsEnabled())
 			{
@@ -43,11 +56,11 @@ namespace snes
 
 		/** @return the first component of the desired type found, or nullptr if none exist */
 		template <typename T>
-		std::shared_ptr<T> GetComponent()
+		T* GetComponent()
 		{
-			for (auto& component : m_components)
+			for (Component* component : m_components)
 			{
-				std::shared_ptr<T> t = std::dynamic_pointer_cast<T>(component);
+				T* t = dynamic_cast<T*>(component);
 
 				if (t)
 				{
@@ -60,14 +73,34 @@ namespace snes
 
 		/** Create a GameObject as a child of this GameObject
 		  * @return the created GameObject */
-		std::weak_ptr<GameObject> AddChild();
+		GameObject* AddChild();
 		/** @return a vector containing this GameObject, all child GameObjects, their child GameObjects, etc. */
-		std::vector<std::weak_ptr<GameObject>> GetAllChildren();
+		std::vector<GameObject*> GetAllChildren();
+		/** @return this GameObject's direct children */
+		const std::vector<GameObject*>& GetChildren() const { return m_children; }
+		/** @return every component attached to this GameObject */
+		const std::vector<Component*>& GetComponents() const { return m_components; }
+
+		/** Destroy this GameObject along with all of its children and components, calling OnDestroy() on each component.
+		  * Everything is returned to its pool, so any pointers to them become invalid. */
+		void Destroy();
 
 	private:
-		std::vector<std::shared_ptr<Component>> m_components;
-		std::vector<std::shared_ptr<GameObject>> m_children;
-		std::shared_ptr<GameObject> m_parent;
+		/** Destroy this GameObject and its hierarchy without detaching it from its parent */
+		void DestroyHierarchy();
+
+		std::vector<Component*> m_components;
+		std::vector<GameObject*> m_children;
+		GameObject* m_parent;
+		/** This GameObject's index in its parent's list of children */
+		uint m_siblingIndex = 0;
 		Transform m_transform;
+		bool m_static = false;
+		/** The pools this GameObject, its children and components are allocated from */
+		ObjectPools& m_pools;
+		/** The update phase lists shared by every GameObject in this hierarchy */
+		ComponentPhases& m_phases;
+		/** This GameObject's slot in the GameObject handle table */
+		HandleId m_handleId;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+namespace snes
+{
+	/** Handle Id
+	  * A 32-bit slot index paired with a 32-bit generation.
+	  * Generation 0 is never issued, so a default-constructed id is always null. */
+	struct HandleId
+	{
+		uint32 index = 0;
+		uint32 generation = 0;
+
+		bool operator==(const HandleId& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const HandleId& other) const { return !(*this == other); }
+	};
+
+	/** Handle Table
+	  * Slot table mapping handle ids to the live objects of one base type.
+	  * Releasing an object bumps its slot's generation, so any handle taken before then resolves to nullptr
+	  * instead of dangling. Lookups are an index and a compare with no atomics: like the rest of the scene,
+	  * the table is only touched from the main thread. */
+	template <typename Base>
+	class HandleTable
+	{
+	public:
+		/** Assign a slot to an object
+		  * @return the id handles to the object should store */
+		static HandleId Register(Base* object)
+		{
+			std::vector<Slot>& slots = GetSlots();
+			uint32& freeHead = GetFreeHead();
+
+			uint32 index;
+			if (freeHead != NO_FREE_SLOT)
+			{
+				index = freeHead;
+				freeHead = slots[index].nextFree;
+			}
+			else
+			{
+				index = (uint32)slots.size();
+				slots.push_back(Slot{ nullptr, 1, NO_FREE_SLOT });
+			}
+
+			slots[index].object = object;
+			return HandleId{ index, slots[index].generation };
+		}
+
+		/** Free an object's slot, invalidating every handle to it */
+		static void Release(HandleId id)
+		{
+			if (id.generation == 0)
+			{
+				return;
+			}
+
+			Slot& slot = GetSlots()[id.index];
+			slot.object = nullptr;
+			// Skip generation 0 on wrap-around so null ids can never match a slot
+			if (++slot.generation == 0)
+			{
+				slot.generation = 1;
+			}
+			slot.nextFree = GetFreeHead();
+			GetFreeHead() = id.index;
+		}
+
+		/** @return the object the id refers to, or nullptr if it has been released */
+		static Base* Resolve(HandleId id)
+		{
+			const std::vector<Slot>& slots = GetSlots();
+			if (id.index < slots.size() && slots[id.index].generation == id.generation)
+			{
+				return slots[id.index].object;
+			}
+			return nullptr;
+		}
+
+	private:
+		static constexpr uint32 NO_FREE_SLOT = 0xFFFFFFFF;
+
+		struct Slot
+		{
+			Base* object;
+			uint32 generation;
+			uint32 nextFree;
+		};
+
+		/** The slot table is deliberately never destroyed, as objects held in other statics
+		  * (e.g. the mesh cache) may still release their slots during static destruction */
+		static std::vector<Slot>& GetSlots()
+		{
+			static std::vector<Slot>* slots = new std::vector<Slot>();
+			return *slots;
+		}
+
+		static uint32& GetFreeHead()
+		{
+			static uint32 freeHead = NO_FREE_SLOT;
+			return freeHead;
+		}
+	};
+
+	/** Handle
+	  * A weak, non-owning reference to a GameObject, component or asset that can safely outlive its target.
+	  * Resolves through the HandleTable of T::HandleBase (e.g. every component type shares the Component table).
+	  * Resolve once with Get() and keep the pointer for the rest of the function, rather than resolving per use. */
+	template <typename T>
+	class Handle
+	{
+	public:
+		Handle() {}
+		Handle(T* object) : m_id(object ? object->GetHandleId() : HandleId()) {}
+
+		/** @return the object, or nullptr if it has been destroyed or the handle is null */
+		T* Get() const { return static_cast<T*>(HandleTable<typename T::HandleBase>::Resolve(m_id)); }
+		T* operator->() const { return Get(); }
+
+		/** @return true if the object this handle refers to is still alive */
+		bool IsValid() const { return Get() != nullptr; }
+		/** @return the id this handle resolves through */
+		HandleId GetId() const { return m_id; }
+
+		bool operator==(const Handle& other) const { return m_id == other.m_id; }
+		bool operator!=(const Handle& other) const { return m_id != other.m_id; }
+
+	private:
+		HandleId m_id;
+	};
+}
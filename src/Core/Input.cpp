@@ -1,6 +1,9 @@
 #include "stdafx.h"
 #include "Input.h"
+#include "InputRecorder.h"
+#include <Rendering\GraphicsDevice.h>
 #include <GL/freeglut.h>
+#include <algorithm>
 
 namespace snes
 {
@@ -11,8 +14,23 @@ namespace snes
 	std::vector<int> Input::m_heldMouseButtons;
 	std::vector<int> Input::m_upMouseButtons;
 	glm::vec2 Input::m_mousePos(0, 0);
+	glm::vec2 Input::m_eventMousePos(0, 0);
 	glm::vec2 Input::m_lastMouseOffset(0, 0);
 	bool Input::m_isWarping = false;
+	std::mutex Input::m_eventMutex;
+	std::vector<Input::InputEvent> Input::m_pendingEvents;
+	std::vector<Input::InputEvent> Input::m_processingEvents;
+	bool Input::m_warpPending = false;
+	glm::vec2 Input::m_warpTarget(0, 0);
+	uint64 Input::m_queuedSequence = 0;
+	Clock::time_point Input::m_eventTimes[Input::EVENT_TIME_HISTORY];
+	glm::ivec2 Input::m_queuedMousePos(0, 0);
+	glm::ivec2 Input::m_queuedMouseTravel(0, 0);
+	uint64 Input::m_queuedMouseSequence = 0;
+	InputRecorder* Input::m_recorder = nullptr;
+	uint64 Input::m_processedSequence = 0;
+	glm::ivec2 Input::m_processedMouseTravel(0, 0);
+	constexpr uint Input::EVENT_TIME_HISTORY;
 
 	Input::Input()
 	{
@@ -31,56 +49,160 @@ namespace snes
 		m_lastMouseOffset = glm::vec2(0, 0);
 	}
 
-	void Input::SetKeyDown(int keyCode)
+	void Input::QueueEvent(InputEvent event)
 	{
-		m_downKeys.push_back(keyCode);
-		m_heldKeys.push_back(keyCode);
+		Clock::time_point now = Clock::now();
+
+		std::lock_guard<std::mutex> lock(m_eventMutex);
+		m_pendingEvents.push_back(event);
+		++m_queuedSequence;
+		m_eventTimes[m_queuedSequence % EVENT_TIME_HISTORY] = now;
+
+		if (event.type == MOUSE_MOVE)
+		{
+			glm::ivec2 position(event.x, event.y);
+			m_queuedMouseTravel += position - m_queuedMousePos;
+			m_queuedMousePos = position;
+			m_queuedMouseSequence = m_queuedSequence;
+		}
+		else if (event.type == MOUSE_WARP)
+		{
+			// Later moves are relative to where the cursor was warped to
+			m_queuedMousePos = glm::ivec2(event.x, event.y);
+		}
 	}
 
-	void Input::SetKeyUp(int keyCode)
+	void Input::ProcessEvents()
 	{
-		m_upKeys.push_back(keyCode);
-		// Remove key from heldKeys
-		for (unsigned int i = 0; i < m_heldKeys.size(); ++i)
 		{
-			if (m_heldKeys[i] == keyCode)
+			std::lock_guard<std::mutex> lock(m_eventMutex);
+			m_processingEvents.swap(m_pendingEvents);
+			m_processedSequence = m_queuedSequence;
+			m_processedMouseTravel = m_queuedMouseTravel;
+		}
+
+		if (m_recorder)
+		{
+			m_recorder->ProcessEvents(m_processingEvents);
+		}
+
+		for (const InputEvent& event : m_processingEvents)
+		{
+			switch (event.type)
+			{
+			case KEY_DOWN:
+				m_downKeys.push_back(event.x);
+				m_heldKeys.push_back(event.x);
+				break;
+			case KEY_UP:
+				m_upKeys.push_back(event.x);
+				m_heldKeys.erase(std::remove(m_heldKeys.begin(), m_heldKeys.end(), event.x), m_heldKeys.end());
+				break;
+			case MOUSE_DOWN:
+				m_downMouseButtons.push_back(event.x);
+				m_heldMouseButtons.push_back(event.x);
+				break;
+			case MOUSE_UP:
+				m_upMouseButtons.push_back(event.x);
+				m_heldMouseButtons.erase(std::remove(m_heldMouseButtons.begin(), m_heldMouseButtons.end(), event.x), m_heldMouseButtons.end());
+				break;
+			case MOUSE_MOVE:
 			{
-				m_heldKeys.erase(m_heldKeys.begin() + i);
+				// Accumulate, so every move since the last frame counts rather than just the latest one
+				glm::vec2 newMousePos(event.x, event.y);
+				glm::vec2 offset = newMousePos - m_eventMousePos;
+				m_lastMouseOffset += offset;
+				m_eventMousePos = newMousePos;
+				// Moves queued before a warp the simulation has already made keep the position following the warp target
+				m_mousePos += offset;
+				break;
+			}
+			case MOUSE_WARP:
+				m_eventMousePos = glm::vec2(event.x, event.y);
+				m_mousePos = m_eventMousePos;
+				break;
 			}
 		}
+		m_processingEvents.clear();
+	}
+
+	void Input::SetKeyDown(int keyCode)
+	{
+		QueueEvent(InputEvent{ KEY_DOWN, keyCode, 0 });
+	}
+
+	void Input::SetKeyUp(int keyCode)
+	{
+		QueueEvent(InputEvent{ KEY_UP, keyCode, 0 });
 	}
 
 	void Input::SetMouseDown(int button)
 	{
-		m_downMouseButtons.push_back(button);
-		m_heldMouseButtons.push_back(button);
+		QueueEvent(InputEvent{ MOUSE_DOWN, button, 0 });
 	}
 
 	void Input::SetMouseUp(int button)
 	{
-		m_upMouseButtons.push_back(button);
-		// Remove key from heldKeys
-		for (unsigned int i = 0; i < m_heldMouseButtons.size(); ++i)
+		QueueEvent(InputEvent{ MOUSE_UP, button, 0 });
+	}
+
+	void Input::WarpMousePos(int x, int y)
+	{
+		m_mousePos = glm::vec2(x, y);
+		if (m_recorder)
 		{
-			if (m_heldMouseButtons[i] == button)
+			m_recorder->RecordWarp(x, y);
+			if (m_recorder->IsReplaying())
 			{
-				m_heldMouseButtons.erase(m_heldMouseButtons.begin() + i);
+				// The recording's own MOUSE_WARP events stand in for this one, and the real cursor is left alone
+				return;
 			}
 		}
+
+		std::lock_guard<std::mutex> lock(m_eventMutex);
+		m_warpPending = true;
+		m_warpTarget = m_mousePos;
 	}
 
-	void Input::WarpMousePos(int x, int y)
+	void Input::ApplyPendingWarp()
 	{
-		m_isWarping = true;
-		glutWarpPointer(x, y);
-		m_mousePos = glm::vec2(x, y);
+		glm::vec2 target;
+		{
+			std::lock_guard<std::mutex> lock(m_eventMutex);
+			if (!m_warpPending)
+			{
+				return;
+			}
+			m_warpPending = false;
+			target = m_warpTarget;
+		}
+
+		// There is no window to warp the cursor in when running headless
+		if (GraphicsDevice::IsAvailable())
+		{
+			m_isWarping = true;
+			glutWarpPointer((int)target.x, (int)target.y);
+		}
+		// Moves are queued on this thread too, so everything queued before this was measured before the warp
+		QueueEvent(InputEvent{ MOUSE_WARP, (int)target.x, (int)target.y });
 	}
 
 	void Input::UpdateMousePos(int x, int y)
 	{
-		glm::vec2 newMousePos(x, y);
-		m_lastMouseOffset = newMousePos - m_mousePos;
-		m_mousePos = newMousePos;
+		QueueEvent(InputEvent{ MOUSE_MOVE, x, y });
+	}
+
+	Clock::time_point Input::GetEventTime(uint64 sequence)
+	{
+		std::lock_guard<std::mutex> lock(m_eventMutex);
+		return m_eventTimes[sequence % EVENT_TIME_HISTORY];
+	}
+
+	glm::ivec2 Input::GetQueuedMouseTravel(uint64& outSequence)
+	{
+		std::lock_guard<std::mutex> lock(m_eventMutex);
+		outSequence = m_queuedMouseSequence;
+		return m_queuedMouseTravel;
 	}
 
 	bool Input::GetKeyDown(int keyCode)
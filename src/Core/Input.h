@@ -1,29 +1,82 @@
 #pragma once
+#include "FrameTime.h"
 #include <glm\vec2.hpp>
+#include <mutex>
 
 namespace snes
 {
+	class InputRecorder;
+
 	class Input
 	{
 	public:
+		/** These values are written to input recordings, so only ever append to this list */
+		enum InputEventType : uint8
+		{
+			KEY_DOWN,
+			KEY_UP,
+			MOUSE_DOWN,
+			MOUSE_UP,
+			MOUSE_MOVE,
+			/** The cursor was warped to x, y. Moves before it are measured from where the cursor was, and moves after it from here */
+			MOUSE_WARP
+		};
+
+		struct InputEvent
+		{
+			InputEventType type;
+			/** The key or button, or the mouse x position */
+			int x;
+			/** The mouse y position */
+			int y;
+		};
+
 		Input();
 		~Input();
 
 		/** Call once-per-frame to refresh the up/down key states */
 		void RefreshInputs();
 
-		/** Set the new state of a given key */
+		/** Apply the events received since the last call. Called at the start of each frame's logic, so the
+		  * window callbacks can keep queueing events while the simulation runs on another thread */
+		void ProcessEvents();
+
+		/** Pass every frame's events and cursor warps through a recorder, which either records them or replaces them with
+		  * recorded ones. Pass nullptr to stop */
+		static void SetRecorder(InputRecorder* recorder) { m_recorder = recorder; }
+
+		/** Queue a change to the state of a given key */
 		void SetKeyDown(int keyCode);
 		void SetKeyUp(int keyCode);
 
-		/** Set the new state of a given mouse button */
+		/** Queue a change to the state of a given mouse button */
 		void SetMouseDown(int button);
 		void SetMouseUp(int button);
-		/** Set the new position of the mouse */
+		/** Queue a new position of the mouse */
 		void UpdateMousePos(int x, int y);
 
-		/** Set the new position of the mouse (Does not update the mouse offset) */
+		/** Set the new position of the mouse (Does not update the mouse offset).
+		  * The cursor itself is moved by the next ApplyPendingWarp(), which queues a MOUSE_WARP event. Until ProcessEvents()
+		  * reaches that event, queued moves are still measured from where the cursor was before the warp.
+		  * While replaying a recording, the cursor isn't moved and the recorded warp events are applied instead */
 		static void WarpMousePos(int x, int y);
+		/** Move the cursor to the position last passed to WarpMousePos(), if it hasn't been already.
+		  * Called on the thread that owns the window */
+		static void ApplyPendingWarp();
+
+		/** @return the sequence number of the last event applied by ProcessEvents(). Events are numbered from 1 as they are queued */
+		static uint64 GetProcessedSequence() { return m_processedSequence; }
+		/** @return the time a recent event was queued. Only the last EVENT_TIME_HISTORY events are remembered */
+		static Clock::time_point GetEventTime(uint64 sequence);
+		/** @return the total mouse movement (in pixels, not counting cursor warps) applied by ProcessEvents() since startup */
+		static glm::ivec2 GetProcessedMouseTravel() { return m_processedMouseTravel; }
+		/** Sample the total mouse movement queued so far, including moves ProcessEvents() hasn't applied yet.
+		  * Subtracting an earlier GetProcessedMouseTravel() gives the movement since then, e.g. to turn the camera just before drawing
+		  * @param outSequence: set to the sequence number of the newest queued mouse move, or 0 if there hasn't been one */
+		static glm::ivec2 GetQueuedMouseTravel(uint64& outSequence);
+
+		/** The number of event timestamps kept for GetEventTime() */
+		static constexpr uint EVENT_TIME_HISTORY = 256;
 
 		/** @return true if the given key is in the desired state */
 		static bool GetKeyDown(int keyCode);
@@ -37,12 +90,38 @@ namespace snes
 
 		/** @return the current mouse position */
 		static const glm::vec2& GetMousePos();
-		/** @return the difference in mouse position between this frame and the last */
+		/** @return the total mouse movement applied this frame */
 		static const glm::vec2& GetLastMouseOffset();
 
 		static bool m_isWarping;
 
 	private:
+		/** Queue an event for the next ProcessEvents() */
+		static void QueueEvent(InputEvent event);
+
+		/** Guards the event queue and the pending warp, which are shared between the window and simulation threads */
+		static std::mutex m_eventMutex;
+		static std::vector<InputEvent> m_pendingEvents;
+		/** The events being applied by ProcessEvents(), swapped with the queue so the lock is held briefly */
+		static std::vector<InputEvent> m_processingEvents;
+		static bool m_warpPending;
+		static glm::vec2 m_warpTarget;
+		/** The sequence number of the newest queued event */
+		static uint64 m_queuedSequence;
+		/** The time each of the most recent events was queued, indexed by sequence number */
+		static Clock::time_point m_eventTimes[EVENT_TIME_HISTORY];
+		/** The mouse position after the newest queued move (or cursor warp) */
+		static glm::ivec2 m_queuedMousePos;
+		/** The total mouse movement queued since startup */
+		static glm::ivec2 m_queuedMouseTravel;
+		/** The sequence number of the newest queued mouse move */
+		static uint64 m_queuedMouseSequence;
+
+		/** Only touched by the simulation */
+		static InputRecorder* m_recorder;
+		static uint64 m_processedSequence;
+		static glm::ivec2 m_processedMouseTravel;
+
 		static std::vector<int> m_downKeys;
 		static std::vector<int> m_heldKeys;
 		static std::vector<int> m_upKeys;
@@ -52,6 +131,9 @@ namespace snes
 		static std::vector<int> m_upMouseButtons;
 
 		static glm::vec2 m_mousePos;
+		/** The cursor position the applied events have reached, which each move is measured from. Unlike m_mousePos, it
+		  * only jumps to a warp's target once the MOUSE_WARP event is applied */
+		static glm::vec2 m_eventMousePos;
 		static glm::vec2 m_lastMouseOffset;
 	};
 }
@@ -0,0 +1,277 @@
+#include "stdafx.h"
+#include "InputRecorder.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace snes
+{
+	namespace
+	{
+		void WriteUint32(std::vector<char>& buffer, uint32 value)
+		{
+			const char* bytes = reinterpret_cast<const char*>(&value);
+			buffer.insert(buffer.end(), bytes, bytes + sizeof(uint32));
+		}
+
+		/** Write 7 bits at a time, with the top bit set on every byte but the last */
+		void WriteVarint(std::vector<char>& buffer, uint64 value)
+		{
+			while (value >= 0x80)
+			{
+				buffer.push_back((char)((value & 0x7F) | 0x80));
+				value >>= 7;
+			}
+			buffer.push_back((char)value);
+		}
+
+		/** Interleave negative and positive values (0, -1, 1, -2...) so small negative numbers stay short */
+		void WriteSignedVarint(std::vector<char>& buffer, int64 value)
+		{
+			WriteVarint(buffer, ((uint64)value << 1) ^ (uint64)(value >> 63));
+		}
+
+		/** Reads values back from a loaded file, failing instead of reading past the end */
+		struct RecordingReader
+		{
+			const char* position;
+			const char* end;
+			bool failed;
+
+			uint32 ReadUint32()
+			{
+				uint32 value = 0;
+				if (position + sizeof(uint32) > end)
+				{
+					failed = true;
+					return value;
+				}
+				std::memcpy(&value, position, sizeof(uint32));
+				position += sizeof(uint32);
+				return value;
+			}
+
+			uint64 ReadVarint()
+			{
+				uint64 value = 0;
+				for (uint shift = 0; shift < 64; shift += 7)
+				{
+					if (position >= end)
+					{
+						failed = true;
+						return 0;
+					}
+					uint8 byte = (uint8)*position++;
+					value |= (uint64)(byte & 0x7F) << shift;
+					if (!(byte & 0x80))
+					{
+						return value;
+					}
+				}
+				failed = true;
+				return 0;
+			}
+
+			int64 ReadSignedVarint()
+			{
+				uint64 value = ReadVarint();
+				return (int64)(value >> 1) ^ -(int64)(value & 1);
+			}
+		};
+	}
+
+	constexpr uint32 InputRecorder::MAGIC;
+	constexpr uint32 InputRecorder::VERSION;
+
+	void InputRecorder::StartRecording()
+	{
+		m_mode = MODE_RECORDING;
+		m_frames.clear();
+		m_replayFrame = 0;
+		m_recordedFrames = 0;
+		m_currentFrame = Frame();
+
+		// The frame durations only replay the same fixed steps at the same rate and loop limit, so store them up front
+		m_buffer.clear();
+		WriteUint32(m_buffer, MAGIC);
+		WriteUint32(m_buffer, VERSION);
+		WriteUint32(m_buffer, FrameTime::GetFixedLogicRate());
+		WriteUint32(m_buffer, FrameTime::GetMaxFixedLoopsPerFrame());
+	}
+
+	bool InputRecorder::SaveRecording(const std::string& path) const
+	{
+		std::ofstream file(path, std::ios::out | std::ios::binary);
+		if (!file)
+		{
+			std::cout << "Error opening input recording for writing: " << path << std::endl;
+			return false;
+		}
+		file.write(m_buffer.data(), m_buffer.size());
+
+		std::cout << "Saved input recording " << path << ": " << m_recordedFrames << " frames, " << m_buffer.size() << " bytes" << std::endl;
+		return true;
+	}
+
+	bool InputRecorder::LoadReplay(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::in | std::ios::binary);
+		if (!file)
+		{
+			std::cout << "Error opening input recording: " << path << std::endl;
+			return false;
+		}
+		std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		RecordingReader reader{ data.data(), data.data() + data.size(), false };
+		if (reader.ReadUint32() != MAGIC || reader.ReadUint32() != VERSION)
+		{
+			std::cout << "Error: " << path << " is not a supported input recording" << std::endl;
+			return false;
+		}
+		uint32 fixedLogicRate = reader.ReadUint32();
+		uint32 maxFixedLoops = reader.ReadUint32();
+
+		std::vector<Frame> frames;
+		while (!reader.failed && reader.position < reader.end)
+		{
+			frames.emplace_back();
+			Frame& frame = frames.back();
+			frame.duration = std::chrono::nanoseconds(reader.ReadVarint());
+
+			uint64 eventCount = reader.ReadVarint();
+			for (uint64 i = 0; i < eventCount && !reader.failed; ++i)
+			{
+				Input::InputEvent event;
+				event.type = (Input::InputEventType)(uint8)(reader.position < reader.end ? *reader.position++ : 0);
+				event.x = (int)reader.ReadSignedVarint();
+				event.y = (int)reader.ReadSignedVarint();
+				frame.events.push_back(event);
+			}
+
+			uint64 warpCount = reader.ReadVarint();
+			for (uint64 i = 0; i < warpCount && !reader.failed; ++i)
+			{
+				int x = (int)reader.ReadSignedVarint();
+				int y = (int)reader.ReadSignedVarint();
+				frame.warps.push_back(glm::ivec2(x, y));
+			}
+		}
+
+		if (reader.failed || fixedLogicRate == 0)
+		{
+			std::cout << "Error: Input recording " << path << " is truncated" << std::endl;
+			return false;
+		}
+
+		FrameTime::SetFixedLogicRate(fixedLogicRate);
+		FrameTime::SetMaxFixedLoopsPerFrame(maxFixedLoops);
+
+		m_mode = MODE_REPLAYING;
+		m_frames.swap(frames);
+		m_replayFrame = 0;
+		m_desyncCount = 0;
+		m_buffer.clear();
+
+		std::cout << "Loaded input recording " << path << ": " << m_frames.size() << " frames at " << fixedLogicRate << " fixed loops per second" << std::endl;
+		return true;
+	}
+
+	void InputRecorder::BeginRecordedFrame(std::chrono::nanoseconds frameDuration)
+	{
+		m_currentFrame.duration = frameDuration;
+		m_currentFrame.events.clear();
+		m_currentFrame.warps.clear();
+	}
+
+	bool InputRecorder::BeginReplayedFrame()
+	{
+		if (m_replayFrame >= m_frames.size())
+		{
+			return false;
+		}
+		++m_replayFrame;
+		m_replayedWarps = 0;
+		m_frameDesynced = false;
+		return true;
+	}
+
+	void InputRecorder::EndFrame()
+	{
+		if (IsRecording())
+		{
+			WriteVarint(m_buffer, (uint64)std::max(m_currentFrame.duration.count(), (std::chrono::nanoseconds::rep)0));
+			WriteVarint(m_buffer, m_currentFrame.events.size());
+			for (const Input::InputEvent& event : m_currentFrame.events)
+			{
+				m_buffer.push_back((char)event.type);
+				WriteSignedVarint(m_buffer, event.x);
+				WriteSignedVarint(m_buffer, event.y);
+			}
+			WriteVarint(m_buffer, m_currentFrame.warps.size());
+			for (const glm::ivec2& warp : m_currentFrame.warps)
+			{
+				WriteSignedVarint(m_buffer, warp.x);
+				WriteSignedVarint(m_buffer, warp.y);
+			}
+			++m_recordedFrames;
+		}
+		else if (IsReplaying() && m_replayFrame > 0)
+		{
+			// Fewer warps than were recorded means the simulation has gone a different way too
+			if (m_replayedWarps != m_frames[m_replayFrame - 1].warps.size())
+			{
+				MarkDesynced();
+			}
+		}
+	}
+
+	void InputRecorder::ProcessEvents(std::vector<Input::InputEvent>& events)
+	{
+		if (IsRecording())
+		{
+			m_currentFrame.events.insert(m_currentFrame.events.end(), events.begin(), events.end());
+		}
+		else if (IsReplaying() && m_replayFrame > 0)
+		{
+			// Live input is ignored while replaying
+			events = m_frames[m_replayFrame - 1].events;
+		}
+	}
+
+	void InputRecorder::RecordWarp(int x, int y)
+	{
+		if (IsRecording())
+		{
+			m_currentFrame.warps.push_back(glm::ivec2(x, y));
+		}
+		else if (IsReplaying() && m_replayFrame > 0)
+		{
+			const std::vector<glm::ivec2>& warps = m_frames[m_replayFrame - 1].warps;
+			if (m_replayedWarps >= warps.size() || warps[m_replayedWarps] != glm::ivec2(x, y))
+			{
+				MarkDesynced();
+			}
+			++m_replayedWarps;
+		}
+	}
+
+	void InputRecorder::MarkDesynced()
+	{
+		if (m_frameDesynced)
+		{
+			return;
+		}
+		if (m_desyncCount == 0)
+		{
+			std::cout << "Warning: Replay has diverged from the recording at frame " << m_replayFrame << std::endl;
+		}
+		m_frameDesynced = true;
+		++m_desyncCount;
+	}
+
+	uint64 InputRecorder::GetFrameCount() const
+	{
+		return IsReplaying() ? m_replayFrame : m_recordedFrames;
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "Input.h"
+#include <glm\vec2.hpp>
+
+namespace snes
+{
+	/** Input Recorder
+	  * Records the input events, cursor warps and frame durations the simulation sees, so the same run can be played back later.
+	  * Replaying feeds the recorded events and durations back in place of the live ones, so the camera path and gameplay
+	  * repeat exactly and benchmarks can be compared across builds and machines.
+	  *
+	  * File layout (little-endian, V = LEB128 varint, Z = zigzag varint):
+	  *   header: magic "SNIR", uint32 version, uint32 fixed logic rate, uint32 max fixed loops per frame
+	  *   frames: until the end of the file, per frame:
+	  *           V duration in nanoseconds, V event count, then per event: uint8 type, Z x, Z y,
+	  *           V warp count, then per warp: Z x, Z y
+	  *
+	  * Events are stored as they were queued, with absolute mouse positions and the point each warp took effect (MOUSE_WARP),
+	  * so applying them reproduces the mouse offsets. Version 1 recordings had no MOUSE_WARP events, so aren't supported.
+	  * Warps are made by the simulation itself, so a replay doesn't apply them; it checks they still happen, to catch
+	  * replays that have diverged from the recording (e.g. a different scene). */
+	class InputRecorder
+	{
+	public:
+		InputRecorder() {};
+		~InputRecorder() {};
+
+		/** Start recording from the next frame, dropping anything recorded or loaded before */
+		void StartRecording();
+		/** Write everything recorded so far to a file
+		  * @return true if the file was written */
+		bool SaveRecording(const std::string& path) const;
+
+		/** Load a recording and start replaying it from the next frame. Also sets the fixed logic rate and loop limit it was
+		  * recorded with, as both change how the frame durations are split into fixed steps
+		  * @return true if the file was loaded */
+		bool LoadReplay(const std::string& path);
+
+		bool IsRecording() const { return m_mode == MODE_RECORDING; }
+		bool IsReplaying() const { return m_mode == MODE_REPLAYING; }
+
+		/** Start a recorded frame that lasted a given time */
+		void BeginRecordedFrame(std::chrono::nanoseconds frameDuration);
+		/** Move on to the next replayed frame
+		  * @return false if the replay has finished */
+		bool BeginReplayedFrame();
+		/** @return the duration of the current replayed frame */
+		std::chrono::nanoseconds GetReplayedFrameDuration() const { return m_frames[m_replayFrame - 1].duration; }
+		/** Finish the current frame, storing it when recording */
+		void EndFrame();
+
+		/** Called by Input::ProcessEvents() with the events about to be applied. Records them, or replaces them with the
+		  * recorded events when replaying */
+		void ProcessEvents(std::vector<Input::InputEvent>& events);
+		/** Called by Input::WarpMousePos(). Records the warp, or checks it was in the recording when replaying */
+		void RecordWarp(int x, int y);
+
+		/** @return the number of frames recorded, or replayed so far */
+		uint64 GetFrameCount() const;
+		/** @return the number of frames in the loaded replay */
+		uint64 GetReplayLength() const { return m_frames.size(); }
+		/** @return the number of replayed frames whose warps didn't match the recording */
+		uint64 GetDesyncCount() const { return m_desyncCount; }
+
+	private:
+		static constexpr uint32 MAGIC = 0x52494E53; // "SNIR"
+		static constexpr uint32 VERSION = 2;
+
+		enum Mode
+		{
+			MODE_OFF,
+			MODE_RECORDING,
+			MODE_REPLAYING
+		};
+
+		struct Frame
+		{
+			std::chrono::nanoseconds duration;
+			std::vector<Input::InputEvent> events;
+			std::vector<glm::ivec2> warps;
+		};
+
+		/** Count the current replayed frame as diverged from the recording, warning the first time */
+		void MarkDesynced();
+
+		Mode m_mode = MODE_OFF;
+
+		/** The frame being recorded */
+		Frame m_currentFrame;
+		/** The header and the frames recorded so far, encoded in the file layout */
+		std::vector<char> m_buffer;
+		uint64 m_recordedFrames = 0;
+
+		/** The loaded replay */
+		std::vector<Frame> m_frames;
+		/** The number of replayed frames started, so the current one is at m_replayFrame - 1 */
+		uint64 m_replayFrame = 0;
+		/** The number of warps the simulation has made this frame */
+		uint m_replayedWarps = 0;
+		bool m_frameDesynced = false;
+		uint64 m_desyncCount = 0;
+	};
+}
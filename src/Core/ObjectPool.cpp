@@ -0,0 +1,7 @@
+#include "stdafx.h"
+#include "ObjectPool.h"
+
+namespace snes
+{
+	uint ObjectPools::m_nextTypeId = 0;
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+#pragma once
+#include <type_traits>
+
+namespace snes
+{
+	/** Pool Base
+	  * Type-erased interface so pools of different types can be owned and torn down together */
+	class PoolBase
+	{
+	public:
+		PoolBase() {};
+		virtual ~PoolBase() {};
+
+		/** Destroy every live object in the pool and mark all slots as free */
+		virtual void Clear() = 0;
+		/** @return the number of live objects in the pool */
+		virtual uint GetLiveCount() const = 0;
+	};
+
+	/** Typed Pool
+	  * A pool that can destroy objects through a pointer to a common base type,
+	  * e.g. a Component* whose concrete type is only known to the pool that created it */
+	template <typename Base>
+	class TypedPool : public PoolBase
+	{
+	public:
+		/** Destroy an object created by this pool and return its slot to the free list */
+		virtual void Destroy(Base* object) = 0;
+	};
+
+	/** Object Pool
+	  * Allocates objects of a single type from fixed-size chunks.
+	  * Freed slots are kept on an intrusive free list and reused by the next Create(), so spawning
+	  * and destroying objects doesn't touch the heap once the pool has grown to its working size.
+	  * Chunks are only released when the pool is destroyed, so an object never moves while it is alive. */
+	template <typename T, typename Base = T>
+	class ObjectPool final : public TypedPool<Base>
+	{
+	public:
+		/** The number of objects allocated at once when the pool runs out of free slots */
+		static constexpr uint SLOTS_PER_CHUNK = 256;
+
+		ObjectPool() {};
+		~ObjectPool() { Clear(); }
+
+		ObjectPool(const ObjectPool&) = delete;
+		ObjectPool& operator=(const ObjectPool&) = delete;
+
+		/** Construct a new object in a free slot, growing the pool if there are none
+		  * @return the created object */
+		template <typename... Args>
+		T* Create(Args&&... args)
+		{
+			if (!m_freeList)
+			{
+				AddChunk();
+			}
+
+			Slot* slot = m_freeList;
+			m_freeList = slot->nextFree;
+
+			T* object = new (slot->storage) T(std::forward<Args>(args)...);
+			slot->live = true;
+			++m_liveCount;
+			return object;
+		}
+
+		/** Destroy an object created by this pool and return its slot to the free list */
+		void Destroy(Base* object) override
+		{
+			if (!object)
+			{
+				return;
+			}
+
+			T* typedObject = static_cast<T*>(object);
+			Slot* slot = reinterpret_cast<Slot*>(typedObject);
+			typedObject->~T();
+			slot->live = false;
+			slot->nextFree = m_freeList;
+			m_freeList = slot;
+			--m_liveCount;
+		}
+
+		/** Destroy every live object in the pool and mark all slots as free.
+		  * Types with trivial destructors skip straight to rebuilding the free list. */
+		void Clear() override
+		{
+			m_freeList = nullptr;
+
+			// Walk backwards so the rebuilt free list hands out slots in address order
+			for (uint chunk = m_chunks.size(); chunk-- > 0;)
+			{
+				Slot* slots = m_chunks[chunk].get();
+				for (uint i = SLOTS_PER_CHUNK; i-- > 0;)
+				{
+					Slot& slot = slots[i];
+					if (!std::is_trivially_destructible<T>::value && slot.live)
+					{
+						reinterpret_cast<T*>(slot.storage)->~T();
+					}
+					slot.live = false;
+					slot.nextFree = m_freeList;
+					m_freeList = &slot;
+				}
+			}
+
+			m_liveCount = 0;
+		}
+
+		/** Grow the pool so it can hold at least this many objects without allocating */
+		void Reserve(uint count)
+		{
+			while (m_chunks.size() * SLOTS_PER_CHUNK < count)
+			{
+				AddChunk();
+			}
+		}
+
+		/** @return the number of live objects in the pool */
+		uint GetLiveCount() const override { return m_liveCount; }
+		/** @return the number of objects the pool can hold without allocating */
+		uint GetCapacity() const { return m_chunks.size() * SLOTS_PER_CHUNK; }
+
+	private:
+		/** Storage for one object. The object is placed at the start of the slot,
+		  * so a pointer to the object is also a pointer to its slot. */
+		struct Slot
+		{
+			alignas(T) unsigned char storage[sizeof(T)];
+			Slot* nextFree;
+			bool live;
+		};
+
+		/** Allocate a new chunk of slots and push them onto the free list */
+		void AddChunk()
+		{
+			m_chunks.emplace_back(new Slot[SLOTS_PER_CHUNK]);
+			Slot* slots = m_chunks.back().get();
+
+			for (uint i = SLOTS_PER_CHUNK; i-- > 0;)
+			{
+				slots[i].live = false;
+				slots[i].nextFree = m_freeList;
+				m_freeList = &slots[i];
+			}
+		}
+
+		std::vector<std::unique_ptr<Slot[]>> m_chunks;
+		/** The next slot to hand out */
+		Slot* m_freeList = nullptr;
+		uint m_liveCount = 0;
+	};
+
+	/** Object Pools
+	  * Owns one ObjectPool per type, created the first time that type is requested.
+	  * Clearing every pool tears down all the objects they hold without touching the heap. */
+	class ObjectPools
+	{
+	public:
+		ObjectPools() {};
+		~ObjectPools() { Clear(); }
+
+		/** @return the pool for objects of type T destroyed through Base, creating it if it doesn't exist yet.
+		  * The same T with a different Base gets a pool of its own */
+		template <typename T, typename Base = T>
+		ObjectPool<T, Base>& Get()
+		{
+			uint typeId = GetTypeId<ObjectPool<T, Base>>();
+			if (typeId >= m_pools.size())
+			{
+				m_pools.resize(typeId + 1);
+			}
+			if (!m_pools[typeId])
+			{
+				m_pools[typeId] = std::make_unique<ObjectPool<T, Base>>();
+			}
+			return static_cast<ObjectPool<T, Base>&>(*m_pools[typeId]);
+		}
+
+		/** Destroy every object in every pool */
+		void Clear()
+		{
+			for (auto& pool : m_pools)
+			{
+				if (pool)
+				{
+					pool->Clear();
+				}
+			}
+		}
+
+		/** @return the number of live objects in the pool for type T destroyed through Base, or 0 if it hasn't been created */
+		template <typename T, typename Base = T>
+		uint GetLiveCount() const
+		{
+			uint typeId = GetTypeId<ObjectPool<T, Base>>();
+			return (typeId < m_pools.size() && m_pools[typeId]) ? m_pools[typeId]->GetLiveCount() : 0;
+		}
+
+		/** @return the number of live objects across all pools */
+		uint GetLiveCount() const
+		{
+			uint count = 0;
+			for (auto& pool : m_pools)
+			{
+				if (pool)
+				{
+					count += pool->GetLiveCount();
+				}
+			}
+			return count;
+		}
+
+	private:
+		/** @return a small index unique to type T (the pool's type), assigned the first time it is asked for */
+		template <typename T>
+		static uint GetTypeId()
+		{
+			static const uint typeId = m_nextTypeId++;
+			return typeId;
+		}
+
+		static uint m_nextTypeId;
+
+		std::vector<std::unique_ptr<PoolBase>> m_pools;
+	};
+}
@@ -0,0 +1,167 @@
+#include "stdafx.h"
+#include "Profiler.h"
+
+#if SNES_PROFILING
+
+#include "FrameTime.h"
+#include <fstream>
+#include <mutex>
+
+namespace snes
+{
+	std::atomic<bool> Profiler::m_recording{ false };
+	constexpr uint ProfileBuffer::CAPACITY;
+	constexpr uint64 ProfileZone::NOT_RECORDING;
+
+	namespace
+	{
+		/** Every thread's buffer. Buffers outlive their threads so their events can still be exported */
+		std::mutex buffersMutex;
+		std::vector<std::unique_ptr<ProfileBuffer>> buffers;
+
+		/** The time Start() was last called */
+		Clock::time_point sessionStart = Clock::now();
+	}
+
+	void Profiler::Start()
+	{
+		{
+			// Discard events from any earlier session
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			for (auto& buffer : buffers)
+			{
+				buffer->m_head.store(0, std::memory_order_relaxed);
+			}
+		}
+		sessionStart = Clock::now();
+		m_recording.store(true, std::memory_order_relaxed);
+	}
+
+	uint64 Profiler::GetTime()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sessionStart).count();
+	}
+
+	void Profiler::RecordZone(const char* name, uint64 start)
+	{
+		ProfileEvent event;
+		event.name = name;
+		event.start = start;
+		event.duration = GetTime() - start;
+		event.type = ProfileEvent::ZONE;
+		GetThreadBuffer().Push(event);
+	}
+
+	void Profiler::RecordCounter(const char* name, double value)
+	{
+		if (!IsRecording())
+		{
+			return;
+		}
+
+		ProfileEvent event;
+		event.name = name;
+		event.start = GetTime();
+		event.value = value;
+		event.type = ProfileEvent::COUNTER;
+		GetThreadBuffer().Push(event);
+	}
+
+	void Profiler::MarkFrame()
+	{
+		if (!IsRecording())
+		{
+			return;
+		}
+
+		ProfileEvent event;
+		event.name = "Frame";
+		event.start = GetTime();
+		event.duration = 0;
+		event.type = ProfileEvent::FRAME;
+		GetThreadBuffer().Push(event);
+	}
+
+	ProfileBuffer& Profiler::GetThreadBuffer()
+	{
+		// Only the first event on each thread takes the lock
+		thread_local ProfileBuffer* threadBuffer = nullptr;
+		if (!threadBuffer)
+		{
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			buffers.push_back(std::make_unique<ProfileBuffer>((uint)buffers.size() + 1));
+			threadBuffer = buffers.back().get();
+		}
+		return *threadBuffer;
+	}
+
+	bool Profiler::WriteChromeTrace(const std::string& path)
+	{
+		std::ofstream out(path, std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			std::cout << "Error: Could not open " << path << " to write the profiler trace" << std::endl;
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(buffersMutex);
+
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool first = true;
+		uint64 eventCount = 0;
+		uint64 droppedCount = 0;
+
+		for (auto& buffer : buffers)
+		{
+			uint64 head = buffer->m_head.load(std::memory_order_acquire);
+			uint64 begin = head > ProfileBuffer::CAPACITY ? head - ProfileBuffer::CAPACITY : 0;
+			droppedCount += begin;
+
+			out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->m_threadId
+				<< ",\"args\":{\"name\":\"" << (buffer->m_threadId == 1 ? "Main" : "Worker") << " " << buffer->m_threadId << "\"}}";
+			first = false;
+
+			// Mark where this thread's events start, so the gap before it isn't mistaken for idle time
+			if (begin > 0)
+			{
+				const ProfileEvent& oldest = buffer->m_events[begin & (ProfileBuffer::CAPACITY - 1)];
+				out << ",\n{\"name\":\"" << begin << " earlier events overwritten\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":"
+					<< buffer->m_threadId << ",\"ts\":" << oldest.start / 1000.0 << "}";
+			}
+
+			for (uint64 i = begin; i < head; ++i)
+			{
+				const ProfileEvent& event = buffer->m_events[i & (ProfileBuffer::CAPACITY - 1)];
+
+				// Trace timestamps are in microseconds
+				out << ",\n{\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << buffer->m_threadId
+					<< ",\"ts\":" << event.start / 1000.0;
+				switch (event.type)
+				{
+				case ProfileEvent::ZONE:
+					out << ",\"ph\":\"X\",\"dur\":" << event.duration / 1000.0 << "}";
+					break;
+				case ProfileEvent::COUNTER:
+					out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+					break;
+				case ProfileEvent::FRAME:
+					out << ",\"ph\":\"i\",\"s\":\"g\"}";
+					break;
+				}
+				++eventCount;
+			}
+		}
+
+		out << "\n]}\n";
+
+		std::cout << "Profiler trace written to " << path << " (" << eventCount << " events)" << std::endl;
+		if (droppedCount > 0)
+		{
+			std::cout << "Warning: " << droppedCount << " events were overwritten, so the trace is missing the start of the run. Each thread keeps its last "
+				<< ProfileBuffer::CAPACITY << " events" << std::endl;
+		}
+		return true;
+	}
+}
+
+#endif
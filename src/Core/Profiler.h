@@ -0,0 +1,151 @@
+#pragma once
+#include <atomic>
+
+/** Profiling is compiled in unless building for release (NDEBUG).
+  * Define SNES_PROFILING=1 to keep it in a release build, or SNES_PROFILING=0 to strip it from a debug one. */
+#ifndef SNES_PROFILING
+#ifdef NDEBUG
+#define SNES_PROFILING 0
+#else
+#define SNES_PROFILING 1
+#endif
+#endif
+
+#if SNES_PROFILING
+
+#define SNES_PROFILE_CONCAT_INNER(a, b) a##b
+#define SNES_PROFILE_CONCAT(a, b) SNES_PROFILE_CONCAT_INNER(a, b)
+
+/** Time the rest of the enclosing scope. The name must be a string literal (it is stored, not copied) */
+#define PROFILE_ZONE(name) ::snes::ProfileZone SNES_PROFILE_CONCAT(profileZone, __LINE__)(name)
+/** Time the rest of the enclosing function, named after the function */
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+/** Record the current value of a counter. The name must be a string literal */
+#define PROFILE_COUNTER(name, value) ::snes::Profiler::RecordCounter(name, (double)(value))
+/** Mark the start of a new frame */
+#define PROFILE_FRAME() ::snes::Profiler::MarkFrame()
+
+namespace snes
+{
+	/** Profile Event
+	  * One zone, counter sample or frame marker, as stored in a thread's ring buffer */
+	struct ProfileEvent
+	{
+		enum Type : uint8
+		{
+			ZONE,
+			COUNTER,
+			FRAME
+		};
+
+		const char* name;
+		/** Start time, in nanoseconds since the profiler started */
+		uint64 start;
+		/** Zone duration in nanoseconds, or the counter's value */
+		union
+		{
+			uint64 duration;
+			double value;
+		};
+		Type type;
+	};
+
+	/** Profile Buffer
+	  * Fixed-size ring buffer of the most recent events recorded on one thread.
+	  * Only its own thread writes to it, so recording is a store and an atomic increment with no locks.
+	  * Once full, the oldest events are overwritten. */
+	class ProfileBuffer
+	{
+	public:
+		/** The number of events kept per thread */
+		static constexpr uint CAPACITY = 1 << 16;
+
+		ProfileBuffer(uint threadId) : m_threadId(threadId), m_events(CAPACITY) {}
+
+		void Push(const ProfileEvent& event)
+		{
+			uint64 head = m_head.load(std::memory_order_relaxed);
+			m_events[head & (CAPACITY - 1)] = event;
+			m_head.store(head + 1, std::memory_order_release);
+		}
+
+	private:
+		friend class Profiler;
+
+		uint m_threadId;
+		std::vector<ProfileEvent> m_events;
+		/** The total number of events ever pushed. The buffer holds the last min(head, CAPACITY) of them */
+		std::atomic<uint64> m_head{ 0 };
+	};
+
+	/** Profiler
+	  * Records scoped zones, counters and frame markers from any thread, and exports them
+	  * in the Chrome trace-event JSON format (viewable in chrome://tracing or Perfetto).
+	  * Use the PROFILE_ macros rather than calling this directly, so release builds compile it out.
+	  * Nothing is recorded until Start() is called. Each thread keeps only its last ProfileBuffer::CAPACITY events,
+	  * so a long recording loses its start. */
+	class Profiler
+	{
+	public:
+		/** Start recording events */
+		static void Start();
+		/** Stop recording events. Already recorded events are kept until the next Start() */
+		static void Stop() { m_recording.store(false, std::memory_order_relaxed); }
+		/** @return true if events are being recorded */
+		static bool IsRecording() { return m_recording.load(std::memory_order_relaxed); }
+
+		/** @return the current time, in nanoseconds since Start() */
+		static uint64 GetTime();
+
+		/** Record a zone that started at start (from GetTime()) and ends now */
+		static void RecordZone(const char* name, uint64 start);
+		/** Record the value of a counter */
+		static void RecordCounter(const char* name, double value);
+		/** Record the start of a new frame */
+		static void MarkFrame();
+
+		/** Write every event still held to a Chrome trace JSON file, warning if older ones were overwritten.
+		  * Call once recording threads have stopped.
+		  * @return true if the file was written */
+		static bool WriteChromeTrace(const std::string& path);
+
+	private:
+		/** @return this thread's buffer, creating and registering it the first time */
+		static ProfileBuffer& GetThreadBuffer();
+
+		static std::atomic<bool> m_recording;
+	};
+
+	/** Profile Zone
+	  * Records the time between its construction and destruction. Use PROFILE_ZONE() */
+	class ProfileZone
+	{
+	public:
+		ProfileZone(const char* name) : m_name(name), m_start(Profiler::IsRecording() ? Profiler::GetTime() : NOT_RECORDING) {}
+		~ProfileZone()
+		{
+			if (m_start != NOT_RECORDING)
+			{
+				Profiler::RecordZone(m_name, m_start);
+			}
+		}
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+
+	private:
+		static constexpr uint64 NOT_RECORDING = ~0ull;
+
+		const char* m_name;
+		uint64 m_start;
+	};
+}
+
+#else
+
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+
+#endif
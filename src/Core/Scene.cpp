@@ -1,6 +1,8 @@
 #include "stdafx.h"
 #include "Scene.h"
 #include "Input.h"
+#include "Profiler.h"
+#include "SceneSnapshot.h"
 #include <Components\AABBCollider.h>
 #include <Components\Camera.h>
 #include <Components\ControllableCamera.h>
@@ -8,10 +10,13 @@
 #include <Components\LODModel.h>
 #include <Components\MeshRenderer.h>
 #include <Components\Rigidbody.h>
+#include <Components\SphereCollider.h>
 #include <Components\TessModel.h>
 #include <Components\TestComponent.h>
 #include <Components\ToggleModel.h>
 
+#include <Rendering\GLState.h>
+#include <Rendering\GraphicsDevice.h>
 #include <Rendering\Mesh.h>
 #include <Rendering\Materials\DiscoMat.h>
 #include <Rendering\Materials\LitColourMat.h>
@@ -20,41 +25,51 @@
 #include <Rendering\Materials\UnlitTexturedMat.h>
 #include <Rendering\Materials\TessellatedMat.h>
 #include <Rendering\Materials\SilhouetteTessellatedMat.h>
+#include <glm\gtc\constants.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace snes
 {
+	namespace
+	{
+		/** The view uniform buffer holds each shadow cascade's camera, then the main camera */
+		const uint GEOMETRY_VIEW = ShadowCascades::COUNT;
+		const uint VIEW_COUNT = ShadowCascades::COUNT + 1;
+	}
+
 	Scene::Scene()
 	{
-		m_root = std::make_shared<GameObject>(nullptr);
+		m_root = m_pools.Get<GameObject>().Create(nullptr, m_pools, m_phases);
 	}
 
 	Scene::~Scene()
 	{
-
+		// Bulk teardown: drop the phase lists and release every pool in one go, rather than destroying objects one by one
+		m_phases.Clear();
+		m_pools.Clear();
 	}
 
-	void Scene::InitialiseScene()
+	void Scene::InitialiseScene(const std::string& snapshotPath)
 	{
 		m_deferredLightingMgr.Init();
+		m_viewUniforms.Init(VIEW_COUNT);
 
-		// Create camera
-		m_camera = m_root->AddChild().lock();
-		auto camera = m_camera->AddComponent<ControllableCamera>().lock();
-		m_camera->GetTransform().SetLocalPosition(glm::vec3(0, -4.0f, 18.0f));
-		m_camera->GetTransform().SetLocalRotation(glm::vec3(-29.4f, 270.0f, 0.0f));
+		if (!snapshotPath.empty())
+		{
+			if (LoadSnapshot(snapshotPath))
+			{
+				return;
+			}
+			std::cout << "Falling back to the demo scene" << std::endl;
+		}
 
-		// Create directional light
-		m_directionalLight = m_root->AddChild().lock();
-		auto directionalCamera = m_directionalLight->AddComponent<Camera>().lock();
-		auto directionalLight = m_directionalLight->AddComponent<DirectionalLight>().lock();
-		m_directionalLight->GetTransform().SetLocalRotation(glm::vec3(-45.0f, 45.0f, -45.4f));
-		directionalCamera->SetOrthographic(true);
-		directionalLight->SetCamera(directionalCamera);
+		Camera* camera = CreateCameraAndDirectionalLight();
 		
-		//CreateJiggy(glm::vec3(15, 0, 0), camera.lock(), texturedMat);
-		//CreateJiggy(glm::vec3(-15, 0, 0), camera.lock(), texturedMat);
-		//CreateJiggy(glm::vec3(0, 0, 15), camera.lock(), texturedMat);
-		auto lodReferenceObj = CreateLink(glm::vec3(-15, -6, -15), camera);
+		//CreateJiggy(glm::vec3(15, 0, 0), camera, texturedMat);
+		//CreateJiggy(glm::vec3(-15, 0, 0), camera, texturedMat);
+		//CreateJiggy(glm::vec3(0, 0, 15), camera, texturedMat);
+		GameObject* lodReferenceObj = &CreateLink(glm::vec3(-15, -6, -15), camera);
 		CreateFloor(camera);
 		// Create a ton of spheres
 		for (int i = -10; i < 10; i++)
@@ -79,22 +94,149 @@ namespace snes
 		bigLight.GetComponent<PointLight>()->SetQuadraticAttenuation(0.002f);*/
 	}
 
+	void Scene::InitialiseStressScene(const StressSceneSettings& settings)
+	{
+		m_deferredLightingMgr.Init();
+		m_viewUniforms.Init(VIEW_COUNT);
+
+		Camera* camera = CreateCameraAndDirectionalLight();
+		CreateFloor(camera);
+
+		// Objects at depth 1 are children of the root, so only deeper objects need empty parents
+		uint parentDepth = std::max(settings.hierarchyDepth, 1u) - 1;
+
+		// Lay the spheres out in a square grid centred on the origin
+		const float spacing = 2.0f;
+		uint gridSize = (uint)std::ceil(std::sqrt((float)settings.lodSpheres));
+		float gridOffset = (gridSize - 1) * spacing * 0.5f;
+		for (uint i = 0; i < settings.lodSpheres; ++i)
+		{
+			glm::vec3 pos((i % gridSize) * spacing - gridOffset, 0.0f, (i / gridSize) * spacing - gridOffset);
+			CreateSphere(pos, camera, m_camera, &CreateHierarchy(parentDepth));
+		}
+
+		// Moving bodies start spread over the same area, heading outwards in different directions
+		for (uint i = 0; i < settings.rigidbodies; ++i)
+		{
+			float angle = glm::two_pi<float>() * i / std::max(settings.rigidbodies, 1u);
+			glm::vec3 direction(std::cos(angle), 0.0f, std::sin(angle));
+			glm::vec3 pos = direction * (gridOffset * (i % 10) / 10.0f) + glm::vec3(0.0f, 2.0f, 0.0f);
+			CreateMovingBody(pos, direction, &CreateHierarchy(parentDepth));
+		}
+
+		// A ring of lights above the spheres, cycling through a few colours
+		const glm::vec3 colours[] = { glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1), glm::vec3(1, 1, 1) };
+		for (uint i = 0; i < settings.pointLights; ++i)
+		{
+			float angle = glm::two_pi<float>() * i / settings.pointLights;
+			glm::vec3 pos(std::cos(angle) * gridOffset, 4.0f, std::sin(angle) * gridOffset);
+			CreatePointLight(*m_root, pos, colours[i % 4]);
+		}
+	}
+
+	bool Scene::SaveSnapshot(const std::string& path)
+	{
+		return SceneSnapshot::Save(path, *m_root);
+	}
+
+	bool Scene::LoadSnapshot(const std::string& path)
+	{
+		// Clear out whatever is already in the scene
+		while (!m_root->GetChildren().empty())
+		{
+			m_root->GetChildren().back()->Destroy();
+		}
+		m_pointLights.clear();
+		m_camera = nullptr;
+		m_directionalLight = nullptr;
+
+		if (SceneSnapshot::Load(path, *m_root, m_pools) && FindSceneObjects())
+		{
+			return true;
+		}
+
+		// Don't leave a partially loaded scene behind
+		while (!m_root->GetChildren().empty())
+		{
+			m_root->GetChildren().back()->Destroy();
+		}
+		m_pointLights.clear();
+		return false;
+	}
+
+	bool Scene::FindSceneObjects()
+	{
+		m_camera = nullptr;
+		m_directionalLight = nullptr;
+		m_pointLights.clear();
+
+		for (GameObject* object : m_root->GetAllChildren())
+		{
+			if (object->GetComponent<DirectionalLight>())
+			{
+				if (!m_directionalLight)
+				{
+					m_directionalLight = object;
+				}
+			}
+			else if (object->GetComponent<ControllableCamera>() || (!m_camera && object->GetComponent<Camera>()))
+			{
+				// Prefer the controllable camera over any other camera
+				if (!m_camera || !m_camera->GetComponent<ControllableCamera>())
+				{
+					m_camera = object;
+				}
+			}
+
+			PointLight* pointLight = object->GetComponent<PointLight>();
+			if (pointLight)
+			{
+				m_pointLights.push_back(pointLight);
+			}
+		}
+
+		if (!m_camera || !m_directionalLight)
+		{
+			std::cout << "Error: Scene needs a camera and a directional light" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
 	void Scene::FixedLogic()
 	{
-		LODModel::StartNewFrame();
+		PROFILE_FUNCTION();
+		Clock::time_point start = Clock::now();
 
-		m_root->FixedLogic();
+		SystemScheduler::Advance();
 
-		LODModel::SortAndSetLODValues();
+		// LOD valuation only happens on the steps its system is due, as its per-model work is skipped on the others
+		bool lodDue = SystemScheduler::IsDue(SystemScheduler::GetSystem<LODModel>());
+		LODModel::PollInput();
+		if (lodDue)
+		{
+			LODModel::StartNewFrame();
+		}
+
+		Transform::BeginFixedStep();
+		m_phases.FixedLogic();
+		Transform::EndFixedStep();
+
+		if (lodDue)
+		{
+			LODModel::SortAndSetLODValues();
+		}
+
+		AddPhaseTime(SCENE_PHASE_FIXED_LOGIC, start);
 
 		// Generate list of all GameObjects
-		//std::vector<std::weak_ptr<GameObject>> allObjects = m_root->GetAllChildren();
+		//std::vector<GameObject*> allObjects = m_root->GetAllChildren();
 
 		// Handle collision between all GameObjects once
 		/*
 		for (uint i = 0; i < allObjects.size(); i++)
 		{
-			auto currentObject = allObjects.at(i).lock();
+			auto currentObject = allObjects.at(i);
 			auto rigidbody = currentObject->GetComponent<Rigidbody>();
 
 			if (!rigidbody)
@@ -104,10 +246,7 @@ namespace snes
 
 			for (uint j = (i + 1); j < allObjects.size(); j++)
 			{
-				if (!allObjects.at(j).expired())
-				{ 
-					rigidbody->HandleCollision(*allObjects.at(j).lock());
-				}
+				rigidbody->HandleCollision(*allObjects.at(j));
 			}
 
 			rigidbody->UpdatePosition();
@@ -115,42 +254,223 @@ namespace snes
 		*/
 	}
 
-	void Scene::MainDraw()
+	void Scene::MainLogic()
+	{
+		PROFILE_FUNCTION();
+		Clock::time_point start = Clock::now();
+		m_phases.MainLogic();
+		AddPhaseTime(SCENE_PHASE_MAIN_LOGIC, start);
+	}
+
+	void Scene::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		PROFILE_FUNCTION();
+		Clock::time_point start = Clock::now();
+
+		snapshot.Clear();
+		snapshot.frame = ++m_capturedFrames;
+		snapshot.inputSequence = Input::GetProcessedSequence();
+		snapshot.mouseTravel = Input::GetProcessedMouseTravel();
+		m_elapsedTime += FrameTime::GetLastFrameDuration();
+		snapshot.time = (float)m_elapsedTime;
+		snapshot.camera = CameraState::Capture(*m_camera->GetComponent<Camera>());
+
+		DirectionalLight* directionalLight = m_directionalLight->GetComponent<DirectionalLight>();
+		snapshot.directionalLight.camera = CameraState::Capture(*m_directionalLight->GetComponent<Camera>());
+		snapshot.directionalLight.position = directionalLight->GetTransform().GetWorldPosition();
+		snapshot.directionalLight.rotation = directionalLight->GetTransform().GetWorldRotation();
+		snapshot.directionalLight.colour = directionalLight->GetColour();
+
+		for (const Handle<PointLight>& handle : m_pointLights)
+		{
+			PointLight* pointLight = handle.Get();
+			if (pointLight)
+			{
+				snapshot.pointLights.push_back(PointLightState{ pointLight->GetTransform().GetWorldPosition(), pointLight->GetColour(),
+					pointLight->GetLinearAttenuation(), pointLight->GetQuadraticAttenuation() });
+			}
+		}
+
+		snapshot.wireframe = Input::GetKeyHeld('f');
+		m_phases.MainDraw(snapshot);
+		snapshot.staticItemHash = snapshot.HashStaticItems();
+
+		AddPhaseTime(SCENE_PHASE_CAPTURE, start);
+	}
+
+	void Scene::Render(const RenderSnapshot& snapshot)
+	{
+		Render(snapshot, snapshot.camera);
+	}
+
+	void Scene::Render(const RenderSnapshot& snapshot, const CameraState& camera)
 	{
+		PROFILE_FUNCTION();
+
+		// Nothing can be drawn without a GL context (e.g. when running headless)
+		if (!GraphicsDevice::IsAvailable())
+		{
+			GraphicsDevice::RecordSkippedDraw();
+			return;
+		}
+
+		// Nothing has been captured yet
+		if (snapshot.frame == 0)
+		{
+			return;
+		}
 
 		/** Shadow Pass */
 
-		Material::ResetCurrentShader();	// Tell Material to use a new shader the next time it is asked - this is dumb
-		m_deferredLightingMgr.PrepareNewShadowPass();
-		m_root->MainDraw(SHADOW_PASS, *m_directionalLight->GetComponent<Camera>());
+		PROFILE_COUNTER("Point lights", snapshot.pointLights.size());
+		Clock::time_point start = Clock::now();
+		{
+			PROFILE_ZONE("Shadow pass");
+			m_deferredLightingMgr.BeginFrame();
+			m_deferredLightingMgr.PrepareNewShadowPass(snapshot.directionalLight.camera, camera);
 
-		/** Geometry Pass */
+			// Every view the frame draws is known once the cascades are fitted, so they're all uploaded together
+			for (uint cascade = 0; cascade < ShadowCascades::COUNT; ++cascade)
+			{
+				m_viewUniforms.WriteView(cascade, m_deferredLightingMgr.GetShadowCascadeCamera(cascade), snapshot.time);
+			}
+			m_viewUniforms.WriteView(GEOMETRY_VIEW, camera, snapshot.time);
+			m_viewUniforms.Upload();
+
+			uint shadowDraws = 0;
+			uint shadowCulled = 0;
+			uint cascadesRedrawn = 0;
+			for (uint cascade = 0; cascade < ShadowCascades::COUNT; ++cascade)
+			{
+				m_viewUniforms.BindView(cascade);
+
+				// Static items' shadows are only drawn again once the cascade or the static items move
+				if (m_deferredLightingMgr.PrepareStaticShadowCascade(cascade, snapshot.staticItemHash))
+				{
+					const CameraState& cascadeCamera = m_deferredLightingMgr.GetShadowCascadeCamera(cascade);
+					m_renderQueue.Build(snapshot, RENDER_PASS_STATIC_SHADOW, cascadeCamera);
+					m_renderQueue.Sort();
+					m_renderQueue.Execute(snapshot, cascadeCamera);
+					shadowDraws += (uint)m_renderQueue.GetCommands().size();
+					++cascadesRedrawn;
+				}
 
-		Material::ResetCurrentShader();
-		m_deferredLightingMgr.PrepareNewGeometryPass();
+				const CameraState& cascadeCamera = m_deferredLightingMgr.PrepareShadowCascade(cascade);
+				m_renderQueue.Build(snapshot, RENDER_PASS_SHADOW, cascadeCamera);
+				m_renderQueue.Sort();
+				m_renderQueue.Execute(snapshot, cascadeCamera);
+				shadowDraws += (uint)m_renderQueue.GetCommands().size();
+				shadowCulled += m_renderQueue.GetCulledCount();
+			}
+			PROFILE_COUNTER("Shadow pass draws", shadowDraws);
+			PROFILE_COUNTER("Shadow casters culled", shadowCulled);
+			PROFILE_COUNTER("Static shadow cascades redrawn", cascadesRedrawn);
+			AddPhaseTime(SCENE_PHASE_SHADOW_PASS, start);
+		}
 
-		if (Input::GetKeyHeld('f'))
+		/** Geometry Pass */
+
+		start = Clock::now();
 		{
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+			PROFILE_ZONE("Geometry pass");
+			m_deferredLightingMgr.PrepareNewGeometryPass();
+			// Stays bound for the lighting pass, which is lit as seen from the same camera
+			m_viewUniforms.BindView(GEOMETRY_VIEW);
+
+			// Render all objects in geometry pass to deferred framebuffer
+			GLState::SetPolygonMode(snapshot.wireframe ? GL_LINE : GL_FILL);
+			m_renderQueue.Build(snapshot, RENDER_PASS_GEOMETRY, camera);
+			m_renderQueue.Sort();
+			m_renderQueue.Execute(snapshot, camera);
+			GLState::SetPolygonMode(GL_FILL);
+			AddPhaseTime(SCENE_PHASE_GEOMETRY_PASS, start);
 		}
-		// Render all objects in geometry pass to deferred framebuffer
-		m_root->MainDraw(GEOMETRY_PASS, *m_camera->GetComponent<Camera>());
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
 		/** Lighting */
 
 		// Render deferred lighting
-		m_deferredLightingMgr.RenderLighting(m_camera->GetComponent<Camera>(), m_pointLights, m_directionalLight->GetComponent<DirectionalLight>());
+		start = Clock::now();
+		m_deferredLightingMgr.RenderLighting(snapshot, camera);
+		AddPhaseTime(SCENE_PHASE_LIGHTING, start);
 
 		Mesh::ResetRenderCount();
+		GLState::EndFrame();
+	}
+
+	double Scene::GetPhaseTime(ScenePhase phase) const
+	{
+		return m_phaseTimes[phase].load() / (double)NS_IN_MS;
+	}
+
+	void Scene::ResetPhaseTimes()
+	{
+		for (auto& time : m_phaseTimes)
+		{
+			time.store(0);
+		}
+	}
+
+	const char* Scene::GetPhaseName(ScenePhase phase)
+	{
+		switch (phase)
+		{
+		case SCENE_PHASE_FIXED_LOGIC:
+			return "fixedLogic";
+		case SCENE_PHASE_MAIN_LOGIC:
+			return "mainLogic";
+		case SCENE_PHASE_CAPTURE:
+			return "capture";
+		case SCENE_PHASE_SHADOW_PASS:
+			return "shadowPass";
+		case SCENE_PHASE_GEOMETRY_PASS:
+			return "geometryPass";
+		case SCENE_PHASE_LIGHTING:
+			return "lighting";
+		default:
+			return "unknown";
+		}
+	}
+
+	void Scene::AddPhaseTime(ScenePhase phase, Clock::time_point start)
+	{
+		m_phaseTimes[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+	}
+
+	Camera* Scene::CreateCameraAndDirectionalLight()
+	{
+		// Create camera
+		m_camera = m_root->AddChild();
+		auto camera = m_camera->AddComponent<ControllableCamera>();
+		m_camera->GetTransform().SetLocalPosition(glm::vec3(0, -4.0f, 18.0f));
+		m_camera->GetTransform().SetLocalRotation(glm::vec3(-29.4f, 270.0f, 0.0f));
+
+		// Create directional light
+		m_directionalLight = m_root->AddChild();
+		auto directionalCamera = m_directionalLight->AddComponent<Camera>();
+		auto directionalLight = m_directionalLight->AddComponent<DirectionalLight>();
+		m_directionalLight->GetTransform().SetLocalRotation(glm::vec3(-45.0f, 45.0f, -45.4f));
+		directionalCamera->SetOrthographic(true);
+		directionalLight->SetCamera(directionalCamera);
+
+		return camera;
+	}
+
+	GameObject& Scene::CreateHierarchy(uint depth)
+	{
+		GameObject* parent = m_root;
+		for (uint i = 0; i < depth; ++i)
+		{
+			parent = parent->AddChild();
+		}
+		return *parent;
 	}
 
 	GameObject& Scene::CreatePointLight(GameObject& parent, glm::vec3 pos, glm::vec3 colour)
 	{
-		auto light = parent.AddChild().lock();
+		auto light = parent.AddChild();
 		light->GetTransform().SetLocalPosition(pos);
 
-		auto& pointLight = light->AddComponent<PointLight>().lock();
+		auto pointLight = light->AddComponent<PointLight>();
 		pointLight->SetColour(colour);
 		pointLight->SetLinearAttenuation(0.01f);
 		pointLight->SetQuadraticAttenuation(0.02f);
@@ -161,14 +481,14 @@ namespace snes
 		return *light;
 	}
 
-	GameObject& Scene::CreateJiggy(glm::vec3 pos, std::shared_ptr<Camera> camera, std::shared_ptr<Material> material)
+	GameObject& Scene::CreateJiggy(glm::vec3 pos, Camera* camera, std::shared_ptr<Material> material)
 	{
 		// Create the test jiggy
-		auto jiggy = m_root->AddChild().lock();
+		auto jiggy = m_root->AddChild();
 		jiggy->GetTransform().SetLocalPosition(pos);
 
 		// Make it render
-		auto& meshRenderer = jiggy->AddComponent<MeshRenderer>().lock();
+		auto meshRenderer = jiggy->AddComponent<MeshRenderer>();
 		meshRenderer->SetMesh("Models/Jiggy.obj");
 		meshRenderer->SetCamera(camera);
 		meshRenderer->SetMaterial(material);
@@ -188,14 +508,15 @@ namespace snes
 		return *jiggy;
 	}
 
-	GameObject& Scene::CreateSphere(glm::vec3 pos, std::shared_ptr<Camera> camera, std::weak_ptr<GameObject> lodReferenceObj)
+	GameObject& Scene::CreateSphere(glm::vec3 pos, Camera* camera, GameObject* lodReferenceObj, GameObject* parent)
 	{
 		// Create the test jiggy
-		auto sphere = m_root->AddChild().lock();
+		auto sphere = (parent ? parent : m_root)->AddChild();
+		sphere->SetStatic(true);
 		sphere->GetTransform().SetLocalPosition(pos);
 		sphere->GetTransform().SetLocalScale(glm::vec3(0.1f, 0.1f, 0.1f));
 
-		auto& lodModel = sphere->AddComponent<LODModel>().lock();
+		auto lodModel = sphere->AddComponent<LODModel>();
 		lodModel->SetCamera(camera);
 		lodModel->SetReferenceObject(lodReferenceObj);
 		lodModel->Load("Models/sphere");
@@ -207,23 +528,40 @@ namespace snes
 		return *sphere;
 	}
 
-	std::weak_ptr<GameObject> Scene::CreateLink(glm::vec3 pos, std::shared_ptr<Camera> camera)
+	GameObject& Scene::CreateMovingBody(glm::vec3 pos, glm::vec3 velocity, GameObject* parent)
+	{
+		auto body = (parent ? parent : m_root)->AddChild();
+		body->GetTransform().SetLocalPosition(pos);
+
+		auto rigidbody = body->AddComponent<Rigidbody>();
+		rigidbody->AddVelocity(velocity);
+
+		auto collider = body->AddComponent<SphereCollider>();
+		collider->SetBounds(glm::vec3(0.0f), 0.5f);
+
+		// TestComponent makes an object spin
+		body->AddComponent<TestComponent>();
+
+		return *body;
+	}
+
+	GameObject& Scene::CreateLink(glm::vec3 pos, Camera* camera)
 	{
 		// Create the test jiggy
-		auto link = m_root->AddChild().lock();
+		auto link = m_root->AddChild();
 		link->GetTransform().SetLocalPosition(pos);
 		link->GetTransform().SetLocalScale(glm::vec3(1.0f, 1.0f, 1.0f));
 		link->GetTransform().SetLocalRotation(glm::vec3(0, 180, 0));
 
-		auto& lodModel = link->AddComponent<LODModel>().lock();
+		auto lodModel = link->AddComponent<LODModel>();
 		lodModel->SetCamera(camera);
 		lodModel->Load("Models/testobj");
 
-		auto& tessModel = link->AddComponent<TessModel>().lock();
+		auto tessModel = link->AddComponent<TessModel>();
 		tessModel->SetCamera(camera);
 		tessModel->Load("Models/testobj");
 
-		auto& toggleModel = link->AddComponent<ToggleModel>().lock();
+		auto toggleModel = link->AddComponent<ToggleModel>();
 		toggleModel->SetModels(lodModel, tessModel);
 
 		// Add Rigidbody and collider
@@ -236,23 +574,24 @@ namespace snes
 
 		CreatePointLight(*link, glm::vec3(0.0f), glm::vec3(1.0f));
 
-		return link;
+		return *link;
 	}
 
-	GameObject& Scene::CreateFloor(std::shared_ptr<Camera> camera)
+	GameObject& Scene::CreateFloor(Camera* camera)
 	{
-		auto floor = m_root->AddChild().lock();
+		auto floor = m_root->AddChild();
+		floor->SetStatic(true);
 		floor->GetTransform().SetLocalPosition(glm::vec3(-100, -10.0f, -100));
 		floor->GetTransform().SetLocalScale(glm::vec3(100.0f, 0.5f, 100.0f));
 
-		auto& lodModel = floor->AddComponent<LODModel>().lock();
+		auto lodModel = floor->AddComponent<LODModel>();
 		lodModel->SetCamera(camera);
 		lodModel->Load("Models/floor");
 
-		auto rb = floor->AddComponent<Rigidbody>().lock();
+		auto rb = floor->AddComponent<Rigidbody>();
 		rb->LockPosition();
 
-		auto collider = floor->AddComponent<AABBCollider>().lock();
+		auto collider = floor->AddComponent<AABBCollider>();
 
 		return *floor;
 	}
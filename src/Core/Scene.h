@@ -1,11 +1,44 @@
 #pragma once
+#include "ComponentPhases.h"
+#include "FrameTime.h"
 #include "GameObject.h"
 #include <Components\Camera.h>
+#include <Components\DirectionalLight.h>
+#include <Components\PointLight.h>
 #include <Rendering\DeferredLightingManager.h>
 #include <Rendering\Material.h>
+#include <Rendering\RenderQueue.h>
+#include <Rendering\RenderSnapshot.h>
+#include <Rendering\ViewUniformBuffer.h>
+#include <atomic>
 
 namespace snes
 {
+	/** The parts of a frame Scene times separately */
+	enum ScenePhase
+	{
+		SCENE_PHASE_FIXED_LOGIC,
+		SCENE_PHASE_MAIN_LOGIC,
+		SCENE_PHASE_CAPTURE,
+		SCENE_PHASE_SHADOW_PASS,
+		SCENE_PHASE_GEOMETRY_PASS,
+		SCENE_PHASE_LIGHTING,
+		SCENE_PHASE_COUNT
+	};
+
+	/** Parameters for a procedurally generated stress scene */
+	struct StressSceneSettings
+	{
+		/** The number of LOD spheres, laid out in a square grid */
+		uint lodSpheres = 400;
+		/** The number of point lights, in a ring above the spheres */
+		uint pointLights = 8;
+		/** The number of moving, spinning objects with a Rigidbody and SphereCollider */
+		uint rigidbodies = 100;
+		/** How deep each sphere and rigidbody sits in the hierarchy (1 = child of the root) */
+		uint hierarchyDepth = 1;
+	};
+
 	/** Scene
 	  * Sets up a demo scene and handles the flow of logic between GameObjects*/
 	class Scene
@@ -14,25 +47,87 @@ namespace snes
 		Scene();
 		~Scene();
 
-		void InitialiseScene();
+		/** Create the scene's objects, loading them from a snapshot file if one is given
+		  * and falling back to the demo scene otherwise */
+		void InitialiseScene(const std::string& snapshotPath = std::string());
+
+		/** Create a procedurally generated scene for benchmarking instead of the demo scene */
+		void InitialiseStressScene(const StressSceneSettings& settings);
+
+		/** Save every object in the scene to a snapshot file
+		  * @return true if the file was written */
+		bool SaveSnapshot(const std::string& path);
 
 		void FixedLogic();
-		void MainLogic() { m_root->MainLogic(); }
-		void MainDraw();
+		void MainLogic();
+		/** Copy everything the frame draws into a snapshot: cameras, lights, and each component's draw items */
+		void CaptureRenderState(RenderSnapshot& snapshot);
+		/** Draw a snapshot: a shadow pass for each shadow cascade, geometry pass, then deferred lighting.
+		  * Only reads the snapshot and the assets it holds, so it can run while the next frame's logic does */
+		void Render(const RenderSnapshot& snapshot);
+		/** Draw a snapshot as seen from a different camera state, e.g. one turned by input that arrived after it was captured */
+		void Render(const RenderSnapshot& snapshot, const CameraState& camera);
+
+		/** @return the CPU time spent in a phase since the last ResetPhaseTimes(), in milliseconds.
+		  * Draw phases stay at 0 when there is no GL context. Safe to call while another thread is timing phases */
+		double GetPhaseTime(ScenePhase phase) const;
+		/** Zero the phase timings, e.g. at the start of each frame being measured */
+		void ResetPhaseTimes();
+		/** @return the name of a phase, as used in benchmark results */
+		static const char* GetPhaseName(ScenePhase phase);
+
+		/** @return the number of GameObjects in the scene */
+		uint GetObjectCount() const { return m_pools.GetLiveCount<GameObject>(); }
+		/** @return the number of GameObjects and components in the scene's pools */
+		uint GetPooledInstanceCount() const { return m_pools.GetLiveCount(); }
 		
 	private:
-		GameObject& CreateJiggy(glm::vec3 pos, std::shared_ptr<Camera> camera, std::shared_ptr<Material> material);
-		std::weak_ptr<GameObject> CreateLink(glm::vec3 pos, std::shared_ptr<Camera> camera);
-		GameObject& CreateSphere(glm::vec3 pos, std::shared_ptr<Camera> camera, std::weak_ptr<GameObject> lodReferenceObj);
-		GameObject& CreateFloor(std::shared_ptr<Camera> camera);
+		/** Create the camera and directional light every scene needs
+		  * @return the camera component */
+		Camera* CreateCameraAndDirectionalLight();
+		/** Create a chain of empty GameObjects under the root
+		  * @return the deepest object in the chain, or the root if depth is 0 */
+		GameObject& CreateHierarchy(uint depth);
+		/** Add the time since start to a phase's timing */
+		void AddPhaseTime(ScenePhase phase, Clock::time_point start);
+
+		/** Replace the scene's objects with those in a snapshot file
+		  * @return true if the snapshot was loaded and contains a camera and directional light */
+		bool LoadSnapshot(const std::string& path);
+		/** Find the camera, directional light and point lights among the scene's objects */
+		bool FindSceneObjects();
+
+		GameObject& CreateJiggy(glm::vec3 pos, Camera* camera, std::shared_ptr<Material> material);
+		GameObject& CreateLink(glm::vec3 pos, Camera* camera);
+		GameObject& CreateSphere(glm::vec3 pos, Camera* camera, GameObject* lodReferenceObj, GameObject* parent = nullptr);
+		GameObject& CreateMovingBody(glm::vec3 pos, glm::vec3 velocity, GameObject* parent = nullptr);
+		GameObject& CreateFloor(Camera* camera);
 		GameObject& CreatePointLight(GameObject& parent, glm::vec3 pos, glm::vec3 colour);
 
-		std::shared_ptr<GameObject> m_root;
-		std::shared_ptr<GameObject> m_camera;
-		std::shared_ptr<GameObject> m_directionalLight;
+		/** Owns every GameObject and component in the scene */
+		ObjectPools m_pools;
+		/** Components registered for each update phase */
+		ComponentPhases m_phases;
 
-		std::vector<std::weak_ptr<PointLight>> m_pointLights;
+		GameObject* m_root;
+		GameObject* m_camera = nullptr;
+		GameObject* m_directionalLight = nullptr;
+
+		std::vector<Handle<PointLight>> m_pointLights;
 
 		DeferredLightingManager m_deferredLightingMgr;
+		/** Sorts each pass's draws. Only used by the renderer, and reused so its storage lasts between frames */
+		RenderQueue m_renderQueue;
+		/** The camera of each shadow cascade and the geometry pass, written once per frame for every shader to read */
+		ViewUniformBuffer m_viewUniforms;
+
+		/** The number of frames captured into render snapshots */
+		uint64 m_capturedFrames = 0;
+		/** Seconds of simulation run so far, passed to shaders as the time */
+		double m_elapsedTime = 0.0;
+
+		/** CPU time spent in each phase since the last ResetPhaseTimes(), in nanoseconds.
+		  * Atomic, as logic and draw phases may be timed on different threads */
+		std::atomic<int64> m_phaseTimes[SCENE_PHASE_COUNT] = {};
 	};
 }
\ No newline at end of file
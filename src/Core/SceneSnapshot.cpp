@@ -0,0 +1,430 @@
+#include "stdafx.h"
+#include "SceneSnapshot.h"
+#include <Components\AABBCollider.h>
+#include <Components\Camera.h>
+#include <Components\CharController.h>
+#include <Components\ControllableCamera.h>
+#include <Components\DirectionalLight.h>
+#include <Components\LODModel.h>
+#include <Components\MeshRenderer.h>
+#include <Components\PointLight.h>
+#include <Components\Rigidbody.h>
+#include <Components\SphereCollider.h>
+#include <Components\TessModel.h>
+#include <Components\TestComponent.h>
+#include <Components\ToggleModel.h>
+#include <Rendering\Mesh.h>
+#include <fstream>
+#include <iterator>
+
+namespace snes
+{
+	namespace
+	{
+		/** Calls visitor.Visit<T>() with the component class matching a snapshot type
+		  * @return false if the type is unknown */
+		template <typename Visitor>
+		bool VisitComponentType(SnapshotComponentType type, Visitor& visitor)
+		{
+			switch (type)
+			{
+			case SNAPSHOT_CAMERA:				visitor.template Visit<Camera>();				return true;
+			case SNAPSHOT_CONTROLLABLE_CAMERA:	visitor.template Visit<ControllableCamera>();	return true;
+			case SNAPSHOT_DIRECTIONAL_LIGHT:	visitor.template Visit<DirectionalLight>();		return true;
+			case SNAPSHOT_POINT_LIGHT:			visitor.template Visit<PointLight>();			return true;
+			case SNAPSHOT_LOD_MODEL:			visitor.template Visit<LODModel>();				return true;
+			case SNAPSHOT_TESS_MODEL:			visitor.template Visit<TessModel>();			return true;
+			case SNAPSHOT_TOGGLE_MODEL:			visitor.template Visit<ToggleModel>();			return true;
+			case SNAPSHOT_MESH_RENDERER:		visitor.template Visit<MeshRenderer>();			return true;
+			case SNAPSHOT_RIGIDBODY:			visitor.template Visit<Rigidbody>();			return true;
+			case SNAPSHOT_AABB_COLLIDER:		visitor.template Visit<AABBCollider>();			return true;
+			case SNAPSHOT_SPHERE_COLLIDER:		visitor.template Visit<SphereCollider>();		return true;
+			case SNAPSHOT_CHAR_CONTROLLER:		visitor.template Visit<CharController>();		return true;
+			case SNAPSHOT_TEST_COMPONENT:		visitor.template Visit<TestComponent>();		return true;
+			default:							return false;
+			}
+		}
+
+		/** Adds a component of the visited type to a GameObject */
+		struct ComponentCreator
+		{
+			GameObject& object;
+			Component* created;
+
+			template <typename T>
+			void Visit() { created = object.AddComponent<T>(); }
+		};
+
+		/** Grows the pool of the visited type so it can hold count more components */
+		struct PoolReserver
+		{
+			ObjectPools& pools;
+			uint count;
+
+			template <typename T>
+			void Visit()
+			{
+				ObjectPool<T, Component>& pool = pools.Get<T, Component>();
+				pool.Reserve(pool.GetLiveCount() + count);
+			}
+		};
+
+		/** Collect every descendant of parent, parents before children, along with the index of each one's parent */
+		void GatherObjects(GameObject& parent, int32 parentIndex, std::vector<GameObject*>& outObjects, std::vector<int32>& outParents)
+		{
+			for (GameObject* child : parent.GetChildren())
+			{
+				int32 index = (int32)outObjects.size();
+				outObjects.push_back(child);
+				outParents.push_back(parentIndex);
+				GatherObjects(*child, index, outObjects, outParents);
+			}
+		}
+	}
+
+	constexpr uint32 SceneSnapshot::MAGIC;
+	constexpr uint32 SceneSnapshot::VERSION;
+
+	void SnapshotWriter::WriteString(const std::string& value)
+	{
+		Write<uint32>((uint32)value.size());
+		m_buffer.insert(m_buffer.end(), value.begin(), value.end());
+	}
+
+	void SnapshotWriter::WriteAsset(SnapshotAssetType type, const std::string& path)
+	{
+		auto key = std::make_pair((uint8)type, path);
+		auto it = m_assetIndices.find(key);
+		if (it == m_assetIndices.end())
+		{
+			it = m_assetIndices.emplace(key, (uint32)m_assets.size()).first;
+			m_assets.push_back(Asset{ type, path });
+		}
+		Write<uint32>(it->second);
+	}
+
+	void SnapshotWriter::WriteComponentRef(const Component* component)
+	{
+		// Indices are offset by one so that 0 can mean null
+		auto it = m_componentIndices.find(component);
+		Write<uint32>(it != m_componentIndices.end() ? it->second + 1 : 0);
+	}
+
+	void SnapshotWriter::WriteObjectRef(const GameObject* object)
+	{
+		auto it = m_objectIndices.find(object);
+		Write<uint32>(it != m_objectIndices.end() ? it->second + 1 : 0);
+	}
+
+	std::string SnapshotReader::ReadString()
+	{
+		uint32 length = Read<uint32>();
+		if (m_position + length > m_end)
+		{
+			m_failed = true;
+			return std::string();
+		}
+		std::string value(m_position, length);
+		m_position += length;
+		return value;
+	}
+
+	const std::string& SnapshotReader::ReadAsset()
+	{
+		static const std::string noAsset;
+		uint32 index = Read<uint32>();
+		return (m_assets && index < m_assets->size()) ? (*m_assets)[index] : noAsset;
+	}
+
+	Component* SnapshotReader::ReadComponent()
+	{
+		uint32 index = Read<uint32>();
+		return (m_components && index > 0 && index <= m_components->size()) ? (*m_components)[index - 1] : nullptr;
+	}
+
+	GameObject* SnapshotReader::ReadObjectRef()
+	{
+		uint32 index = Read<uint32>();
+		return (m_objects && index > 0 && index <= m_objects->size()) ? (*m_objects)[index - 1] : nullptr;
+	}
+
+	bool SceneSnapshot::Save(const std::string& path, GameObject& root)
+	{
+		std::vector<GameObject*> objects;
+		std::vector<int32> parents;
+		GatherObjects(root, -1, objects, parents);
+
+		SnapshotWriter writer;
+		for (uint i = 0; i < objects.size(); i++)
+		{
+			writer.m_objectIndices[objects[i]] = i;
+		}
+
+		// Number every saveable component before writing any data, so references can point forwards
+		std::vector<Component*> components;
+		std::vector<SnapshotComponentType> componentTypes;
+		std::vector<uint16> componentCounts(objects.size(), 0);
+		for (uint i = 0; i < objects.size(); i++)
+		{
+			for (Component* component : objects[i]->GetComponents())
+			{
+				SnapshotComponentType type = GetComponentType(*component);
+				if (type == SNAPSHOT_UNKNOWN)
+				{
+					std::cout << "Warning: Skipping component of unknown type when saving scene snapshot" << std::endl;
+					continue;
+				}
+				writer.m_componentIndices[component] = components.size();
+				components.push_back(component);
+				componentTypes.push_back(type);
+				componentCounts[i]++;
+			}
+		}
+
+		// Component data, each block prefixed with its length
+		for (Component* component : components)
+		{
+			uint lengthPosition = writer.m_buffer.size();
+			writer.Write<uint32>(0);
+			component->SaveSnapshot(writer);
+			uint32 length = (uint32)(writer.m_buffer.size() - lengthPosition - sizeof(uint32));
+			std::memcpy(&writer.m_buffer[lengthPosition], &length, sizeof(uint32));
+		}
+
+		// Header, asset table and object table go in front of the component data
+		SnapshotWriter header;
+		header.Write<uint32>(MAGIC);
+		header.Write<uint32>(VERSION);
+
+		header.Write<uint32>((uint32)writer.m_assets.size());
+		for (const auto& asset : writer.m_assets)
+		{
+			header.Write<uint8>(asset.type);
+			header.WriteString(asset.path);
+		}
+
+		header.Write<uint32>((uint32)objects.size());
+		uint componentIndex = 0;
+		for (uint i = 0; i < objects.size(); i++)
+		{
+			Transform& transform = objects[i]->GetTransform();
+			header.Write<int32>(parents[i]);
+			header.Write<glm::vec3>(transform.GetLocalPosition());
+			header.Write<glm::vec3>(transform.GetLocalRotation());
+			header.Write<glm::vec3>(transform.GetLocalScale());
+			header.Write<uint8>(objects[i]->IsStatic() ? 1 : 0);
+			header.Write<uint16>(componentCounts[i]);
+			for (uint j = 0; j < componentCounts[i]; j++, componentIndex++)
+			{
+				header.Write<uint16>(componentTypes[componentIndex]);
+				header.Write<uint8>(components[componentIndex]->IsEnabled() ? 1 : 0);
+			}
+		}
+
+		std::ofstream file(path, std::ios::out | std::ios::binary);
+		if (!file)
+		{
+			std::cout << "Error opening scene snapshot for writing: " << path << std::endl;
+			return false;
+		}
+		file.write(header.m_buffer.data(), header.m_buffer.size());
+		file.write(writer.m_buffer.data(), writer.m_buffer.size());
+
+		std::cout << "Saved scene snapshot " << path << ": " << objects.size() << " objects, "
+			<< components.size() << " components, " << writer.m_assets.size() << " assets" << std::endl;
+		return true;
+	}
+
+	bool SceneSnapshot::Load(const std::string& path, GameObject& root, ObjectPools& pools)
+	{
+		std::ifstream file(path, std::ios::in | std::ios::binary);
+		if (!file)
+		{
+			std::cout << "Error opening scene snapshot: " << path << std::endl;
+			return false;
+		}
+		std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		SnapshotReader reader;
+		reader.m_position = data.data();
+		reader.m_end = data.data() + data.size();
+
+		if (reader.Read<uint32>() != MAGIC || reader.Read<uint32>() != VERSION)
+		{
+			std::cout << "Error: " << path << " is not a supported scene snapshot" << std::endl;
+			return false;
+		}
+
+		/** Asset table */
+
+		uint32 assetCount = reader.Read<uint32>();
+		std::vector<std::string> assets;
+		std::vector<SnapshotAssetType> assetTypes;
+		for (uint i = 0; i < assetCount && !reader.HasFailed(); i++)
+		{
+			assetTypes.push_back((SnapshotAssetType)reader.Read<uint8>());
+			assets.push_back(reader.ReadString());
+		}
+
+		/** Object table */
+
+		struct ObjectEntry
+		{
+			int32 parent;
+			glm::vec3 position;
+			glm::vec3 rotation;
+			glm::vec3 scale;
+			uint8 isStatic;
+			uint16 componentCount;
+		};
+
+		uint32 objectCount = reader.Read<uint32>();
+		std::vector<ObjectEntry> entries;
+		std::vector<SnapshotComponentType> componentTypes;
+		std::vector<uint8> componentEnabled;
+		std::map<SnapshotComponentType, uint> typeCounts;
+		for (uint i = 0; i < objectCount && !reader.HasFailed(); i++)
+		{
+			ObjectEntry entry;
+			entry.parent = reader.Read<int32>();
+			entry.position = reader.Read<glm::vec3>();
+			entry.rotation = reader.Read<glm::vec3>();
+			entry.scale = reader.Read<glm::vec3>();
+			entry.isStatic = reader.Read<uint8>();
+			entry.componentCount = reader.Read<uint16>();
+
+			if (entry.parent >= (int32)i)
+			{
+				std::cout << "Error: Scene snapshot " << path << " lists an object before its parent" << std::endl;
+				return false;
+			}
+
+			for (uint j = 0; j < entry.componentCount; j++)
+			{
+				SnapshotComponentType type = (SnapshotComponentType)reader.Read<uint16>();
+				componentTypes.push_back(type);
+				componentEnabled.push_back(reader.Read<uint8>());
+				typeCounts[type]++;
+			}
+			entries.push_back(entry);
+		}
+
+		if (reader.HasFailed())
+		{
+			std::cout << "Error: Scene snapshot " << path << " is truncated" << std::endl;
+			return false;
+		}
+
+		/** Reserve pool space for everything up front */
+
+		ObjectPool<GameObject>& objectPool = pools.Get<GameObject>();
+		objectPool.Reserve(objectPool.GetLiveCount() + objectCount);
+		for (const auto& typeCount : typeCounts)
+		{
+			PoolReserver reserver{ pools, typeCount.second };
+			VisitComponentType(typeCount.first, reserver);
+		}
+
+		/** Load every referenced mesh in one batch, so components find them already cached */
+
+		for (uint i = 0; i < assets.size(); i++)
+		{
+			if (assetTypes[i] == SNAPSHOT_ASSET_MESH)
+			{
+				Mesh::GetMesh(assets[i].c_str());
+			}
+			else if (assetTypes[i] == SNAPSHOT_ASSET_MESH_WITH_NEIGHBOURS)
+			{
+				Mesh::GetMesh(assets[i].c_str(), true);
+			}
+		}
+
+		/** Create the hierarchy */
+
+		std::vector<GameObject*> objects;
+		std::vector<Component*> components;
+		objects.reserve(objectCount);
+		components.reserve(componentTypes.size());
+		for (const ObjectEntry& entry : entries)
+		{
+			GameObject* parent = entry.parent < 0 ? &root : objects[entry.parent];
+			GameObject* object = parent->AddChild();
+			object->GetTransform().SetLocalPosition(entry.position);
+			object->GetTransform().SetLocalRotation(entry.rotation);
+			object->GetTransform().SetLocalScale(entry.scale);
+			object->SetStatic(entry.isStatic != 0);
+			objects.push_back(object);
+
+			for (uint j = 0; j < entry.componentCount; j++)
+			{
+				ComponentCreator creator{ *object, nullptr };
+				if (!VisitComponentType(componentTypes[components.size()], creator))
+				{
+					std::cout << "Warning: Skipping component of unknown type " << componentTypes[components.size()] << " in scene snapshot" << std::endl;
+				}
+				// Unknown components keep a null entry so indices still line up with the file
+				components.push_back(creator.created);
+			}
+		}
+
+		/** Component data */
+
+		reader.m_assets = &assets;
+		reader.m_components = &components;
+		reader.m_objects = &objects;
+		for (uint i = 0; i < components.size(); i++)
+		{
+			uint32 length = reader.Read<uint32>();
+			if (reader.HasFailed() || reader.m_position + length > reader.m_end)
+			{
+				std::cout << "Error: Scene snapshot " << path << " is truncated" << std::endl;
+				return false;
+			}
+
+			const char* dataEnd = reader.m_position + length;
+			if (components[i])
+			{
+				SnapshotReader componentReader = reader;
+				componentReader.m_end = dataEnd;
+				components[i]->LoadSnapshot(componentReader);
+				if (componentReader.HasFailed())
+				{
+					std::cout << "Warning: Component data for type " << componentTypes[i] << " in scene snapshot is shorter than expected" << std::endl;
+				}
+
+				if (componentEnabled[i])
+				{
+					components[i]->Enable();
+				}
+				else
+				{
+					components[i]->Disable();
+				}
+			}
+			reader.m_position = dataEnd;
+		}
+
+		std::cout << "Loaded scene snapshot " << path << ": " << objects.size() << " objects, "
+			<< components.size() << " components, " << assets.size() << " assets" << std::endl;
+		return true;
+	}
+
+	SnapshotComponentType SceneSnapshot::GetComponentType(Component& component)
+	{
+		// Derived types must be checked before their base types
+		if (dynamic_cast<ControllableCamera*>(&component))	return SNAPSHOT_CONTROLLABLE_CAMERA;
+		if (dynamic_cast<Camera*>(&component))				return SNAPSHOT_CAMERA;
+		if (dynamic_cast<DirectionalLight*>(&component))	return SNAPSHOT_DIRECTIONAL_LIGHT;
+		if (dynamic_cast<PointLight*>(&component))			return SNAPSHOT_POINT_LIGHT;
+		if (dynamic_cast<LODModel*>(&component))			return SNAPSHOT_LOD_MODEL;
+		if (dynamic_cast<TessModel*>(&component))			return SNAPSHOT_TESS_MODEL;
+		if (dynamic_cast<ToggleModel*>(&component))			return SNAPSHOT_TOGGLE_MODEL;
+		if (dynamic_cast<MeshRenderer*>(&component))		return SNAPSHOT_MESH_RENDERER;
+		if (dynamic_cast<Rigidbody*>(&component))			return SNAPSHOT_RIGIDBODY;
+		if (dynamic_cast<AABBCollider*>(&component))		return SNAPSHOT_AABB_COLLIDER;
+		if (dynamic_cast<SphereCollider*>(&component))		return SNAPSHOT_SPHERE_COLLIDER;
+		if (dynamic_cast<CharController*>(&component))		return SNAPSHOT_CHAR_CONTROLLER;
+		if (dynamic_cast<TestComponent*>(&component))		return SNAPSHOT_TEST_COMPONENT;
+		return SNAPSHOT_UNKNOWN;
+	}
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "GameObject.h"
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+namespace snes
+{
+	/** The component types a scene snapshot can store.
+	  * These values are written to disk, so only ever append to this list. */
+	enum SnapshotComponentType : uint16
+	{
+		SNAPSHOT_UNKNOWN = 0,
+		SNAPSHOT_CAMERA,
+		SNAPSHOT_CONTROLLABLE_CAMERA,
+		SNAPSHOT_DIRECTIONAL_LIGHT,
+		SNAPSHOT_POINT_LIGHT,
+		SNAPSHOT_LOD_MODEL,
+		SNAPSHOT_TESS_MODEL,
+		SNAPSHOT_TOGGLE_MODEL,
+		SNAPSHOT_MESH_RENDERER,
+		SNAPSHOT_RIGIDBODY,
+		SNAPSHOT_AABB_COLLIDER,
+		SNAPSHOT_SPHERE_COLLIDER,
+		SNAPSHOT_CHAR_CONTROLLER,
+		SNAPSHOT_TEST_COMPONENT
+	};
+
+	/** The kinds of asset a snapshot can reference, so the loader knows how to preload them */
+	enum SnapshotAssetType : uint8
+	{
+		SNAPSHOT_ASSET_MESH,
+		SNAPSHOT_ASSET_MESH_WITH_NEIGHBOURS,
+		SNAPSHOT_ASSET_MATERIAL
+	};
+
+	/** Snapshot Writer
+	  * Passed to Component::SaveSnapshot() to write a component's parameters.
+	  * Asset paths and references to other objects are stored as indices into the snapshot's tables. */
+	class SnapshotWriter
+	{
+	public:
+		/** Write a plain data value (numbers, bools, glm vectors) */
+		template <typename T>
+		void Write(const T& value)
+		{
+			const char* bytes = reinterpret_cast<const char*>(&value);
+			m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		/** Write a length-prefixed string */
+		void WriteString(const std::string& value);
+		/** Write a reference to an asset file, adding it to the snapshot's asset table */
+		void WriteAsset(SnapshotAssetType type, const std::string& path);
+		/** Write a reference to another component in the snapshot (or nullptr) */
+		void WriteComponentRef(const Component* component);
+		/** Write a reference to a GameObject in the snapshot (or nullptr) */
+		void WriteObjectRef(const GameObject* object);
+
+	private:
+		friend class SceneSnapshot;
+
+		struct Asset
+		{
+			SnapshotAssetType type;
+			std::string path;
+		};
+
+		std::vector<char> m_buffer;
+		std::vector<Asset> m_assets;
+		std::map<std::pair<uint8, std::string>, uint32> m_assetIndices;
+		std::unordered_map<const Component*, uint32> m_componentIndices;
+		std::unordered_map<const GameObject*, uint32> m_objectIndices;
+	};
+
+	/** Snapshot Reader
+	  * Passed to Component::LoadSnapshot() to read back the values written by SaveSnapshot(), in the same order.
+	  * Reading past the end of a component's data returns default values and marks the reader as failed. */
+	class SnapshotReader
+	{
+	public:
+		/** Read a plain data value */
+		template <typename T>
+		T Read()
+		{
+			T value = T();
+			if (m_position + sizeof(T) > m_end)
+			{
+				m_failed = true;
+				return value;
+			}
+			std::memcpy(&value, m_position, sizeof(T));
+			m_position += sizeof(T);
+			return value;
+		}
+
+		/** Read a length-prefixed string */
+		std::string ReadString();
+		/** Read an asset reference
+		  * @return the asset's path, or an empty string if the reference is invalid */
+		const std::string& ReadAsset();
+		/** Read a component reference
+		  * @return the component, or nullptr if the reference was null or isn't of type T */
+		template <typename T>
+		T* ReadComponentRef() { return dynamic_cast<T*>(ReadComponent()); }
+		/** Read a GameObject reference
+		  * @return the GameObject, or nullptr if the reference was null */
+		GameObject* ReadObjectRef();
+
+		/** @return true if any read went past the end of the data */
+		bool HasFailed() const { return m_failed; }
+
+	private:
+		friend class SceneSnapshot;
+
+		Component* ReadComponent();
+
+		const char* m_position = nullptr;
+		const char* m_end = nullptr;
+		bool m_failed = false;
+
+		const std::vector<std::string>* m_assets = nullptr;
+		const std::vector<Component*>* m_components = nullptr;
+		const std::vector<GameObject*>* m_objects = nullptr;
+	};
+
+	/** Scene Snapshot
+	  * Binary scene format storing a GameObject hierarchy, transforms, component parameters and asset references.
+	  *
+	  * Layout (little-endian):
+	  *   header:     magic "SNSS", uint32 version
+	  *   assets:     uint32 count, then per asset: uint8 type, string path
+	  *   objects:    uint32 count, then per object (parents before children):
+	  *               int32 parent index (-1 for the root), vec3 local position/rotation/scale, uint8 static,
+	  *               uint16 component count, then per component: uint16 type, uint8 enabled
+	  *   components: per component in object order: uint32 data length, data
+	  *
+	  * Loading reserves every pool up front, preloads all referenced meshes in one batch,
+	  * creates the whole hierarchy and only then reads component data, so references can point anywhere in the file. */
+	class SceneSnapshot
+	{
+	public:
+		/** Save every descendant of root (but not root itself) to a snapshot file
+		  * @return true if the file was written */
+		static bool Save(const std::string& path, GameObject& root);
+
+		/** Load a snapshot file, creating its objects as descendants of root
+		  * @return true if the file was loaded */
+		static bool Load(const std::string& path, GameObject& root, ObjectPools& pools);
+
+	private:
+		static constexpr uint32 MAGIC = 0x53534E53; // "SNSS"
+		static constexpr uint32 VERSION = 2;
+
+		/** @return the snapshot type of a component, or SNAPSHOT_UNKNOWN if it can't be saved */
+		static SnapshotComponentType GetComponentType(Component& component);
+	};
+}
@@ -0,0 +1,87 @@
+#include "stdafx.h"
+#include "SystemScheduler.h"
+#include "FrameTime.h"
+#include <climits>
+
+namespace snes
+{
+	std::vector<SystemScheduler::System> SystemScheduler::m_systems;
+	uint64 SystemScheduler::m_step = 0;
+
+	SystemScheduler::SystemId SystemScheduler::Register(uint tickRate, int offset)
+	{
+		SystemId id = m_systems.size();
+		m_systems.push_back(System{ EVERY_STEP, 0, true });
+		SetTickRate(id, tickRate, offset);
+		return id;
+	}
+
+	void SystemScheduler::SetTickRate(SystemId system, uint tickRate, int offset)
+	{
+		uint interval = GetInterval(tickRate);
+		System& entry = m_systems[system];
+		entry.tickRate = tickRate;
+		entry.offset = offset == AUTO_OFFSET ? PickOffset(system, interval) : (uint)offset % interval;
+		entry.due = m_step % interval == entry.offset;
+	}
+
+	void SystemScheduler::Advance()
+	{
+		++m_step;
+		for (System& system : m_systems)
+		{
+			// The offset is taken modulo the interval again in case the fixed logic rate changed since it was picked
+			uint interval = GetInterval(system.tickRate);
+			system.due = m_step % interval == system.offset % interval;
+		}
+	}
+
+	uint SystemScheduler::GetInterval(uint tickRate)
+	{
+		if (tickRate == EVERY_STEP)
+		{
+			return 1;
+		}
+		uint fixedRate = FrameTime::GetFixedLogicRate();
+		return std::max((fixedRate + tickRate / 2) / tickRate, 1u);
+	}
+
+	uint SystemScheduler::PickOffset(SystemId system, uint interval)
+	{
+		uint bestOffset = 0;
+		uint bestOverlaps = UINT_MAX;
+		for (uint offset = 0; offset < interval; ++offset)
+		{
+			// Two systems share a step whenever their offsets match modulo the gcd of their intervals
+			uint overlaps = 0;
+			for (SystemId other = 0; other < m_systems.size(); ++other)
+			{
+				uint otherInterval = GetInterval(m_systems[other].tickRate);
+				if (other == system || otherInterval == 1)
+				{
+					continue;
+				}
+
+				uint a = interval;
+				uint b = otherInterval;
+				while (b != 0)
+				{
+					uint r = a % b;
+					a = b;
+					b = r;
+				}
+				if (offset % a == m_systems[other].offset % a)
+				{
+					++overlaps;
+				}
+			}
+
+			if (overlaps < bestOverlaps)
+			{
+				bestOverlaps = overlaps;
+				bestOffset = offset;
+			}
+		}
+		return bestOffset;
+	}
+}
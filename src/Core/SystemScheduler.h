@@ -0,0 +1,66 @@
+#pragma once
+
+namespace snes
+{
+	/** System Scheduler
+	  * Decides which systems run on each fixed logic step. A system (e.g. every component of one type)
+	  * ticks at its own rate, expressed as every Nth fixed step plus a phase offset within those N steps.
+	  * Systems registered without an explicit offset are staggered onto the steps shared by the fewest other
+	  * low-rate systems, so expensive infrequent work is spread across frames instead of spiking the same one. */
+	class SystemScheduler
+	{
+	public:
+		typedef uint SystemId;
+
+		/** Tick rate meaning "run on every fixed step" */
+		static constexpr uint EVERY_STEP = 0;
+		/** Phase offset meaning "pick the least busy offset" */
+		static constexpr int AUTO_OFFSET = -1;
+
+		/** Register a system
+		  * @param tickRate: the number of times per second it runs, or EVERY_STEP
+		  * @param offset: the fixed step (modulo its interval) it runs on, or AUTO_OFFSET
+		  * @return the id to check the system with */
+		static SystemId Register(uint tickRate, int offset = AUTO_OFFSET);
+
+		/** @return the system that runs FixedLogic() on components of type T, registered at T::FIXED_LOGIC_RATE
+		  * the first time it's asked for */
+		template <typename T>
+		static SystemId GetSystem()
+		{
+			static const SystemId id = Register(T::FIXED_LOGIC_RATE);
+			return id;
+		}
+
+		/** Change how often a system runs. Rates above the fixed logic rate run on every step */
+		static void SetTickRate(SystemId system, uint tickRate, int offset = AUTO_OFFSET);
+		/** @return the number of times per second a system runs, or EVERY_STEP */
+		static uint GetTickRate(SystemId system) { return m_systems[system].tickRate; }
+
+		/** Move on to the next fixed step, working out which systems are due on it.
+		  * Called once at the start of every fixed logic loop */
+		static void Advance();
+
+		/** @return true if the system runs on the current fixed step */
+		static bool IsDue(SystemId system) { return m_systems[system].due; }
+
+		/** @return the number of fixed steps run since startup */
+		static uint64 GetStep() { return m_step; }
+
+	private:
+		struct System
+		{
+			uint tickRate;
+			uint offset;
+			bool due;
+		};
+
+		/** @return the number of fixed steps between each run of a system at the current fixed logic rate */
+		static uint GetInterval(uint tickRate);
+		/** @return the offset that shares its steps with the fewest other systems */
+		static uint PickOffset(SystemId system, uint interval);
+
+		static std::vector<System> m_systems;
+		static uint64 m_step;
+	};
+}
@@ -1,8 +1,37 @@
 #include "stdafx.h"
 #include "Application.h"
+#include <Benchmarks\MicroBenchmark.h>
+#include <Benchmarks\SpawnBenchmark.h>
 
 int main(int argc, char* argv[])
 {
+	// Benchmarks that don't need a window run before the Application is created
+	if (argc > 1 && std::string(argv[1]) == "--spawn-benchmark")
+	{
+		snes::SpawnBenchmark::Run();
+		return 0;
+	}
+	// --micro-benchmark [filter] [--output <file>]. Build the MicroBenchmark configuration to count allocations too
+	if (argc > 1 && std::string(argv[1]) == "--micro-benchmark")
+	{
+		std::string filter;
+		std::string outputPath;
+		for (int i = 2; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			if (arg == "--output" && i + 1 < argc)
+			{
+				outputPath = argv[++i];
+			}
+			else
+			{
+				filter = arg;
+			}
+		}
+		snes::MicroBenchmark::Run(filter, outputPath);
+		return 0;
+	}
+
     snes::Application app(argc, argv);
 	app.Run();
 }
\ No newline at end of file
@@ -1,17 +1,34 @@
 #include "stdafx.h"
 #include "DeferredLightingManager.h"
+#include "GLState.h"
+#include "GraphicsDevice.h"
 #include <Core\Application.h>
+#include <Core\Profiler.h>
 #include <Components\Transform.h>
 #include <algorithm>
+#include <cstring>
 
 namespace snes
 {
-	const glm::mat4 DeferredLightingManager::BIAS_MATRIX(
-		0.5, 0.0, 0.0, 0.0,
-		0.0, 0.5, 0.0, 0.0,
-		0.0, 0.0, 0.5, 0.0,
-		0.5, 0.5, 0.5, 1.0
-	);
+	namespace
+	{
+		/** One point light as the lighting shader reads it from its PointLights block, laid out by std430 rules */
+		struct PointLightData
+		{
+			glm::vec3 position;
+			float linearAttenuation;
+			glm::vec3 colour;
+			float quadraticAttenuation;
+		};
+		static_assert(sizeof(PointLightData) == 32, "PointLightData must match the std430 layout of the PointLight struct");
+
+		/** The light count at the start of the block, padded to the 16-byte alignment of the light array after it */
+		const GLsizeiptr POINT_LIGHT_HEADER_SIZE = 16;
+	}
+
+	constexpr GLuint DeferredLightingManager::POINT_LIGHT_BINDING;
+	constexpr float DeferredLightingManager::SHADOW_SLOPE_OFFSET;
+	constexpr float DeferredLightingManager::SHADOW_CONSTANT_OFFSET;
 
 	DeferredLightingManager::DeferredLightingManager()
 	{
@@ -23,164 +40,286 @@ namespace snes
 
 	void DeferredLightingManager::Init()
 	{
+		if (!GraphicsDevice::IsAvailable())
+		{
+			return;
+		}
+
 		m_shader.Load(DEFERRED_LIGHTING_PASS);
-		m_shader.SetGlUniformSampler2D("gPosition", 0);
+		m_shader.SetGlUniformSampler2D("gDepth", 0);
 		m_shader.SetGlUniformSampler2D("gNormal", 1);
-		m_shader.SetGlUniformSampler2D("gAlbedoSpec", 2);
-		m_shader.SetGlUniformSampler2D("gEmissive", 3);
-		m_shader.SetGlUniformSampler2D("gShadowMap", 4);
+		m_shader.SetGlUniformSampler2D("gSurface", 2);
+		m_shader.SetGlUniformSampler2D("gShadowMap", 3);
+		m_cascadeAtlasMatsSlot = m_shader.FindUniformSlot("cascadeAtlasMats");
+		m_cascadeSplitsSlot = m_shader.FindUniformSlot("cascadeSplits");
+		m_cascadeDepthBiasesSlot = m_shader.FindUniformSlot("cascadeDepthBiases");
 
-		uint screenWidth, screenHeight;
-		Application::GetScreenSize(screenWidth, screenHeight);
+		glGenBuffers(1, &m_pointLightBuffer);
 
 		glGenFramebuffers(1, &m_buffer);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_buffer);
+		glGenTextures(1, &m_depth);
+		glGenTextures(1, &m_normal);
+		glGenTextures(1, &m_surface);
+		for (GLuint texture : { m_depth, m_normal, m_surface })
+		{
+			GLState::BindTexture(0, texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		}
 
-		// Set up position buffer
-		glGenTextures(1, &m_position);
-		glBindTexture(GL_TEXTURE_2D, m_position);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, screenWidth, screenHeight, 0, GL_RGB, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_position, 0);
+		// Depth is a texture so the lighting pass can reconstruct positions from it.
+		// Normals are octahedral-encoded and in view space. Surface RGB = albedo, A = specular, or RGB = emissive colour, A = 1
+		GLState::BindFramebuffer(m_buffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_normal, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_surface, 0);
 
-		// Set up normal buffer
-		glGenTextures(1, &m_normal);
-		glBindTexture(GL_TEXTURE_2D, m_normal);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, screenWidth, screenHeight, 0, GL_RGB, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normal, 0);
+		GLuint attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+		glDrawBuffers(2, attachments);
 
-		// Set up albedo/specular buffer (RGB = albedo, A = specular)
-		glGenTextures(1, &m_albedoSpecular);
-		glBindTexture(GL_TEXTURE_2D, m_albedoSpecular);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, screenWidth, screenHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, m_albedoSpecular, 0);
+		if (DynamicResolution::IsEnabled())
+		{
+			glGenFramebuffers(1, &m_sceneBuffer);
+			glGenRenderbuffers(1, &m_sceneColour);
+			GLState::BindFramebuffer(m_sceneBuffer);
+			glBindRenderbuffer(GL_RENDERBUFFER, m_sceneColour);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_sceneColour);
+		}
+		GLState::BindFramebuffer(0);
+
+		uint screenWidth, screenHeight;
+		Application::GetScreenSize(screenWidth, screenHeight);
+		AllocateTargets(screenWidth, screenHeight);
+
+		/* ############################################## */
+
+		// Set up shadow pass buffers, rendering into atlases of every cascade's shadow map
+		CreateShadowAtlas(m_shadowFBO, m_shadowTexture);
+		CreateShadowAtlas(m_staticShadowFBO, m_staticShadowTexture);
+	}
 
-		// Set up render flags buffer (bit 0 = "UseLighting")
-		glGenTextures(1, &m_emissive);
-		glBindTexture(GL_TEXTURE_2D, m_emissive);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, screenWidth, screenHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	void DeferredLightingManager::CreateShadowAtlas(GLuint& framebuffer, GLuint& texture)
+	{
+		glGenFramebuffers(1, &framebuffer);
+		GLState::BindFramebuffer(framebuffer);
+
+		glGenTextures(1, &texture);
+		GLState::BindTexture(0, texture);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, m_emissive, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, ShadowCascades::ATLAS_RESOLUTION, ShadowCascades::ATLAS_RESOLUTION, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
 
-		GLuint attachments[4] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
-		glDrawBuffers(4, attachments);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
 
-		// Set up depth buffer
-		glGenRenderbuffers(1, &m_depth);
-		glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
-		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, screenWidth, screenHeight);
-		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depth);
+		// The shadow pass only writes depth. Draw and read buffers belong to the framebuffer, so this only needs setting once
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
 
 		// Check that the framebuffer is complete
 		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 		{
-			std::cout << "Error: Framebuffer Incomplete" << std::endl;
+			std::cout << "Error: Shadow Buffer Incomplete" << std::endl;
 		}
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-		/* ############################################## */
+		GLState::BindFramebuffer(0);
+	}
 
-		// Set up shadow pass buffer
-		glGenFramebuffers(1, &m_shadowFBO);
-		glGenRenderbuffers(1, &m_shadowRT);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_shadowFBO);
-		glBindRenderbuffer(GL_RENDERBUFFER, m_shadowRT);
-		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 1024, 1024);
-		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_shadowRT);
-
-		// Set up depth texture
-		glGenTextures(1, &m_shadowTexture);
-		glBindTexture(GL_TEXTURE_2D, m_shadowTexture);
-		glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_FALSE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, 2048, 2048, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+	void DeferredLightingManager::AllocateTargets(uint width, uint height)
+	{
+		// A minimised window can report a size of 0
+		m_targetWidth = std::max(width, 1u);
+		m_targetHeight = std::max(height, 1u);
 
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_shadowTexture, 0);
+		// Respecifying the images keeps them attached to the framebuffers
+		GLState::BindTexture(0, m_depth);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, m_targetWidth, m_targetHeight, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+		GLState::BindTexture(0, m_normal);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, m_targetWidth, m_targetHeight, 0, GL_RG, GL_FLOAT, NULL);
+		GLState::BindTexture(0, m_surface);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_targetWidth, m_targetHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 
 		// Check that the framebuffer is complete
+		GLState::BindFramebuffer(m_buffer);
 		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 		{
-			std::cout << "Error: Shadow Buffer Incomplete" << std::endl;
+			std::cout << "Error: Framebuffer Incomplete" << std::endl;
 		}
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		if (m_sceneBuffer != 0)
+		{
+			glBindRenderbuffer(GL_RENDERBUFFER, m_sceneColour);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_targetWidth, m_targetHeight);
+			GLState::BindFramebuffer(m_sceneBuffer);
+			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			{
+				std::cout << "Error: Scene Colour Buffer Incomplete" << std::endl;
+			}
+		}
+		GLState::BindFramebuffer(0);
 	}
 
-	void DeferredLightingManager::PrepareNewGeometryPass()
+	void DeferredLightingManager::BeginFrame()
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, m_buffer);
 		uint screenWidth, screenHeight;
 		Application::GetScreenSize(screenWidth, screenHeight);
-		glViewport(0, 0, screenWidth, screenHeight);
+		if (std::max(screenWidth, 1u) != m_targetWidth || std::max(screenHeight, 1u) != m_targetHeight)
+		{
+			AllocateTargets(screenWidth, screenHeight);
+		}
+
+		m_dynamicResolution.BeginFrame();
+		float scale = m_dynamicResolution.GetScale();
+		m_renderWidth = std::max((uint)(m_targetWidth * scale + 0.5f), 1u);
+		m_renderHeight = std::max((uint)(m_targetHeight * scale + 0.5f), 1u);
+	}
+
+	void DeferredLightingManager::PrepareNewGeometryPass()
+	{
+		GLState::SetEnabled(GL_DEPTH_CLAMP, false);
+		GLState::SetEnabled(GL_POLYGON_OFFSET_FILL, false);
+		GLState::BindFramebuffer(m_buffer);
+		GLState::SetViewport(0, 0, m_renderWidth, m_renderHeight);
 
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	}
 
-	void DeferredLightingManager::PrepareNewShadowPass()
+	void DeferredLightingManager::PrepareNewShadowPass(const CameraState& lightCamera, const CameraState& viewCamera)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, m_shadowFBO);
-		glViewport(0, 0, 2048, 2048);
+		m_shadowCascades.Fit(lightCamera, viewCamera);
+
+		// Casters in front of a cascade's near plane are clamped to it rather than clipped, so they still cast shadows.
+		// The offset pushes depth back further on surfaces that slope away from the light, where a constant bias isn't enough
+		GLState::SetEnabled(GL_DEPTH_CLAMP, true);
+		GLState::SetEnabled(GL_POLYGON_OFFSET_FILL, true);
+		glPolygonOffset(SHADOW_SLOPE_OFFSET, SHADOW_CONSTANT_OFFSET);
+	}
+
+	bool DeferredLightingManager::PrepareStaticShadowCascade(uint cascade, uint64 staticItemHash)
+	{
+		glm::mat4 viewProjection = m_shadowCascades.GetViewProjection(cascade);
+		if (m_staticShadowsValid[cascade] && m_staticShadowHashes[cascade] == staticItemHash && m_staticShadowMatrices[cascade] == viewProjection)
+		{
+			return false;
+		}
+		m_staticShadowsValid[cascade] = true;
+		m_staticShadowHashes[cascade] = staticItemHash;
+		m_staticShadowMatrices[cascade] = viewProjection;
+
+		glm::ivec2 tile = ShadowCascades::GetTileOffset(cascade);
+		GLState::BindFramebuffer(m_staticShadowFBO);
+		GLState::SetViewport(tile.x, tile.y, ShadowCascades::RESOLUTION, ShadowCascades::RESOLUTION);
+
+		// Clearing only this cascade's tile leaves the other cascades' cached shadows alone
+		GLState::SetEnabled(GL_SCISSOR_TEST, true);
+		glScissor(tile.x, tile.y, ShadowCascades::RESOLUTION, ShadowCascades::RESOLUTION);
 		glClear(GL_DEPTH_BUFFER_BIT);
-		glDrawBuffer(GL_NONE);
-		glReadBuffer(GL_NONE);
+		GLState::SetEnabled(GL_SCISSOR_TEST, false);
+		return true;
 	}
 
-	void DeferredLightingManager::RenderLighting(std::shared_ptr<Camera> camera, std::vector<std::weak_ptr<PointLight>> pointLights, std::shared_ptr<DirectionalLight> directionalLight)
+	const CameraState& DeferredLightingManager::PrepareShadowCascade(uint cascade)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		uint screenWidth, screenHeight;
-		Application::GetScreenSize(screenWidth, screenHeight);
-		glViewport(0, 0, screenWidth, screenHeight);
-		glUseProgram(m_shader.GetProgramID()); 
+		// Every texel of the tile is overwritten by the copy, so it never needs clearing
+		glm::ivec2 tile = ShadowCascades::GetTileOffset(cascade);
+		glCopyImageSubData(m_staticShadowTexture, GL_TEXTURE_2D, 0, tile.x, tile.y, 0,
+			m_shadowTexture, GL_TEXTURE_2D, 0, tile.x, tile.y, 0, ShadowCascades::RESOLUTION, ShadowCascades::RESOLUTION, 1);
 
-		if (pointLights.size() > MAX_POINT_LIGHTS)
+		GLState::BindFramebuffer(m_shadowFBO);
+		GLState::SetViewport(tile.x, tile.y, ShadowCascades::RESOLUTION, ShadowCascades::RESOLUTION);
+		return m_shadowCascades.GetCamera(cascade);
+	}
+
+	void DeferredLightingManager::RenderLighting(const RenderSnapshot& snapshot, const CameraState& camera)
+	{
+		PROFILE_FUNCTION();
+		bool upscale = m_renderWidth != m_targetWidth || m_renderHeight != m_targetHeight;
+		GLState::BindFramebuffer(upscale ? m_sceneBuffer : 0);
+		GLState::SetViewport(0, 0, m_renderWidth, m_renderHeight);
+		GLState::UseProgram(m_shader.GetProgramID());
+
+		UploadPointLights(snapshot.pointLights);
+		m_lightClusters.Build(snapshot.pointLights, camera);
+		m_lightClusters.Upload();
+
+		const DirectionalLightState& directionalLight = snapshot.directionalLight;
+		m_shader.SetGlUniformVec2("gBufferScale", glm::vec2((float)m_renderWidth / m_targetWidth, (float)m_renderHeight / m_targetHeight));
+		m_shader.SetGlUniformMat4("inverseProjViewMat", glm::inverse(camera.proj * camera.view));
+		glm::mat4 cascadeAtlasMats[ShadowCascades::COUNT];
+		float cascadeSplits[ShadowCascades::COUNT];
+		float cascadeDepthBiases[ShadowCascades::COUNT];
+		for (uint cascade = 0; cascade < ShadowCascades::COUNT; ++cascade)
 		{
-			std::cout << "Warning: Too many point lights in scene. Not all will be used." << std::endl;
-			std::cout << "Maximum point lights: " << MAX_POINT_LIGHTS << std::endl;
-			std::cout << "Point lights in scene: " << pointLights.size() << std::endl;
+			cascadeAtlasMats[cascade] = m_shadowCascades.GetAtlasMatrix(cascade);
+			cascadeSplits[cascade] = m_shadowCascades.GetSplitDepth(cascade);
+			cascadeDepthBiases[cascade] = m_shadowCascades.GetDepthBias(cascade);
 		}
-		uint numPointLights = std::min((uint)pointLights.size(), MAX_POINT_LIGHTS);
+		m_shader.SetGlUniformMat4Array(m_cascadeAtlasMatsSlot, cascadeAtlasMats, ShadowCascades::COUNT);
+		m_shader.SetGlUniformFloatArray(m_cascadeSplitsSlot, cascadeSplits, ShadowCascades::COUNT);
+		m_shader.SetGlUniformFloatArray(m_cascadeDepthBiasesSlot, cascadeDepthBiases, ShadowCascades::COUNT);
+		m_shader.SetGlUniformVec3("eyeSpaceLightPos", camera.view * glm::vec4(directionalLight.position, 1.0f));
+		m_shader.SetGlUniformVec3("directionalLightColour", directionalLight.colour);
+		m_shader.SetGlUniformVec3("directionalLightEyeDirection", camera.view * glm::vec4(directionalLight.rotation, 0.0f));
+
+		GLState::BindTexture(0, m_depth);
+		GLState::BindTexture(1, m_normal);
+		GLState::BindTexture(2, m_surface);
+		GLState::BindTexture(3, m_shadowTexture);
+
+		RenderQuad();
+
+		if (upscale)
+		{
+			UpscaleToScreen();
+		}
+		m_dynamicResolution.EndFrame();
+	}
 
-		// Send point lights to shader
-		for (uint i = 0; i < numPointLights; ++i)
+	void DeferredLightingManager::UpscaleToScreen()
+	{
+		// Blits read from the read framebuffer, which GLState doesn't track separately, so it's put back to the window's afterwards
+		GLState::BindFramebuffer(0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_sceneBuffer);
+		glBlitFramebuffer(0, 0, m_renderWidth, m_renderHeight, 0, 0, m_targetWidth, m_targetHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	}
+
+	void DeferredLightingManager::UploadPointLights(const std::vector<PointLightState>& pointLights)
+	{
+		uint count = (uint)pointLights.size();
+		GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_pointLightBuffer);
+
+		// Grow in powers of two, so a scene that keeps adding lights doesn't reallocate every frame
+		if (m_pointLightCapacity == 0 || count > m_pointLightCapacity)
 		{
-			auto pointlight = pointLights[i].lock();
-			if (pointlight)
+			m_pointLightCapacity = std::max(m_pointLightCapacity, 16u);
+			while (m_pointLightCapacity < count)
 			{
-				m_shader.SetGlUniformVec3(("pointLights[" + std::to_string(i) + "].pos").c_str(), pointlight->GetTransform().GetWorldPosition());
-				m_shader.SetGlUniformVec3(("pointLights[" + std::to_string(i) + "].colour").c_str(), pointlight->GetColour());
-				m_shader.SetGlUniformFloat(("pointLights[" + std::to_string(i) + "].linear").c_str(), pointlight->GetLinearAttenuation());
-				m_shader.SetGlUniformFloat(("pointLights[" + std::to_string(i) + "].quadratic").c_str(), pointlight->GetQuadraticAttenuation());
+				m_pointLightCapacity *= 2;
 			}
+			glBufferData(GL_SHADER_STORAGE_BUFFER, POINT_LIGHT_HEADER_SIZE + m_pointLightCapacity * sizeof(PointLightData), NULL, GL_DYNAMIC_DRAW);
 		}
 
-		m_shader.SetGlUniformVec3("viewPos", camera->GetTransform().GetWorldPosition());
-		m_shader.SetGlUniformMat4("cameraViewMat", camera->GetViewMatrix());
-		m_shader.SetGlUniformMat4("shadowVPMat", directionalLight->GetViewProjectionMatrix());
-		m_shader.SetGlUniformVec3("eyeSpaceLightPos", camera->GetViewMatrix() * glm::vec4(directionalLight->GetTransform().GetWorldPosition(), 1.0f));
-		m_shader.SetGlUniformVec3("directionalLightColour", directionalLight->GetColour());
-		m_shader.SetGlUniformVec3("directionalLightEyeDirection", camera->GetViewMatrix() * glm::vec4(directionalLight->GetTransform().GetWorldRotation(), 0.0f));
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_position);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, m_normal);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, m_albedoSpecular);
-		glActiveTexture(GL_TEXTURE3);
-		glBindTexture(GL_TEXTURE_2D, m_emissive);
-		glActiveTexture(GL_TEXTURE4);
-		glBindTexture(GL_TEXTURE_2D, m_shadowTexture);
+		// Invalidating the buffer lets the driver hand over fresh memory rather than wait for last frame's lighting to finish
+		GLsizeiptr size = POINT_LIGHT_HEADER_SIZE + count * sizeof(PointLightData);
+		uint8* data = (uint8*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (!data)
+		{
+			std::cout << "Error: Could not map the point light buffer" << std::endl;
+			return;
+		}
 
-		RenderQuad();
+		uint32 header[4] = { count, 0, 0, 0 };
+		std::memcpy(data, header, POINT_LIGHT_HEADER_SIZE);
+		PointLightData* lights = (PointLightData*)(data + POINT_LIGHT_HEADER_SIZE);
+		for (uint i = 0; i < count; ++i)
+		{
+			const PointLightState& pointLight = pointLights[i];
+			lights[i] = PointLightData{ pointLight.position, pointLight.linearAttenuation, pointLight.colour, pointLight.quadraticAttenuation };
+		}
+		glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+
+		GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, POINT_LIGHT_BINDING, m_pointLightBuffer, 0, size);
 	}
 
 	void DeferredLightingManager::RenderQuad()
@@ -196,16 +335,15 @@ namespace snes
 
 			glGenVertexArrays(1, &m_quadVAO);
 			glGenBuffers(1, &m_quadVBO);
-			glBindVertexArray(m_quadVAO);
-			glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+			GLState::BindVertexArray(m_quadVAO);
+			GLState::BindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
 			glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 			glEnableVertexAttribArray(0);
 			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
 			glEnableVertexAttribArray(1);
 			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 		}
-		glBindVertexArray(m_quadVAO);
+		GLState::BindVertexArray(m_quadVAO);
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-		glBindVertexArray(0);
 	}
 }
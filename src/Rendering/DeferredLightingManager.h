@@ -1,8 +1,10 @@
 #pragma once
 #include <GL/glew.h>
+#include "DynamicResolution.h"
+#include "LightClusterGrid.h"
 #include "ShaderProgram.h"
-#include <Components\DirectionalLight.h>
-#include <Components\PointLight.h>
+#include "ShadowCascades.h"
+#include "RenderSnapshot.h"
 
 namespace snes
 {
@@ -16,35 +18,97 @@ namespace snes
 
 		/** Initialise the deferred framebuffers and deferred lighting shader */
 		void Init();
+		/** Resize the render targets if the window has changed size, and pick the resolution this frame renders at.
+		  * Call before the frame's first pass */
+		void BeginFrame();
 		/** Set up a new geometry pass */
 		void PrepareNewGeometryPass();
-		/** Set up a new shadow pass */
-		void PrepareNewShadowPass();
-		/** Render the contents of the framebuffer, lit by the pointlights */
-		void RenderLighting(std::shared_ptr<Camera> camera, std::vector<std::weak_ptr<PointLight>> pointLights, std::shared_ptr<DirectionalLight> directionalLight);
+		/** Set up a new shadow pass, fitting the shadow cascades of a directional light's camera to the part of a camera's view they cover */
+		void PrepareNewShadowPass(const CameraState& lightCamera, const CameraState& viewCamera);
+		/** Set up redrawing one shadow cascade's cached static shadows, if the cascade has moved or the static items have changed
+		  * since they were drawn. Draw with GetShadowCascadeCamera()
+		  * @param staticItemHash the snapshot's RenderSnapshot::staticItemHash
+		  * @return true if the static shadows need drawing, false if the cached ones still hold */
+		bool PrepareStaticShadowCascade(uint cascade, uint64 staticItemHash);
+		/** Set up drawing one shadow cascade's moving shadow casters, over a copy of its cached static shadows
+		  * @return the camera to draw the cascade's shadow casters with */
+		const CameraState& PrepareShadowCascade(uint cascade);
+		/** @return the camera a shadow cascade's casters are drawn with */
+		const CameraState& GetShadowCascadeCamera(uint cascade) const { return m_shadowCascades.GetCamera(cascade); }
+		/** Render the contents of the framebuffer, lit by the snapshot's lights and seen from the camera the geometry was drawn with.
+		  * Upscales the result to fill the window when the frame was rendered below the window's resolution */
+		void RenderLighting(const RenderSnapshot& snapshot, const CameraState& camera);
 
 	private:
 		/** Render a quad to the screen */
 		void RenderQuad();
 
-		static const glm::mat4 BIAS_MATRIX;
-		const uint MAX_POINT_LIGHTS = 32;
+		/** Size the G-buffer, and the scene colour target when dynamic resolution is on, to the window */
+		void AllocateTargets(uint width, uint height);
+		/** Stretch the lit frame from the scene colour target over the whole window */
+		void UpscaleToScreen();
+
+		/** Create a depth texture the size of the shadow atlas, and a framebuffer that draws into it */
+		void CreateShadowAtlas(GLuint& framebuffer, GLuint& texture);
+
+		/** Write the snapshot's point lights into the light storage buffer, growing it if they don't fit */
+		void UploadPointLights(const std::vector<PointLightState>& pointLights);
+
+		/** The binding point the lighting shader declares its PointLights storage block at */
+		static constexpr GLuint POINT_LIGHT_BINDING = 1;
+		/** The polygon offset shadow casters are drawn with: how far to push depth back per unit of slope, and in steps of depth */
+		static constexpr float SHADOW_SLOPE_OFFSET = 2.0f;
+		static constexpr float SHADOW_CONSTANT_OFFSET = 4.0f;
 
 		ShaderProgram m_shader;
+		/** The lighting shader's per-cascade arrays, found once when it's loaded */
+		UniformSlot m_cascadeAtlasMatsSlot = NO_UNIFORM;
+		UniformSlot m_cascadeSplitsSlot = NO_UNIFORM;
+		UniformSlot m_cascadeDepthBiasesSlot = NO_UNIFORM;
 		GLuint m_quadVAO = 0;
 		GLuint m_quadVBO = 0;
 
-		/** Render buffers */
+		/** Storage buffer holding the point light count followed by every light (see PointLightData) */
+		GLuint m_pointLightBuffer = 0;
+		/** The number of lights the storage buffer has room for */
+		uint m_pointLightCapacity = 0;
+		/** Which lights reach each part of the view, rebuilt every frame */
+		LightClusterGrid m_lightClusters;
+
+		/** The G-buffer, 12 bytes per pixel (against 23 when it stored positions and emissive separately):
+		  * a 24-bit depth texture the lighting pass reconstructs positions from,
+		  * RG16F octahedral-encoded view-space normals,
+		  * and RGBA8 surface colour, holding albedo and specular intensity, or an emissive colour with an alpha of 1.
+		  * An alpha of exactly 1 (255) is the emissive flag, so lit shaders clamp specular to 254/255 (EncodeSpecular()) */
 		GLuint m_buffer;
-		GLuint m_position;
+		GLuint m_depth;
 		GLuint m_normal;
-		GLuint m_albedoSpecular;
-		GLuint m_emissive;
+		GLuint m_surface;
+
+		/** Chooses how much of the render targets each frame is drawn to, from measured GPU time */
+		DynamicResolution m_dynamicResolution;
+		/** The size the render targets are allocated at, which follows the window */
+		uint m_targetWidth = 0;
+		uint m_targetHeight = 0;
+		/** The size this frame is drawn at, in the bottom left of the render targets */
+		uint m_renderWidth = 0;
+		uint m_renderHeight = 0;
+		/** Where the lighting pass draws a frame rendered below the window's resolution, before it's upscaled.
+		  * Only created when dynamic resolution is on */
+		GLuint m_sceneBuffer = 0;
+		GLuint m_sceneColour = 0;
 
+		/** The shadow cameras, fitted to the view each frame */
+		ShadowCascades m_shadowCascades;
 		GLuint m_shadowFBO;
-		GLuint m_shadowRT;
+		/** Every cascade's shadow map, each in its own tile (see ShadowCascades::GetTileOffset()) */
 		GLuint m_shadowTexture;
-
-		uint m_depth;
+		/** The shadows of static items alone, laid out like the shadow atlas, which each frame's shadows start from */
+		GLuint m_staticShadowFBO;
+		GLuint m_staticShadowTexture;
+		/** What each cascade's static shadows were drawn with: its view and projection, and the static items' hash */
+		glm::mat4 m_staticShadowMatrices[ShadowCascades::COUNT];
+		uint64 m_staticShadowHashes[ShadowCascades::COUNT] = {};
+		bool m_staticShadowsValid[ShadowCascades::COUNT] = {};
 	};
 }
@@ -0,0 +1,111 @@
+#include "stdafx.h"
+#include "DynamicResolution.h"
+#include "GraphicsDevice.h"
+#include <Core\FrameTime.h>
+#include <Core\Profiler.h>
+#include <algorithm>
+#include <cmath>
+
+namespace snes
+{
+	constexpr float DynamicResolution::MIN_SCALE;
+	constexpr float DynamicResolution::MAX_SCALE;
+	constexpr float DynamicResolution::HEADROOM;
+	constexpr uint DynamicResolution::GROW_DELAY;
+	constexpr float DynamicResolution::MAX_GROWTH;
+	constexpr uint DynamicResolution::QUERY_COUNT;
+
+	float DynamicResolution::m_targetGpuTime = 0.0f;
+
+	void DynamicResolution::BeginFrame()
+	{
+		if (!IsEnabled() || !GraphicsDevice::IsAvailable())
+		{
+			m_scale = MAX_SCALE;
+			return;
+		}
+
+		if (m_queries[0] == 0)
+		{
+			glGenQueries(QUERY_COUNT, m_queries);
+		}
+
+		// Results arrive in the order the frames were drawn, so stop at the first that isn't ready
+		while (m_pendingCount > 0)
+		{
+			GLuint query = m_queries[m_firstPending];
+			GLint available = 0;
+			glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+			{
+				break;
+			}
+
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+			float gpuMilliseconds = (float)((double)nanoseconds / NS_IN_MS);
+			Update(gpuMilliseconds, m_queryScales[m_firstPending]);
+			PROFILE_COUNTER("GPU frame time (ms)", gpuMilliseconds);
+
+			m_firstPending = (m_firstPending + 1) % QUERY_COUNT;
+			--m_pendingCount;
+		}
+		PROFILE_COUNTER("Render scale (%)", m_scale * 100.0f);
+
+		// Every query is still in flight, so this frame goes untimed rather than waiting for one
+		m_timing = m_pendingCount < QUERY_COUNT;
+		if (m_timing)
+		{
+			uint next = (m_firstPending + m_pendingCount) % QUERY_COUNT;
+			m_queryScales[next] = m_scale;
+			glBeginQuery(GL_TIME_ELAPSED, m_queries[next]);
+		}
+	}
+
+	void DynamicResolution::EndFrame()
+	{
+		if (m_timing)
+		{
+			glEndQuery(GL_TIME_ELAPSED);
+			++m_pendingCount;
+			m_timing = false;
+		}
+	}
+
+	float DynamicResolution::Update(float gpuMilliseconds, float measuredScale)
+	{
+		if (!IsEnabled() || gpuMilliseconds <= 0.0f)
+		{
+			return m_scale;
+		}
+
+		// Timings are a few frames old, so estimate what the current scale costs, taking the time to follow the pixel count.
+		// Without this, every late timing of a frame drawn before a drop would drop the scale again
+		float scaleRatio = m_scale / std::max(measuredScale, MIN_SCALE);
+		float estimate = gpuMilliseconds * scaleRatio * scaleRatio;
+
+		if (estimate > m_targetGpuTime)
+		{
+			m_scale = std::max(m_scale * std::sqrt(m_targetGpuTime / estimate), MIN_SCALE);
+			m_framesUnderHeadroom = 0;
+		}
+		else if (estimate < m_targetGpuTime * HEADROOM)
+		{
+			if (++m_framesUnderHeadroom >= GROW_DELAY)
+			{
+				float growth = std::min(std::sqrt(m_targetGpuTime / estimate), MAX_GROWTH);
+				m_scale *= growth;
+				// Within a step of full resolution, take the last step, rather than upscaling a frame a few pixels short of the window
+				if (m_scale * MAX_GROWTH > MAX_SCALE)
+				{
+					m_scale = MAX_SCALE;
+				}
+			}
+		}
+		else
+		{
+			m_framesUnderHeadroom = 0;
+		}
+		return m_scale;
+	}
+}
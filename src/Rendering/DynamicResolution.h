@@ -0,0 +1,66 @@
+#pragma once
+#include <GL/glew.h>
+
+namespace snes
+{
+	/** Dynamic Resolution
+	  * Picks the fraction of the window's width and height the geometry and lighting passes render at, from how long
+	  * the GPU took to draw recent frames. A frame over the target time drops the scale straight away, so a load spike
+	  * costs resolution rather than frame rate; the scale only creeps back up once frames have stayed well under the
+	  * target for a while, so it doesn't oscillate around it.
+	  *
+	  * GPU time is measured with timer queries read a few frames later, once they're ready, so measuring never stalls.
+	  * Disabled (always full resolution) unless a target is set with SetTargetGpuTime(). */
+	class DynamicResolution
+	{
+	public:
+		/** The lowest scale rendered at, in each dimension */
+		static constexpr float MIN_SCALE = 0.5f;
+		/** The highest scale rendered at, in each dimension */
+		static constexpr float MAX_SCALE = 1.0f;
+
+		/** Set the GPU time each frame should fit in, in milliseconds, or 0 to always render at full resolution */
+		static void SetTargetGpuTime(float milliseconds) { m_targetGpuTime = milliseconds > 0.0f ? milliseconds : 0.0f; }
+		/** @return the GPU time each frame should fit in, in milliseconds, or 0 if dynamic resolution is off */
+		static float GetTargetGpuTime() { return m_targetGpuTime; }
+		/** @return true if the render scale follows the GPU time */
+		static bool IsEnabled() { return m_targetGpuTime > 0.0f; }
+
+		/** Read any finished timings, update the scale from them, and start timing the frame's GPU work */
+		void BeginFrame();
+		/** Stop timing the frame's GPU work */
+		void EndFrame();
+
+		/** Move the scale towards one that fits the target, given a frame's GPU time and the scale it was drawn at
+		  * @return the new scale */
+		float Update(float gpuMilliseconds, float measuredScale);
+
+		/** @return the fraction of the window's width and height to render at */
+		float GetScale() const { return m_scale; }
+
+	private:
+		/** Frames are only drawn at a higher scale once they fit in this fraction of the target */
+		static constexpr float HEADROOM = 0.85f;
+		/** The number of frames in a row that must fit in the headroom before the scale rises */
+		static constexpr uint GROW_DELAY = 10;
+		/** The most the scale may rise in one frame */
+		static constexpr float MAX_GROWTH = 1.02f;
+		/** The number of frames that may be waiting for their timings at once */
+		static constexpr uint QUERY_COUNT = 4;
+
+		static float m_targetGpuTime;
+
+		float m_scale = MAX_SCALE;
+		/** Frames in a row that fit in the headroom */
+		uint m_framesUnderHeadroom = 0;
+
+		GLuint m_queries[QUERY_COUNT] = {};
+		/** The scale each query's frame was drawn at */
+		float m_queryScales[QUERY_COUNT] = {};
+		/** The oldest query still waiting for its result, and the number waiting */
+		uint m_firstPending = 0;
+		uint m_pendingCount = 0;
+		/** Whether the current frame is being timed */
+		bool m_timing = false;
+	};
+}
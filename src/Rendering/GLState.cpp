@@ -0,0 +1,273 @@
+#include "stdafx.h"
+#include "GLState.h"
+#include <Core\Profiler.h>
+#include <cstring>
+
+namespace snes
+{
+	namespace
+	{
+		/** @return the index a buffer target is tracked at, or -1 if it isn't tracked */
+		int GetBufferTargetIndex(GLenum target)
+		{
+			switch (target)
+			{
+			case GL_ARRAY_BUFFER:
+				return 0;
+			case GL_UNIFORM_BUFFER:
+				return 1;
+			case GL_SHADER_STORAGE_BUFFER:
+				return 2;
+			default:
+				return -1;
+			}
+		}
+
+		/** @return the index a capability is tracked at, or -1 if it isn't tracked */
+		int GetCapabilityIndex(GLenum capability)
+		{
+			switch (capability)
+			{
+			case GL_BLEND:
+				return 0;
+			case GL_DEPTH_TEST:
+				return 1;
+			case GL_CULL_FACE:
+				return 2;
+			case GL_POLYGON_STIPPLE:
+				return 3;
+			case GL_DEPTH_CLAMP:
+				return 4;
+			case GL_POLYGON_OFFSET_FILL:
+				return 5;
+			default:
+				return -1;
+			}
+		}
+	}
+
+	constexpr GLuint GLState::UNKNOWN;
+	constexpr uint GLState::MAX_TEXTURE_UNITS;
+	constexpr uint GLState::TRACKED_BUFFER_TARGETS;
+	constexpr uint GLState::TRACKED_CAPABILITIES;
+
+	GLuint GLState::m_program = GLState::UNKNOWN;
+	GLuint GLState::m_vertexArray = GLState::UNKNOWN;
+	// Each array lists one UNKNOWN per tracked entry, so nothing is assumed bound before Invalidate() is first called
+	GLuint GLState::m_buffers[GLState::TRACKED_BUFFER_TARGETS] = { GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN };
+	GLuint GLState::m_framebuffer = GLState::UNKNOWN;
+	GLuint GLState::m_activeTextureUnit = GLState::UNKNOWN;
+	GLuint GLState::m_textures[GLState::MAX_TEXTURE_UNITS] = {
+		GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN,
+		GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN
+	};
+	GLuint GLState::m_capabilities[GLState::TRACKED_CAPABILITIES] = { GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN, GLState::UNKNOWN };
+	GLuint GLState::m_polygonMode = GLState::UNKNOWN;
+	GLubyte GLState::m_polygonStipple[128];
+	bool GLState::m_polygonStippleKnown = false;
+	int GLState::m_viewport[4] = { -1, -1, -1, -1 };
+	GLuint GLState::m_patchVertices = GLState::UNKNOWN;
+
+	uint64 GLState::m_issued = 0;
+	uint64 GLState::m_elided = 0;
+	uint64 GLState::m_issuedLastFrame = 0;
+	uint64 GLState::m_elidedLastFrame = 0;
+
+	template <typename T>
+	bool GLState::Change(T& current, T value)
+	{
+		if (current == value)
+		{
+			++m_elided;
+			return false;
+		}
+		current = value;
+		++m_issued;
+		return true;
+	}
+
+	void GLState::UseProgram(GLuint program)
+	{
+		if (Change(m_program, program))
+		{
+			glUseProgram(program);
+		}
+	}
+
+	void GLState::BindVertexArray(GLuint vertexArray)
+	{
+		if (Change(m_vertexArray, vertexArray))
+		{
+			glBindVertexArray(vertexArray);
+		}
+	}
+
+	void GLState::BindBuffer(GLenum target, GLuint buffer)
+	{
+		int index = GetBufferTargetIndex(target);
+		if (index < 0)
+		{
+			++m_issued;
+			glBindBuffer(target, buffer);
+		}
+		else if (Change(m_buffers[index], buffer))
+		{
+			glBindBuffer(target, buffer);
+		}
+	}
+
+	void GLState::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+	{
+		// Binding to an indexed point also binds the buffer to the target itself
+		int targetIndex = GetBufferTargetIndex(target);
+		if (targetIndex >= 0)
+		{
+			m_buffers[targetIndex] = buffer;
+		}
+		++m_issued;
+		glBindBufferRange(target, index, buffer, offset, size);
+	}
+
+	void GLState::BindFramebuffer(GLuint framebuffer)
+	{
+		if (Change(m_framebuffer, framebuffer))
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		}
+	}
+
+	void GLState::BindTexture(uint unit, GLuint texture)
+	{
+		if (unit >= MAX_TEXTURE_UNITS)
+		{
+			// Units past the tracked ones always bind, and leave the active unit unknown
+			++m_issued;
+			m_activeTextureUnit = UNKNOWN;
+			glActiveTexture(GL_TEXTURE0 + unit);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			return;
+		}
+
+		if (Change(m_textures[unit], texture))
+		{
+			SetActiveTextureUnit(unit);
+			glBindTexture(GL_TEXTURE_2D, texture);
+		}
+	}
+
+	void GLState::SetActiveTextureUnit(uint unit)
+	{
+		if (Change(m_activeTextureUnit, (GLuint)unit))
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+		}
+	}
+
+	void GLState::SetEnabled(GLenum capability, bool enabled)
+	{
+		int index = GetCapabilityIndex(capability);
+		if (index >= 0 && !Change(m_capabilities[index], (GLuint)enabled))
+		{
+			return;
+		}
+
+		if (index < 0)
+		{
+			++m_issued;
+		}
+		if (enabled)
+		{
+			glEnable(capability);
+		}
+		else
+		{
+			glDisable(capability);
+		}
+	}
+
+	void GLState::SetPolygonMode(GLenum mode)
+	{
+		if (Change(m_polygonMode, (GLuint)mode))
+		{
+			glPolygonMode(GL_FRONT_AND_BACK, mode);
+		}
+	}
+
+	void GLState::SetPolygonStipple(const GLubyte pattern[128])
+	{
+		if (m_polygonStippleKnown && std::memcmp(m_polygonStipple, pattern, sizeof(m_polygonStipple)) == 0)
+		{
+			++m_elided;
+			return;
+		}
+		std::memcpy(m_polygonStipple, pattern, sizeof(m_polygonStipple));
+		m_polygonStippleKnown = true;
+		++m_issued;
+		glPolygonStipple(pattern);
+	}
+
+	void GLState::SetViewport(int x, int y, int width, int height)
+	{
+		if (m_viewport[0] == x && m_viewport[1] == y && m_viewport[2] == width && m_viewport[3] == height)
+		{
+			++m_elided;
+			return;
+		}
+		m_viewport[0] = x;
+		m_viewport[1] = y;
+		m_viewport[2] = width;
+		m_viewport[3] = height;
+		++m_issued;
+		glViewport(x, y, width, height);
+	}
+
+	void GLState::SetPatchVertices(int vertices)
+	{
+		if (Change(m_patchVertices, (GLuint)vertices))
+		{
+			glPatchParameteri(GL_PATCH_VERTICES, vertices);
+		}
+	}
+
+	void GLState::Invalidate()
+	{
+		m_program = UNKNOWN;
+		m_vertexArray = UNKNOWN;
+		for (GLuint& buffer : m_buffers)
+		{
+			buffer = UNKNOWN;
+		}
+		m_framebuffer = UNKNOWN;
+		m_activeTextureUnit = UNKNOWN;
+		InvalidateTextures();
+		for (GLuint& capability : m_capabilities)
+		{
+			capability = UNKNOWN;
+		}
+		m_polygonMode = UNKNOWN;
+		m_polygonStippleKnown = false;
+		for (int& value : m_viewport)
+		{
+			value = -1;
+		}
+		m_patchVertices = UNKNOWN;
+	}
+
+	void GLState::InvalidateTextures()
+	{
+		for (GLuint& texture : m_textures)
+		{
+			texture = UNKNOWN;
+		}
+	}
+
+	void GLState::EndFrame()
+	{
+		PROFILE_COUNTER("GL state calls issued", m_issued);
+		PROFILE_COUNTER("GL state calls elided", m_elided);
+		m_issuedLastFrame = m_issued;
+		m_elidedLastFrame = m_elided;
+		m_issued = 0;
+		m_elided = 0;
+	}
+}
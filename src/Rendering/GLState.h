@@ -0,0 +1,80 @@
+#pragma once
+#include <GL/glew.h>
+
+namespace snes
+{
+	/** GL State
+	  * Remembers the GL state the engine has set, so setting it to what it already is costs a compare instead of a
+	  * driver call. Every bind or toggle of tracked state goes through here rather than straight to GL; anything that
+	  * changes tracked state behind its back (e.g. a texture loading library) must call the matching Invalidate.
+	  * Counts the calls it issues and elides each frame. Like all GL calls, only used from the thread owning the context. */
+	class GLState
+	{
+	public:
+		static void UseProgram(GLuint program);
+		static void BindVertexArray(GLuint vertexArray);
+		/** Bind a buffer. Array, uniform and shader storage buffer bindings are tracked; other targets always bind */
+		static void BindBuffer(GLenum target, GLuint buffer);
+		/** Bind part of a buffer to an indexed binding point. Always issued, but keeps the target's tracked binding correct */
+		static void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+		static void BindFramebuffer(GLuint framebuffer);
+
+		/** Bind a 2D texture to a texture unit, only making the unit active if the binding changes.
+		  * Units from MAX_TEXTURE_UNITS up aren't tracked, so binding to them is always issued */
+		static void BindTexture(uint unit, GLuint texture);
+		/** Make a texture unit active, e.g. before changing the parameters of the texture bound to it */
+		static void SetActiveTextureUnit(uint unit);
+
+		/** Enable or disable a capability. Blending, depth testing, face culling, polygon stippling, depth clamping and
+		  * polygon offset filling are tracked */
+		static void SetEnabled(GLenum capability, bool enabled);
+		/** Set the polygon mode of front and back faces */
+		static void SetPolygonMode(GLenum mode);
+		static void SetPolygonStipple(const GLubyte pattern[128]);
+		static void SetViewport(int x, int y, int width, int height);
+		static void SetPatchVertices(int vertices);
+
+		/** Forget everything, so the next call for each piece of state is issued. Call when the context is created */
+		static void Invalidate();
+		/** Forget the texture bindings, after something other than this class has bound textures */
+		static void InvalidateTextures();
+
+		/** Report this frame's issued and elided calls to the profiler, and start counting the next frame */
+		static void EndFrame();
+
+		/** @return the number of calls made to GL last frame */
+		static uint64 GetIssuedLastFrame() { return m_issuedLastFrame; }
+		/** @return the number of calls skipped last frame because the state was already set */
+		static uint64 GetElidedLastFrame() { return m_elidedLastFrame; }
+
+	private:
+		/** Stored in place of a binding or value that isn't known, so it never matches */
+		static constexpr GLuint UNKNOWN = 0xFFFFFFFF;
+		static constexpr uint MAX_TEXTURE_UNITS = 16;
+		static constexpr uint TRACKED_BUFFER_TARGETS = 3;
+		static constexpr uint TRACKED_CAPABILITIES = 6;
+
+		/** @return true (and count the call as issued) if a tracked value differs from the new one, storing the new one */
+		template <typename T>
+		static bool Change(T& current, T value);
+
+		static GLuint m_program;
+		static GLuint m_vertexArray;
+		static GLuint m_buffers[TRACKED_BUFFER_TARGETS];
+		static GLuint m_framebuffer;
+		static GLuint m_activeTextureUnit;
+		static GLuint m_textures[MAX_TEXTURE_UNITS];
+		/** 1 if enabled, 0 if disabled, or UNKNOWN */
+		static GLuint m_capabilities[TRACKED_CAPABILITIES];
+		static GLuint m_polygonMode;
+		static GLubyte m_polygonStipple[128];
+		static bool m_polygonStippleKnown;
+		static int m_viewport[4];
+		static GLuint m_patchVertices;
+
+		static uint64 m_issued;
+		static uint64 m_elided;
+		static uint64 m_issuedLastFrame;
+		static uint64 m_elidedLastFrame;
+	};
+}
@@ -0,0 +1,18 @@
+#include "stdafx.h"
+#include "GraphicsDevice.h"
+
+namespace snes
+{
+	bool GraphicsDevice::m_available = false;
+
+	uint64 GraphicsDevice::m_skippedUploads = 0;
+	uint64 GraphicsDevice::m_skippedUploadBytes = 0;
+	uint64 GraphicsDevice::m_skippedShaders = 0;
+	uint64 GraphicsDevice::m_skippedDraws = 0;
+
+	void GraphicsDevice::RecordSkippedUpload(uint64 bytes)
+	{
+		++m_skippedUploads;
+		m_skippedUploadBytes += bytes;
+	}
+}
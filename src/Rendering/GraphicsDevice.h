@@ -0,0 +1,40 @@
+#pragma once
+
+namespace snes
+{
+	/** Graphics Device
+	  * Tracks whether a GL context exists. Without one (e.g. when running headless) every GPU upload
+	  * and draw is skipped instead of issued, and only counted so a headless run can report what it avoided. */
+	class GraphicsDevice
+	{
+	public:
+		/** Mark the GL context as created (or not). Defaults to false until the Application has initialised glew */
+		static void SetAvailable(bool available) { m_available = available; }
+		/** @return true if GL calls can be issued */
+		static bool IsAvailable() { return m_available; }
+
+		/** Record a buffer or texture upload that was skipped because there is no GL context */
+		static void RecordSkippedUpload(uint64 bytes);
+		/** Record a shader program that was not compiled because there is no GL context */
+		static void RecordSkippedShader() { ++m_skippedShaders; }
+		/** Record a frame whose draw calls were skipped because there is no GL context */
+		static void RecordSkippedDraw() { ++m_skippedDraws; }
+
+		/** @return the number of uploads skipped so far */
+		static uint64 GetSkippedUploads() { return m_skippedUploads; }
+		/** @return the total size of the uploads skipped so far, in bytes */
+		static uint64 GetSkippedUploadBytes() { return m_skippedUploadBytes; }
+		/** @return the number of shader programs not compiled so far */
+		static uint64 GetSkippedShaders() { return m_skippedShaders; }
+		/** @return the number of frames whose draws were skipped so far */
+		static uint64 GetSkippedDraws() { return m_skippedDraws; }
+
+	private:
+		static bool m_available;
+
+		static uint64 m_skippedUploads;
+		static uint64 m_skippedUploadBytes;
+		static uint64 m_skippedShaders;
+		static uint64 m_skippedDraws;
+	};
+}
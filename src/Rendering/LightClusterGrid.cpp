@@ -0,0 +1,218 @@
+#include "stdafx.h"
+#include "LightClusterGrid.h"
+#include "GLState.h"
+#include "GraphicsDevice.h"
+#include <Core\Profiler.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace snes
+{
+	namespace
+	{
+		/** The depth scale and bias at the start of the block, before the clusters */
+		const GLsizeiptr HEADER_SIZE = 2 * sizeof(float);
+	}
+
+	constexpr uint LightClusterGrid::CLUSTERS_X;
+	constexpr uint LightClusterGrid::CLUSTERS_Y;
+	constexpr uint LightClusterGrid::CLUSTERS_Z;
+	constexpr uint LightClusterGrid::CLUSTER_COUNT;
+	constexpr GLuint LightClusterGrid::BINDING;
+
+	void LightClusterGrid::Build(const std::vector<PointLightState>& pointLights, const CameraState& camera)
+	{
+		PROFILE_FUNCTION();
+
+		// The near and far planes, read back out of the projection
+		const glm::mat4& proj = camera.proj;
+		float zNear = proj[3][2] / (proj[2][2] - 1.0f);
+		float zFar = proj[3][2] / (proj[2][2] + 1.0f);
+		float logDepthRange = std::log(zFar / zNear);
+		m_depthScale = CLUSTERS_Z / logDepthRange;
+		m_depthBias = CLUSTERS_Z * std::log(zNear) / logDepthRange;
+		for (uint z = 0; z <= CLUSTERS_Z; ++z)
+		{
+			m_sliceDepths[z] = zNear * std::pow(zFar / zNear, (float)z / CLUSTERS_Z);
+		}
+
+		std::memset(m_clusters.data(), 0, m_clusters.size() * sizeof(Cluster));
+		m_spans.clear();
+
+		// Find the tiles each light reaches in each slice
+		const glm::vec2 tileCount((float)CLUSTERS_X, (float)CLUSTERS_Y);
+		const glm::vec2 lastTile(CLUSTERS_X - 1, CLUSTERS_Y - 1);
+		for (uint32 i = 0; i < pointLights.size(); ++i)
+		{
+			float radius = GetLightRadius(pointLights[i]);
+			if (radius <= 0.0f)
+			{
+				continue;
+			}
+
+			glm::vec3 centre = glm::vec3(camera.view * glm::vec4(pointLights[i].position, 1.0f));
+			float centreDepth = -centre.z;
+			float minDepth = centreDepth - radius;
+			float maxDepth = centreDepth + radius;
+			if (maxDepth < zNear || minDepth > zFar)
+			{
+				continue;
+			}
+
+			if (radius == std::numeric_limits<float>::infinity())
+			{
+				for (uint z = 0; z < CLUSTERS_Z; ++z)
+				{
+					m_spans.push_back(LightSpan{ i, (uint8)z, 0, CLUSTERS_X - 1, 0, CLUSTERS_Y - 1 });
+				}
+				continue;
+			}
+
+			uint z0 = GetSlice(std::max(minDepth, zNear));
+			uint z1 = GetSlice(std::min(maxDepth, zFar));
+			for (uint z = z0; z <= z1; ++z)
+			{
+				// The part of the sphere inside this slice fits in a box as wide as its widest cross-section there.
+				// Slices start at the near plane, so the box is always in front of the camera and its corners' tiles hold it
+				float sliceNear = std::max(m_sliceDepths[z], minDepth);
+				float sliceFar = std::min(m_sliceDepths[z + 1], maxDepth);
+				float widest = glm::clamp(centreDepth, sliceNear, sliceFar) - centreDepth;
+				float halfWidth = std::sqrt(std::max(radius * radius - widest * widest, 0.0f));
+
+				glm::vec2 ndcMin(1.0f);
+				glm::vec2 ndcMax(-1.0f);
+				for (uint corner = 0; corner < 8; ++corner)
+				{
+					glm::vec3 point(centre.x + ((corner & 1) ? halfWidth : -halfWidth), centre.y + ((corner & 2) ? halfWidth : -halfWidth),
+						(corner & 4) ? -sliceFar : -sliceNear);
+					glm::vec4 clip = proj * glm::vec4(point, 1.0f);
+					glm::vec2 ndc = glm::vec2(clip) / clip.w;
+					ndcMin = glm::min(ndcMin, ndc);
+					ndcMax = glm::max(ndcMax, ndc);
+				}
+				if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+				{
+					continue;
+				}
+
+				glm::vec2 tileMin = glm::clamp((ndcMin * 0.5f + 0.5f) * tileCount, glm::vec2(0.0f), lastTile);
+				glm::vec2 tileMax = glm::clamp((ndcMax * 0.5f + 0.5f) * tileCount, glm::vec2(0.0f), lastTile);
+				m_spans.push_back(LightSpan{ i, (uint8)z, (uint8)tileMin.x, (uint8)tileMax.x, (uint8)tileMin.y, (uint8)tileMax.y });
+			}
+		}
+
+		// Count the lights in each cluster
+		for (const LightSpan& span : m_spans)
+		{
+			for (uint y = span.y0; y <= span.y1; ++y)
+			{
+				Cluster* row = &m_clusters[(span.z * CLUSTERS_Y + y) * CLUSTERS_X];
+				for (uint x = span.x0; x <= span.x1; ++x)
+				{
+					++row[x].count;
+				}
+			}
+		}
+
+		// Give each cluster its range of the index list, then fill the ranges in light order
+		uint32 total = 0;
+		for (Cluster& cluster : m_clusters)
+		{
+			cluster.offset = total;
+			total += cluster.count;
+			cluster.count = 0;
+		}
+		m_lightIndices.resize(total);
+
+		for (const LightSpan& span : m_spans)
+		{
+			for (uint y = span.y0; y <= span.y1; ++y)
+			{
+				Cluster* row = &m_clusters[(span.z * CLUSTERS_Y + y) * CLUSTERS_X];
+				for (uint x = span.x0; x <= span.x1; ++x)
+				{
+					m_lightIndices[row[x].offset + row[x].count++] = span.light;
+				}
+			}
+		}
+
+		PROFILE_COUNTER("Light cluster entries", total);
+	}
+
+	void LightClusterGrid::Upload()
+	{
+		if (!GraphicsDevice::IsAvailable())
+		{
+			return;
+		}
+
+		if (m_buffer == 0)
+		{
+			glGenBuffers(1, &m_buffer);
+		}
+		GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffer);
+
+		// Grow in powers of two, so the buffer is only reallocated when lights start covering much more of the view
+		const GLsizeiptr clustersSize = CLUSTER_COUNT * sizeof(Cluster);
+		uint indexCount = (uint)m_lightIndices.size();
+		if (m_indexCapacity == 0 || indexCount > m_indexCapacity)
+		{
+			m_indexCapacity = std::max(m_indexCapacity, 1024u);
+			while (m_indexCapacity < indexCount)
+			{
+				m_indexCapacity *= 2;
+			}
+			glBufferData(GL_SHADER_STORAGE_BUFFER, HEADER_SIZE + clustersSize + m_indexCapacity * sizeof(uint32), NULL, GL_DYNAMIC_DRAW);
+		}
+
+		GLsizeiptr size = HEADER_SIZE + clustersSize + indexCount * sizeof(uint32);
+		uint8* data = (uint8*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (!data)
+		{
+			std::cout << "Error: Could not map the light cluster buffer" << std::endl;
+			return;
+		}
+
+		float header[2] = { m_depthScale, m_depthBias };
+		std::memcpy(data, header, HEADER_SIZE);
+		std::memcpy(data + HEADER_SIZE, m_clusters.data(), clustersSize);
+		if (indexCount > 0)
+		{
+			std::memcpy(data + HEADER_SIZE + clustersSize, m_lightIndices.data(), indexCount * sizeof(uint32));
+		}
+		glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+
+		GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, BINDING, m_buffer, 0, size);
+	}
+
+	float LightClusterGrid::GetLightRadius(const PointLightState& pointLight)
+	{
+		// Attenuation is 1 / (1 + linear * d + quadratic * d^2), so solve for where it scales the brightest channel to 1/256
+		float brightest = std::max(pointLight.colour.r, std::max(pointLight.colour.g, pointLight.colour.b));
+		float c = 1.0f - brightest * 256.0f;
+		if (c >= 0.0f)
+		{
+			return 0.0f;
+		}
+
+		float linear = pointLight.linearAttenuation;
+		float quadratic = pointLight.quadraticAttenuation;
+		if (quadratic > 0.0f)
+		{
+			return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+		}
+		if (linear > 0.0f)
+		{
+			return -c / linear;
+		}
+		return std::numeric_limits<float>::infinity();
+	}
+
+	uint LightClusterGrid::GetSlice(float depth) const
+	{
+		float slice = std::log(depth) * m_depthScale - m_depthBias;
+		return (uint)glm::clamp(slice, 0.0f, (float)(CLUSTERS_Z - 1));
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <GL/glew.h>
+#include "RenderSnapshot.h"
+
+namespace snes
+{
+	/** Light Cluster Grid
+	  * Splits the view frustum into screen tiles and exponentially spaced depth slices, and lists the point lights whose
+	  * range reaches each cluster, so the lighting pass only evaluates the lights that can affect a pixel.
+	  * A light's range is where its attenuated colour falls below 1/256, the smallest step an 8-bit target shows.
+	  * Built on the CPU every frame from the snapshot's lights, then uploaded with a single buffer write. */
+	class LightClusterGrid
+	{
+	public:
+		/** Must match the constants in DeferredLightingPass.fs */
+		static constexpr uint CLUSTERS_X = 16;
+		static constexpr uint CLUSTERS_Y = 9;
+		static constexpr uint CLUSTERS_Z = 24;
+		static constexpr uint CLUSTER_COUNT = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+
+		/** The binding point the lighting shader declares its LightClusters storage block at */
+		static constexpr GLuint BINDING = 2;
+
+		/** A cluster's lights, as a range of the light index list */
+		struct Cluster
+		{
+			uint32 offset;
+			uint32 count;
+		};
+
+		/** Bin lights into the clusters of a camera's view. The camera must have a perspective projection */
+		void Build(const std::vector<PointLightState>& pointLights, const CameraState& camera);
+
+		/** Write the grid into its storage buffer and bind it for the lighting pass */
+		void Upload();
+
+		const std::vector<Cluster>& GetClusters() const { return m_clusters; }
+		const std::vector<uint32>& GetLightIndices() const { return m_lightIndices; }
+
+		/** @return the distance beyond which a light adds less than 1/256 to any colour channel, or infinity if it never does */
+		static float GetLightRadius(const PointLightState& pointLight);
+
+	private:
+		/** The tiles a light reaches in one depth slice, as inclusive ranges */
+		struct LightSpan
+		{
+			uint32 light;
+			uint8 z;
+			uint8 x0, x1;
+			uint8 y0, y1;
+		};
+
+		/** @return the depth slice a positive view-space depth falls in */
+		uint GetSlice(float depth) const;
+
+		/** Turns log(depth) into a slice: slice = log(depth) * scale - bias */
+		float m_depthScale = 0.0f;
+		float m_depthBias = 0.0f;
+		/** The view-space depth each slice starts at, and the far plane at the end */
+		float m_sliceDepths[CLUSTERS_Z + 1];
+
+		std::vector<Cluster> m_clusters = std::vector<Cluster>(CLUSTER_COUNT);
+		std::vector<uint32> m_lightIndices;
+		/** Every slice of every light that reaches the view, kept between frames for its storage */
+		std::vector<LightSpan> m_spans;
+
+		GLuint m_buffer = 0;
+		/** The number of light indices the storage buffer has room for */
+		uint m_indexCapacity = 0;
+	};
+}
@@ -1,5 +1,7 @@
 #include "stdafx.h"
 #include "Material.h"
+#include "GLState.h"
+#include "GraphicsDevice.h"
 #include "Materials/BillboardMat.h"
 #include "Materials/DiscoMat.h"
 #include "Materials/LitColourMat.h"
@@ -9,16 +11,20 @@
 #include "Materials/SolidColourMat.h"
 #include "Materials/TessellatedMat.h"
 #include "Materials/UnlitTexturedMat.h"
+#include <cstring>
 #include <fstream>
+#include <glm\gtc\matrix_inverse.hpp>
+#include <SOIL/SOIL.h>
 
 namespace snes
 {
 	std::map<ShaderName, std::weak_ptr<ShaderProgram>> Material::m_shaders;
-	ShaderName Material::m_currentShader = NONE;
+	uint16 Material::m_nextSortId = 0;
 
 	Material::Material(ShaderName shaderName)
 	{
 		m_shaderName = shaderName;
+		m_sortId = m_nextSortId++;
 
 		// If the shader is not cached yet, load it now and cache it
 		if (m_shaders[shaderName].expired())
@@ -30,10 +36,21 @@ namespace snes
 		{
 			m_shader = m_shaders[shaderName].lock();
 		}
+
+		m_parameters.resize(m_shader->GetUniformCount());
+
+		// Not every shader uses every transform, so missing ones aren't reported
+		m_modelMatSlot = m_shader->FindUniformSlot("modelMat");
+		m_normalMatSlot = m_shader->FindUniformSlot("normalMat");
 	}
 
 	Material::~Material()
 	{
+		// A new material could be made at the same address, and mustn't think the shader already holds its parameters
+		if (m_shader->GetParameterOwner() == this)
+		{
+			m_shader->SetParameterOwner(nullptr);
+		}
 	}
 
 	/**********************************
@@ -137,81 +154,167 @@ namespace snes
 	}
 
 
+	GLuint Material::LoadTexture(const char* texturePath)
+	{
+		if (!GraphicsDevice::IsAvailable())
+		{
+			// Record the file size as an estimate of what would have been uploaded
+			std::ifstream texture(texturePath, std::ios::in | std::ios::binary | std::ios::ate);
+			GraphicsDevice::RecordSkippedUpload(texture ? (uint64)texture.tellg() : 0);
+			return 0;
+		}
+
+		GLuint texture = SOIL_load_OGL_texture(
+			texturePath,
+			SOIL_LOAD_AUTO,
+			SOIL_CREATE_NEW_ID,
+			SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
+		);
+		// SOIL binds the texture it creates without going through GLState
+		GLState::InvalidateTextures();
+		return texture;
+	}
+
+
 	/******************************
 	** Apply all shader uniforms **
 	******************************/
 
-	void Material::PrepareForRendering()
+	void Material::BindShader() const
 	{
-		if (m_currentShader != m_shaderName)
+		if (GraphicsDevice::IsAvailable())
 		{
-			// Only swap shaders if necessary
-			glUseProgram(m_shader->GetProgramID());
-			m_currentShader = m_shaderName;
+			GLState::UseProgram(m_shader->GetProgramID());
 		}
+	}
 
-		for (const auto& uniform : m_mat4s)
-		{
-			m_shader->SetGlUniformMat4(uniform.first.c_str(), uniform.second);
-		}
-		for (const auto& uniform : m_vec3s)
-		{
-			m_shader->SetGlUniformVec3(uniform.first.c_str(), uniform.second);
-		}
-		for (const auto& uniform : m_vec2s)
+	void Material::PrepareForRendering()
+	{
+		if (m_shader->GetParameterOwner() != this)
 		{
-			m_shader->SetGlUniformVec2(uniform.first.c_str(), uniform.second);
+			// Another material sharing the shader has set its uniforms since, so all of this material's need setting again
+			for (uint slot = 0; slot < m_parameters.size(); ++slot)
+			{
+				if (m_parameters[slot].type != PARAMETER_UNSET)
+				{
+					UploadParameter(slot);
+				}
+			}
+			m_shader->SetParameterOwner(this);
 		}
-		for (const auto& uniform : m_floats)
+		else
 		{
-			m_shader->SetGlUniformFloat(uniform.first.c_str(), uniform.second);
+			for (UniformSlot slot : m_dirtySlots)
+			{
+				UploadParameter(slot);
+			}
 		}
-		for (const auto& uniform : m_sampler2Ds)
+
+		for (UniformSlot slot : m_dirtySlots)
 		{
-			m_shader->SetGlUniformSampler2D(uniform.first.c_str(), uniform.second);
+			m_parameters[slot].dirty = false;
 		}
-		for (const auto& uniform : m_bools)
+		m_dirtySlots.clear();
+	}
+
+	void Material::ApplyTransformUniforms(const glm::mat4& model)
+	{
+		SetUniformMat4(m_modelMatSlot, model);
+		// Cameras only rotate and translate, so the view's part of the normal matrix is just its rotation, applied in the
+		// shader. The rest doesn't depend on the view, so it's the same in every pass and only a 3x3 inverse
+		SetUniformMat4(m_normalMatSlot, glm::mat4(glm::inverseTranspose(glm::mat3(model))));
+	}
+
+	UniformSlot Material::GetUniformSlot(const char* name) const
+	{
+		UniformSlot slot = m_shader->FindUniformSlot(name);
+		if (slot == NO_UNIFORM)
 		{
-			m_shader->SetGlUniformBool(uniform.first.c_str(), uniform.second);
+			std::cout << "Error: No uniform found with name " << name << ". It may have been optimised out." << std::endl;
 		}
+		return slot;
 	}
 
-	void Material::ApplyTransformUniforms(glm::mat4& model, glm::mat4& view, glm::mat4& proj)
+	void Material::SetUniformMat4(UniformSlot slot, const glm::mat4& value)
 	{
-		SetUniformMat4("modelMat", model);
-		SetUniformMat4("viewMat", view);
-		SetUniformMat4("projMat", proj);
-		SetUniformMat4("projViewMat", proj * view);
-		SetUniformMat4("normalMat", glm::transpose(glm::inverse(view * model)));
+		SetParameter(slot, PARAMETER_MAT4, &value[0][0], sizeof(glm::mat4));
 	}
 
-	void Material::SetUniformMat4(const char* name, glm::mat4 value)
+	void Material::SetUniformVec2(UniformSlot slot, const glm::vec2& value)
 	{
-		m_mat4s[name] = value;
+		SetParameter(slot, PARAMETER_VEC2, &value[0], sizeof(glm::vec2));
 	}
 
-	void Material::SetUniformVec2(const char* name, glm::vec2 value)
+	void Material::SetUniformVec3(UniformSlot slot, const glm::vec3& value)
 	{
-		m_vec2s[name] = value;
+		SetParameter(slot, PARAMETER_VEC3, &value[0], sizeof(glm::vec3));
 	}
 
-	void Material::SetUniformVec3(const char* name, glm::vec3 value)
+	void Material::SetUniformFloat(UniformSlot slot, float value)
 	{
-		m_vec3s[name] = value;
+		SetParameter(slot, PARAMETER_FLOAT, &value, sizeof(float));
 	}
 
-	void Material::SetUniformFloat(const char* name, float value)
+	void Material::SetUniformSampler2D(UniformSlot slot, GLuint value)
 	{
-		m_floats[name] = value;
+		int unit = (int)value;
+		SetParameter(slot, PARAMETER_INT, &unit, sizeof(int));
 	}
 
-	void Material::SetUniformSampler2D(const char* name, GLuint value)
+	void Material::SetUniformBool(UniformSlot slot, bool value)
 	{
-		m_sampler2Ds[name] = value;
+		int flag = value ? 1 : 0;
+		SetParameter(slot, PARAMETER_INT, &flag, sizeof(int));
 	}
 
-	void Material::SetUniformBool(const char* name, bool value)
+	void Material::SetParameter(UniformSlot slot, ParameterType type, const void* value, size_t size)
 	{
-		m_bools[name] = value;
+		if (slot == NO_UNIFORM)
+		{
+			return;
+		}
+
+		Parameter& parameter = m_parameters[slot];
+		if (parameter.type == type && std::memcmp(parameter.value, value, size) == 0)
+		{
+			return;
+		}
+
+		parameter.type = type;
+		std::memcpy(parameter.value, value, size);
+		if (!parameter.dirty)
+		{
+			parameter.dirty = true;
+			m_dirtySlots.push_back(slot);
+		}
+	}
+
+	void Material::UploadParameter(UniformSlot slot) const
+	{
+		const Parameter& parameter = m_parameters[slot];
+		switch (parameter.type)
+		{
+		case PARAMETER_MAT4:
+			m_shader->SetGlUniformMat4(slot, *reinterpret_cast<const glm::mat4*>(parameter.value));
+			break;
+		case PARAMETER_VEC2:
+			m_shader->SetGlUniformVec2(slot, glm::vec2(parameter.value[0], parameter.value[1]));
+			break;
+		case PARAMETER_VEC3:
+			m_shader->SetGlUniformVec3(slot, glm::vec3(parameter.value[0], parameter.value[1], parameter.value[2]));
+			break;
+		case PARAMETER_FLOAT:
+			m_shader->SetGlUniformFloat(slot, parameter.value[0]);
+			break;
+		case PARAMETER_INT:
+		{
+			int value;
+			std::memcpy(&value, parameter.value, sizeof(int));
+			m_shader->SetGlUniformInt(slot, value);
+			break;
+		}
+		default:
+			break;
+		}
 	}
 }
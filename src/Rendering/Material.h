@@ -5,9 +5,10 @@
 
 namespace snes
 {
-	class Camera;
 	class Transform;
 	class Mesh;
+	struct CameraState;
+	struct DrawItem;
 
 	// Derive from this to make your material
 	class Material
@@ -15,30 +16,54 @@ namespace snes
 	public:
 		~Material();
 
-		/** Called before rendering, set uniforms in here */
+		/** Called before rendering, set uniforms in here. Uploads the uniforms that changed since the last call */
 		virtual void PrepareForRendering();
-		virtual void PrepareForRendering(Transform& transform, Camera& camera, Mesh& mesh) { this->PrepareForRendering(); }
+		/** Called before rendering a draw item, for materials whose uniforms depend on where it is drawn */
+		virtual void PrepareForRendering(const DrawItem& item, const CameraState& camera) { this->PrepareForRendering(); }
 
-		/** Set the model, view, and projection uniforms (these must be present in every material shader) */
-		virtual void ApplyTransformUniforms(glm::mat4& model, glm::mat4& view, glm::mat4& proj);
+		/** Set the per-object transform uniforms from a model matrix. The view and projection come from the View uniform
+		  * block (see ViewUniformBuffer), and normalMat is the world-space normal matrix, which shaders rotate into view space */
+		virtual void ApplyTransformUniforms(const glm::mat4& model);
 
 		bool GetUsePatches() { return m_usePatches; }
 
+		/** Make this material's shader the current program. Called by the render queue only when the shader changes */
+		void BindShader() const;
+		ShaderName GetShaderName() const { return m_shaderName; }
+		/** @return an id grouping draws of this material together when sorting, unique among the last 65536 materials made */
+		uint16 GetSortId() const { return m_sortId; }
+
 	public:
 		static std::shared_ptr<Material> CreateMaterial(const char* matPath);
 		static std::shared_ptr<Material> CreateShadowMaterial(const char* matPath);
-		static void ResetCurrentShader() { m_currentShader = NONE; }
 
 	protected:
 		Material(ShaderName shaderName);
 
+		/** Load a texture file and upload it to the GPU
+		  * @return the texture ID, or 0 if it couldn't be loaded or there is no GL context */
+		static GLuint LoadTexture(const char* texturePath);
+
+		/** @return the slot of the uniform with the given name in this material's shader, or NO_UNIFORM (with an error) if
+		  * it has none. Find slots once, e.g. in the constructor, for uniforms set on every draw */
+		UniformSlot GetUniformSlot(const char* name) const;
+
+		/** Set a uniform of the given type in the given slot to the given value. It's uploaded on the next
+		  * PrepareForRendering() only if the value changed */
+		void SetUniformMat4(UniformSlot slot, const glm::mat4& value);
+		void SetUniformVec2(UniformSlot slot, const glm::vec2& value);
+		void SetUniformVec3(UniformSlot slot, const glm::vec3& value);
+		void SetUniformFloat(UniformSlot slot, float value);
+		void SetUniformSampler2D(UniformSlot slot, GLuint value);
+		void SetUniformBool(UniformSlot slot, bool value);
+
 		/** Set a uniform of the given type with the given name to the given value */
-		void SetUniformMat4(const char* name, glm::mat4 value);
-		void SetUniformVec2(const char* name, glm::vec2 value);
-		void SetUniformVec3(const char* name, glm::vec3 value);
-		void SetUniformFloat(const char* name, float value);
-		void SetUniformSampler2D(const char* name, GLuint value);
-		void SetUniformBool(const char* name, bool value);
+		void SetUniformMat4(const char* name, const glm::mat4& value) { SetUniformMat4(GetUniformSlot(name), value); }
+		void SetUniformVec2(const char* name, const glm::vec2& value) { SetUniformVec2(GetUniformSlot(name), value); }
+		void SetUniformVec3(const char* name, const glm::vec3& value) { SetUniformVec3(GetUniformSlot(name), value); }
+		void SetUniformFloat(const char* name, float value) { SetUniformFloat(GetUniformSlot(name), value); }
+		void SetUniformSampler2D(const char* name, GLuint value) { SetUniformSampler2D(GetUniformSlot(name), value); }
+		void SetUniformBool(const char* name, bool value) { SetUniformBool(GetUniformSlot(name), value); }
 
 		bool m_usePatches = false;
 
@@ -47,17 +72,42 @@ namespace snes
 		static std::map<ShaderName, std::weak_ptr<ShaderProgram>> m_shaders;
 
 	private:
+		enum ParameterType : uint8
+		{
+			PARAMETER_UNSET,
+			PARAMETER_MAT4,
+			PARAMETER_VEC2,
+			PARAMETER_VEC3,
+			PARAMETER_FLOAT,
+			PARAMETER_INT
+		};
+
+		/** The value of one uniform, stored flat whatever its type */
+		struct Parameter
+		{
+			ParameterType type = PARAMETER_UNSET;
+			bool dirty = false;
+			float value[16];
+		};
+
+		/** Store a value in a slot, marking it to be uploaded if it differs from the one already there */
+		void SetParameter(UniformSlot slot, ParameterType type, const void* value, size_t size);
+		/** Set the uniform in a slot on the current program to the stored value */
+		void UploadParameter(UniformSlot slot) const;
+
 		ShaderName m_shaderName; 
+		uint16 m_sortId;
 
 		std::shared_ptr<ShaderProgram> m_shader;
 
-		std::map<std::string, glm::vec3> m_vec3s;
-		std::map<std::string, glm::vec2> m_vec2s;
-		std::map<std::string, glm::mat4> m_mat4s;
-		std::map<std::string, float> m_floats;
-		std::map<std::string, GLuint> m_sampler2Ds;
-		std::map<std::string, bool> m_bools;
+		/** One parameter for each of the shader's uniform slots */
+		std::vector<Parameter> m_parameters;
+		/** The slots whose values changed since they were last uploaded */
+		std::vector<UniformSlot> m_dirtySlots;
+
+		UniformSlot m_modelMatSlot;
+		UniformSlot m_normalMatSlot;
 
-		static ShaderName m_currentShader;
+		static uint16 m_nextSortId;
 	};
 }
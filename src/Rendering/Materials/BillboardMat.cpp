@@ -1,18 +1,24 @@
 #include "stdafx.h"
 #include "BillboardMat.h"
-#include <Components\Transform.h>
-#include <SOIL/SOIL.h>
+#include <Rendering\GLState.h>
+#include <Rendering\GraphicsDevice.h>
+#include <Rendering\RenderSnapshot.h>
 
 namespace snes
 {
 	BillboardMat::BillboardMat() : Material(BILLBOARD)
 	{
+		m_centerWorldPosSlot = GetUniformSlot("centerWorldPos");
+		m_worldScaleSlot = GetUniformSlot("worldScale");
 		SetUniformSampler2D("albedo", 0);
 		SetUniformSampler2D("normal", 1);
+		SetUniformBool("useNormalMap", false);
 	}
 
 	BillboardMat::BillboardMat(std::ifstream& params) : Material(BILLBOARD)
 	{
+		m_centerWorldPosSlot = GetUniformSlot("centerWorldPos");
+		m_worldScaleSlot = GetUniformSlot("worldScale");
 		SetUniformSampler2D("albedo", 0);
 		SetUniformSampler2D("normal", 1);
 		std::string line;
@@ -26,24 +32,23 @@ namespace snes
 		// Second line is the path to the texture
 		if (std::getline(params, line))
 		{
-			m_textureID = SOIL_load_OGL_texture(
-				line.c_str(),
-				SOIL_LOAD_AUTO,
-				SOIL_CREATE_NEW_ID,
-				SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
-			);
+			m_textureID = LoadTexture(line.c_str());
+			if (m_textureID != 0)
+			{
+				// Set once here rather than every draw, as the filtering belongs to the texture
+				GLState::BindTexture(0, m_textureID);
+				GLState::SetActiveTextureUnit(0);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			}
 		}
 
 		// Third line is the path to the normal map
 		if (std::getline(params, line))
 		{
-			m_normalTextureID = SOIL_load_OGL_texture(
-				line.c_str(),
-				SOIL_LOAD_AUTO,
-				SOIL_CREATE_NEW_ID,
-				SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
-			);
+			m_normalTextureID = LoadTexture(line.c_str());
 		}
+		SetUniformBool("useNormalMap", m_normalTextureID != 0);
 	}
 
 
@@ -51,20 +56,19 @@ namespace snes
 	{
 	}
 
-	void BillboardMat::PrepareForRendering(Transform& transform, Camera& camera, Mesh& mesh)
+	void BillboardMat::PrepareForRendering(const DrawItem& item, const CameraState& camera)
 	{
-		SetUniformVec3("centerWorldPos", transform.GetWorldPosition());
-		SetUniformVec3("worldScale", transform.GetWorldScale() * m_worldSize);
-		SetUniformBool("useNormalMap", m_normalTextureID != 0);
+		SetUniformVec3(m_centerWorldPosSlot, item.worldPosition);
+		SetUniformVec3(m_worldScaleSlot, item.worldScale * m_worldSize);
 
 		Material::PrepareForRendering();
+		if (!GraphicsDevice::IsAvailable())
+		{
+			return;
+		}
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_textureID);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, m_normalTextureID);
+		GLState::BindTexture(0, m_textureID);
+		GLState::BindTexture(1, m_normalTextureID);
 	}
 
 }
@@ -13,12 +13,16 @@ namespace snes
 		BillboardMat(std::ifstream& params);
 		~BillboardMat();
 
-		void PrepareForRendering(Transform& transform, Camera& camera, Mesh& mesh) override;
+		void PrepareForRendering(const DrawItem& item, const CameraState& camera) override;
 
 	private:
 		GLuint m_textureID = 0;
 		GLuint m_normalTextureID = 0;
 		/** The size of the billboard in world units (before scale) */
 		float m_worldSize;
+
+		/** Slots of the uniforms set on every draw */
+		UniformSlot m_centerWorldPosSlot;
+		UniformSlot m_worldScaleSlot;
 	};
 }
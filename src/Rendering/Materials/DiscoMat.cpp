@@ -66,11 +66,13 @@ namespace snes
 	DiscoMat::DiscoMat() : Material(SOLID_COLOUR)
 	{
 		m_hue = 0;
+		m_colourSlot = GetUniformSlot("colour");
 	}
 
 	DiscoMat::DiscoMat(std::ifstream& /*params*/) : Material(SOLID_COLOUR)
 	{
 		m_hue = 0;
+		m_colourSlot = GetUniformSlot("colour");
 	}
 
 
@@ -80,7 +82,7 @@ namespace snes
 
 	void DiscoMat::PrepareForRendering()
 	{
-		SetUniformVec3("colour", RgbFromHsv(m_hue, 1.0f, 1.0f));
+		SetUniformVec3(m_colourSlot, RgbFromHsv(m_hue, 1.0f, 1.0f));
 		m_hue += FrameTime::GetLastFrameDuration() * 100;
 		if (m_hue > 360.0f)
 		{
@@ -16,5 +16,6 @@ namespace snes
 
 	private:
 		float m_hue;
+		UniformSlot m_colourSlot;
 	};
 }
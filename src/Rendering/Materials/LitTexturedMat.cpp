@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "LitTexturedMat.h"
-#include <SOIL/SOIL.h>
+#include <Rendering\GLState.h>
+#include <Rendering\GraphicsDevice.h>
 
 namespace snes
 {
@@ -16,12 +17,7 @@ namespace snes
 		std::string texturePath;
 		std::getline(params, texturePath);
 
-		m_textureID = SOIL_load_OGL_texture(
-			texturePath.c_str(),
-			SOIL_LOAD_AUTO,
-			SOIL_CREATE_NEW_ID,
-			SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
-		);
+		m_textureID = LoadTexture(texturePath.c_str());
 	}
 
 
@@ -32,17 +28,15 @@ namespace snes
 	void LitTexturedMat::PrepareForRendering()
 	{
 		Material::PrepareForRendering();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_textureID);
+		if (!GraphicsDevice::IsAvailable())
+		{
+			return;
+		}
+		GLState::BindTexture(0, m_textureID);
 	}
 
 	void LitTexturedMat::SetTexture(const char* texturePath)
 	{
-		m_textureID = SOIL_load_OGL_texture(
-			texturePath,
-			SOIL_LOAD_AUTO,
-			SOIL_CREATE_NEW_ID,
-			SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
-		);
+		m_textureID = LoadTexture(texturePath);
 	}
 }
@@ -14,9 +14,4 @@ namespace snes
 	ShadowSolidMat::~ShadowSolidMat()
 	{
 	}
-
-	void ShadowSolidMat::ApplyTransformUniforms(glm::mat4& model, glm::mat4& view, glm::mat4& proj)
-	{
-		SetUniformMat4("depthMVP", proj * view * model);
-	}
 }
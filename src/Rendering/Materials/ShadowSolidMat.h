@@ -12,7 +12,5 @@ namespace snes
 		ShadowSolidMat();
 		ShadowSolidMat(std::ifstream& params);
 		~ShadowSolidMat();
-
-		void ApplyTransformUniforms(glm::mat4& model, glm::mat4& view, glm::mat4& proj) override;
 	};
 }
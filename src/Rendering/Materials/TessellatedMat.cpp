@@ -1,8 +1,9 @@
 #include "stdafx.h"
 #include "TessellatedMat.h"
-#include "Components\Camera.h"
+#include <Rendering\GLState.h>
+#include <Rendering\GraphicsDevice.h>
+#include <Rendering\RenderSnapshot.h>
 #include <Rendering\Mesh.h>
-#include <SOIL/SOIL.h>
 #include <algorithm>
 
 namespace snes
@@ -11,6 +12,9 @@ namespace snes
 
 	TessellatedMat::TessellatedMat() : Material(TESSELLATED_TEXTURED)
 	{
+		m_innerTessLevelSlot = GetUniformSlot("innerTessLevel");
+		m_outerTessLevelSlot = GetUniformSlot("outerTessLevel");
+		m_magnitudeSlot = GetUniformSlot("magnitude");
 		SetUniformSampler2D("tex1", 0);
 		SetUniformSampler2D("dispMap", 1);
 		SetUniformFloat("innerTessLevel", m_maxInnerTessLevel);
@@ -21,6 +25,9 @@ namespace snes
 
 	TessellatedMat::TessellatedMat(std::ifstream& params) : Material(TESSELLATED_TEXTURED)
 	{
+		m_innerTessLevelSlot = GetUniformSlot("innerTessLevel");
+		m_outerTessLevelSlot = GetUniformSlot("outerTessLevel");
+		m_magnitudeSlot = GetUniformSlot("magnitude");
 		SetUniformSampler2D("tex1", 0);
 		SetUniformSampler2D("dispMap", 1);
 		SetUniformFloat("innerTessLevel", m_maxInnerTessLevel);
@@ -49,12 +56,7 @@ namespace snes
 		std::string texturePath;
 		params >> texturePath;
 
-		m_textureID = SOIL_load_OGL_texture(
-			texturePath.c_str(),
-			SOIL_LOAD_AUTO,
-			SOIL_CREATE_NEW_ID,
-			SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
-		);
+		m_textureID = LoadTexture(texturePath.c_str());
 
 		if (params.eof())
 		{
@@ -63,12 +65,7 @@ namespace snes
 
 		params >> texturePath;
 
-		m_dispMapID = SOIL_load_OGL_texture(
-			texturePath.c_str(),
-			SOIL_LOAD_AUTO,
-			SOIL_CREATE_NEW_ID,
-			SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
-		);
+		m_dispMapID = LoadTexture(texturePath.c_str());
 
 		SetUniformBool("hasDispMap", true);
 
@@ -86,67 +83,64 @@ namespace snes
 	{
 	}
 
-	void TessellatedMat::PrepareForRendering(Transform& transform, Camera& camera, Mesh& mesh)
+	void TessellatedMat::PrepareForRendering(const DrawItem& item, const CameraState& camera)
 	{
 		// Toggle for turning tessellation on/off
 		if (m_useTessellation)
 		{
-			float normalizedMeshRadius = std::fmin(1.0f, GetScreenSizeOfMesh(transform, camera, mesh));
+			float normalizedMeshRadius = std::fmin(1.0f, GetScreenSizeOfMesh(item, camera));
 			float pixelMeshRadius = normalizedMeshRadius * 1024.0f / 2.0f;
 			float circleArea = 3.14159f * (pixelMeshRadius * pixelMeshRadius);
-			int pixelsPerPolygon = (int)(circleArea / mesh.GetNumFaces());
+			int pixelsPerPolygon = (int)(circleArea / item.mesh->GetNumFaces());
 			float desiredOuterTessLevel = std::fmax(1.0f, std::fmin(64, sqrt((float)pixelsPerPolygon / m_pixelsPerPolygon)));	// Max tessellation level is 64
 			float desiredInnerTessLevel = std::fmax(1.0f, desiredOuterTessLevel - 1.0f);
 
-			SetUniformFloat("innerTessLevel", std::fmin(m_maxInnerTessLevel, desiredInnerTessLevel));
-			SetUniformFloat("outerTessLevel", std::fmin(m_maxOuterTessLevel, desiredOuterTessLevel));
+			SetUniformFloat(m_innerTessLevelSlot, std::fmin(m_maxInnerTessLevel, desiredInnerTessLevel));
+			SetUniformFloat(m_outerTessLevelSlot, std::fmin(m_maxOuterTessLevel, desiredOuterTessLevel));
 
 			// Adjust displacement amount based on tessellation level
 
 			float tessMultiplier = std::fmax(desiredOuterTessLevel / 64, normalizedMeshRadius);
-			SetUniformFloat("magnitude", m_displacementMagnitude * tessMultiplier);
+			SetUniformFloat(m_magnitudeSlot, m_displacementMagnitude * tessMultiplier);
 		}
 		else
 		{
-			SetUniformFloat("innerTessLevel", 1);
-			SetUniformFloat("outerTessLevel", 1);
+			SetUniformFloat(m_innerTessLevelSlot, 1);
+			SetUniformFloat(m_outerTessLevelSlot, 1);
 		}
 
 		Material::PrepareForRendering();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_textureID);
-		glActiveTexture(GL_TEXTURE1);
+		if (!GraphicsDevice::IsAvailable())
+		{
+			return;
+		}
+		GLState::BindTexture(0, m_textureID);
 		if (m_dispMapID != -1)
 		{
-			glBindTexture(GL_TEXTURE_2D, m_dispMapID);
+			GLState::BindTexture(1, m_dispMapID);
 		}
 		else
 		{
-			glBindTexture(GL_TEXTURE_2D, 0);
+			GLState::BindTexture(1, 0);
 		}
-		glPatchParameteri(GL_PATCH_VERTICES, 3);
+		GLState::SetPatchVertices(3);
 	}
 
 	void TessellatedMat::SetTexture(const char* texturePath)
 	{
-		m_textureID = SOIL_load_OGL_texture(
-			texturePath,
-			SOIL_LOAD_AUTO,
-			SOIL_CREATE_NEW_ID,
-			SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
-		);
+		m_textureID = LoadTexture(texturePath);
 	}
 
-	float TessellatedMat::GetScreenSizeOfMesh(Transform& transform, Camera& camera, Mesh& mesh)
+	float TessellatedMat::GetScreenSizeOfMesh(const DrawItem& item, const CameraState& camera)
 	{
 		//https://stackoverflow.com/questions/21648630/radius-of-projected-sphere-in-screen-space
-		float fovy = camera.GetVerticalFoV();
+		float fovy = camera.verticalFoV;
 		fovy *= 3.14159f / 180;
 
 		// Get the radius of the mesh's encapsulating sphere
-		glm::vec3 worldScale = transform.GetWorldScale();
+		glm::vec3 worldScale = item.worldScale;
 		float maxScale = std::max(std::max(worldScale.x, worldScale.y), worldScale.z);
-		float r = mesh.GetSize() * maxScale / 2.0f;
+		float r = item.mesh->GetSize() * maxScale / 2.0f;
 
 		// Get the distance between the camera and the mesh's origin
 		/** Find distance from camera or distance from reference object? */
@@ -157,10 +151,10 @@ namespace snes
 		//		}
 		//		else
 		{
-			cameraPos = camera.GetTransform().GetWorldPosition();
+			cameraPos = camera.position;
 		}
 
-		float d = glm::length(transform.GetWorldPosition() - cameraPos);
+		float d = glm::length(item.worldPosition - cameraPos);
 		if (r >= d)
 		{
 			return 1.0f;
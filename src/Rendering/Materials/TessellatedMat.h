@@ -13,7 +13,7 @@ namespace snes
 		TessellatedMat(std::ifstream& params);
 		~TessellatedMat();
 		
-		void PrepareForRendering(Transform& transform, Camera& camera, Mesh& mesh) override;
+		void PrepareForRendering(const DrawItem& item, const CameraState& camera) override;
 
 		/** Load the texture for this mesh into OpenGL */
 		void SetTexture(const char* texturePath);
@@ -21,7 +21,7 @@ namespace snes
 		static void ToggleTessellation() { m_useTessellation = !m_useTessellation; }
 
 	private:
-		float GetScreenSizeOfMesh(Transform& transform, Camera& camera, Mesh& mesh);
+		float GetScreenSizeOfMesh(const DrawItem& item, const CameraState& camera);
 
 		GLuint m_textureID = -1;
 		GLuint m_dispMapID = -1;
@@ -30,6 +30,11 @@ namespace snes
 		float m_displacementMagnitude = 1.0f;
 		float m_pixelsPerPolygon = 20;
 
+		/** Slots of the uniforms set on every draw */
+		UniformSlot m_innerTessLevelSlot;
+		UniformSlot m_outerTessLevelSlot;
+		UniformSlot m_magnitudeSlot;
+
 		static bool m_useTessellation;
 	};
 }
@@ -1,7 +1,10 @@
 #include "stdafx.h"
 #include "Mesh.h"
 #include <Core\GameObject.h>
+#include <Core\Profiler.h>
 #include <Components\Transform.h>
+#include "GLState.h"
+#include "GraphicsDevice.h"
 #include <algorithm>
 #include <fstream>
 #include <sstream>
@@ -14,6 +17,7 @@ namespace snes
 	uint Mesh::m_verticesRendered = 0;
 
 	Mesh::Mesh(const char* modelPath)
+		: m_handleId(HandleTable<Mesh>::Register(this))
 	{
 		Load(modelPath);
 	}
@@ -32,7 +36,7 @@ namespace snes
 
 		if (!m_loadedMeshes[modelID])
 		{
-			m_loadedMeshes[modelID] = std::make_shared<Mesh>(Mesh(modelPath));
+			m_loadedMeshes[modelID] = std::shared_ptr<Mesh>(new Mesh(modelPath));
 
 			if (m_loadedMeshes[modelID]->GetVertices().size() == 0)
 			{
@@ -51,6 +55,8 @@ namespace snes
 
 	bool Mesh::Load(const char* modelPath)
 	{
+		PROFILE_FUNCTION();
+
 		/** Load the model file */
 
 		std::ifstream modelFile(modelPath, std::ios::in);
@@ -199,6 +205,20 @@ namespace snes
 			}
 
 			m_numFaces = m_vertices.size() / 3;
+
+			// Find the sphere around every vertex, centred on their bounding box, for culling
+			glm::vec3 minimum = tempVerts[0];
+			glm::vec3 maximum = tempVerts[0];
+			for (const auto& vertex : tempVerts)
+			{
+				minimum = glm::min(minimum, vertex);
+				maximum = glm::max(maximum, vertex);
+			}
+			m_boundsCentre = (minimum + maximum) * 0.5f;
+			for (const auto& vertex : tempVerts)
+			{
+				m_boundsRadius = std::max(m_boundsRadius, glm::length(vertex - m_boundsCentre));
+			}
 		}
 
 		/** UVs */
@@ -255,9 +275,16 @@ namespace snes
 		}*/
 
 		// Create vertex array and buffer objects
-		InitialiseVAO();
-		glBindVertexArray(m_vertexArrayID);
-		InitialiseVBO();
+		if (GraphicsDevice::IsAvailable())
+		{
+			InitialiseVAO();
+			GLState::BindVertexArray(m_vertexArrayID);
+			InitialiseVBO();
+		}
+		else
+		{
+			GraphicsDevice::RecordSkippedUpload(GetVertexDataSize());
+		}
 
 		return true;
 	}
@@ -385,20 +412,31 @@ namespace snes
 		m_texCoords = uvsWithNeighbours;
 		m_normals = normalsWithNeighbours;
 
-		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+		if (!GraphicsDevice::IsAvailable())
+		{
+			GraphicsDevice::RecordSkippedUpload(GetVertexDataSize());
+			return;
+		}
+
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
 		glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(glm::vec3), &m_vertices[0], GL_STATIC_DRAW);
 		if (this->HasUVs())
 		{
-			glBindBuffer(GL_ARRAY_BUFFER, m_uvBufferID);
+			GLState::BindBuffer(GL_ARRAY_BUFFER, m_uvBufferID);
 			glBufferData(GL_ARRAY_BUFFER, m_texCoords.size() * sizeof(glm::vec2), &m_texCoords[0], GL_STATIC_DRAW);
 		}
 		if (this->HasNormals())
 		{
-			glBindBuffer(GL_ARRAY_BUFFER, m_normalBufferID);
+			GLState::BindBuffer(GL_ARRAY_BUFFER, m_normalBufferID);
 			glBufferData(GL_ARRAY_BUFFER, m_normals.size() * sizeof(glm::vec3), &m_normals[0], GL_STATIC_DRAW);
 		}
 	}
 
+	uint64 Mesh::GetVertexDataSize() const
+	{
+		return m_vertices.size() * sizeof(glm::vec3) + m_texCoords.size() * sizeof(glm::vec2) + m_normals.size() * sizeof(glm::vec3);
+	}
+
 	void Mesh::InitialiseVAO()
 	{
 		glGenVertexArrays(1, &m_vertexArrayID);
@@ -409,7 +447,7 @@ namespace snes
 		// Create VBO
 		uint attribID = 0;
 		glGenBuffers(1, &m_vertexBufferID);
-		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
 
 		// Add vertex data to VBO
 		glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(glm::vec3), &m_vertices[0], GL_STATIC_DRAW);
@@ -421,7 +459,7 @@ namespace snes
 		if (this->HasUVs())
 		{
 			glGenBuffers(1, &m_uvBufferID);
-			glBindBuffer(GL_ARRAY_BUFFER, m_uvBufferID);
+			GLState::BindBuffer(GL_ARRAY_BUFFER, m_uvBufferID);
 			glBufferData(GL_ARRAY_BUFFER, m_texCoords.size() * sizeof(glm::vec2), &m_texCoords[0], GL_STATIC_DRAW);
 			glVertexAttribPointer(attribID, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
 			glEnableVertexAttribArray(attribID);
@@ -432,7 +470,7 @@ namespace snes
 		if (this->HasNormals())
 		{
 			glGenBuffers(1, &m_normalBufferID);
-			glBindBuffer(GL_ARRAY_BUFFER, m_normalBufferID);
+			GLState::BindBuffer(GL_ARRAY_BUFFER, m_normalBufferID);
 			glBufferData(GL_ARRAY_BUFFER, m_normals.size() * sizeof(glm::vec3), &m_normals[0], GL_STATIC_DRAW);
 			glVertexAttribPointer(attribID, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
 			glEnableVertexAttribArray(attribID);
@@ -442,14 +480,19 @@ namespace snes
 
 	const void Mesh::PrepareForRendering() const
 	{
-		glBindVertexArray(m_vertexArrayID);
-		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+		GLState::BindVertexArray(m_vertexArrayID);
+	}
+
+	void Mesh::Draw(bool asPatches) const
+	{
+		glDrawArrays(asPatches ? GL_PATCHES : GL_TRIANGLES, 0, GetVertexCount());
 		m_verticesRendered += m_vertices.size();
 	}
 
 	void Mesh::ResetRenderCount()
 	{
 		//std::cout << "Vertices rendered: " << m_verticesRendered << std::endl;
+		PROFILE_COUNTER("Vertices rendered", m_verticesRendered);
 		m_verticesRendered = 0;
 	}
 }
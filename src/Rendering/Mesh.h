@@ -2,6 +2,7 @@
 #include <GL\glew.h>
 #include <glm\vec2.hpp>
 #include <glm\vec3.hpp>
+#include <Core\Handle.h>
 #include <map>
 
 namespace snes
@@ -21,7 +22,15 @@ namespace snes
 	class Mesh
 	{
 	public:
-		~Mesh() {};
+		typedef Mesh HandleBase;
+
+		~Mesh() { HandleTable<Mesh>::Release(m_handleId); };
+
+		Mesh(const Mesh&) = delete;
+		Mesh& operator=(const Mesh&) = delete;
+
+		/** @return the id used to create handles to this mesh */
+		HandleId GetHandleId() const { return m_handleId; }
 
 		/** @return true if the mesh has texture coordinates */
 		bool HasUVs() const { return m_texCoords.size() > 0; }
@@ -40,11 +49,18 @@ namespace snes
 		/** @return the number of vertices in the mesh */
 		uint GetVertexCount() const { return (uint)m_vertices.size();	}
 
+		/** Bind the mesh's vertex array, ready for Draw() */
 		const void PrepareForRendering() const;
+		/** Draw the whole mesh from the bound vertex array, as patches for tessellation or as triangles */
+		void Draw(bool asPatches) const;
 
 		int GetNumFaces() { return m_numFaces; }
 		/** @return the "diameter" of the sphere that would encapsulate the object*/
 		float GetSize() { return m_size; }
+		/** @return the centre of the sphere enclosing every vertex, in model space */
+		const glm::vec3& GetBoundsCentre() const { return m_boundsCentre; }
+		/** @return the radius of the sphere enclosing every vertex, in model space */
+		float GetBoundsRadius() const { return m_boundsRadius; }
 
 		/** Generate neighbour data for each face */
 		void GenNeighbourData();
@@ -57,6 +73,9 @@ namespace snes
 		static void ResetRenderCount();
 
 	private:
+		/** Loads meshes directly, bypassing the cache */
+		friend class MicroBenchmark;
+
 		Mesh(const char* modelPath);
 
 		/** Load the given mesh */
@@ -71,6 +90,9 @@ namespace snes
 	private:
 		uint GetFaceAttributeCount(std::string face);
 
+		/** @return the size of the vertex buffers this mesh uploads, in bytes */
+		uint64 GetVertexDataSize() const;
+
 		void InitialiseVAO();
 		void InitialiseVBO();
 
@@ -80,11 +102,17 @@ namespace snes
 		uint m_numFaces;
 		/** Distance between the two furthest vertices */
 		float m_size;
+		/** The sphere enclosing every vertex, centred on the middle of their bounding box */
+		glm::vec3 m_boundsCentre = glm::vec3(0.0f);
+		float m_boundsRadius = 0.0f;
 
 		GLuint m_vertexArrayID = -1;
 		GLuint m_vertexBufferID = -1;
 		GLuint m_uvBufferID = -1;
 		GLuint m_normalBufferID = -1;
 		GLuint m_textureID = 0;
+
+		/** This mesh's slot in the Mesh handle table */
+		HandleId m_handleId;
 	};
 }
@@ -0,0 +1,197 @@
+#include "stdafx.h"
+#include "RenderQueue.h"
+#include "GLState.h"
+#include "Material.h"
+#include "Mesh.h"
+#include <Core\Profiler.h>
+#include <cstring>
+
+namespace snes
+{
+	constexpr uint RenderQueue::PASS_SHIFT;
+	constexpr uint RenderQueue::SHADER_SHIFT;
+	constexpr uint RenderQueue::MATERIAL_SHIFT;
+	constexpr uint RenderQueue::MESH_SHIFT;
+	constexpr uint RenderQueue::DEPTH_BITS;
+	constexpr uint RenderQueue::CULLING_PLANES;
+
+	void RenderQueue::Build(const RenderSnapshot& snapshot, RenderPass pass, const CameraState& camera)
+	{
+		m_pass = pass;
+		m_commands.clear();
+		m_culledCount = 0;
+
+		// Shadow casters outside the sides or beyond the far plane can't shade anything the shadow map covers.
+		// Those in front of the near plane still can, so they're kept and the shadow pass clamps their depth
+		const bool cull = pass == RENDER_PASS_SHADOW || pass == RENDER_PASS_STATIC_SHADOW;
+		glm::vec4 planes[CULLING_PLANES];
+		if (cull)
+		{
+			GetCullingPlanes(camera.proj * camera.view, planes);
+		}
+
+		for (uint32 i = 0; i < snapshot.items.size(); ++i)
+		{
+			const DrawItem& item = snapshot.items[i];
+			if (cull && item.isStatic != (pass == RENDER_PASS_STATIC_SHADOW))
+			{
+				continue;
+			}
+			if (cull && IsOutside(item.boundsCentre, item.boundsRadius, planes))
+			{
+				++m_culledCount;
+				continue;
+			}
+
+			float viewDepth = -(camera.view * glm::vec4(item.worldPosition, 1.0f)).z;
+			m_commands.push_back(RenderCommand{ MakeKey(pass, *item.material, *item.mesh, viewDepth), i });
+		}
+	}
+
+	void RenderQueue::Sort()
+	{
+		RadixSort(m_commands, m_scratch);
+	}
+
+	void RenderQueue::Execute(const RenderSnapshot& snapshot, const CameraState& camera) const
+	{
+		uint shaderChanges = 0;
+		uint meshChanges = 0;
+		uint8 currentShader = NONE;
+		const Mesh* currentMesh = nullptr;
+
+		for (const RenderCommand& command : m_commands)
+		{
+			const DrawItem& item = snapshot.items[command.item];
+
+			uint8 shader = GetKeyShader(command.key);
+			if (shader != currentShader)
+			{
+				item.material->BindShader();
+				currentShader = shader;
+				++shaderChanges;
+			}
+
+			// Compared by pointer rather than key, as mesh ids can share their low 16 bits
+			if (item.mesh.get() != currentMesh)
+			{
+				item.mesh->PrepareForRendering();
+				currentMesh = item.mesh.get();
+				++meshChanges;
+			}
+
+			item.Draw(camera);
+		}
+		// Items may leave stippling on, which nothing after the pass expects
+		GLState::SetEnabled(GL_POLYGON_STIPPLE, false);
+
+		static const char* SHADER_COUNTERS[RENDER_PASS_COUNT] = { "Static shadow pass shader changes", "Shadow pass shader changes",
+			"Geometry pass shader changes" };
+		static const char* MESH_COUNTERS[RENDER_PASS_COUNT] = { "Static shadow pass mesh changes", "Shadow pass mesh changes",
+			"Geometry pass mesh changes" };
+		PROFILE_COUNTER(SHADER_COUNTERS[m_pass], shaderChanges);
+		PROFILE_COUNTER(MESH_COUNTERS[m_pass], meshChanges);
+	}
+
+	uint64 RenderQueue::MakeKey(RenderPass pass, const Material& material, const Mesh& mesh, float viewDepth)
+	{
+		// Positive floats order the same as their bit patterns, so the top bits after the sign are a coarse depth.
+		// Anything behind the camera sorts first
+		uint32 depthBits = 0;
+		if (viewDepth > 0.0f)
+		{
+			std::memcpy(&depthBits, &viewDepth, sizeof(depthBits));
+			depthBits >>= 31 - DEPTH_BITS;
+		}
+
+		return ((uint64)pass << PASS_SHIFT)
+			| ((uint64)(uint8)material.GetShaderName() << SHADER_SHIFT)
+			| ((uint64)material.GetSortId() << MATERIAL_SHIFT)
+			| ((uint64)(mesh.GetHandleId().index & 0xFFFF) << MESH_SHIFT)
+			| depthBits;
+	}
+
+	void RenderQueue::GetCullingPlanes(const glm::mat4& projView, glm::vec4 outPlanes[CULLING_PLANES])
+	{
+		// Each plane is the last row of the matrix plus or minus another (Gribb & Hartmann), with its normal facing inwards
+		glm::vec4 rows[4];
+		for (uint row = 0; row < 4; ++row)
+		{
+			rows[row] = glm::vec4(projView[0][row], projView[1][row], projView[2][row], projView[3][row]);
+		}
+		outPlanes[0] = rows[3] + rows[0];	// Left
+		outPlanes[1] = rows[3] - rows[0];	// Right
+		outPlanes[2] = rows[3] + rows[1];	// Bottom
+		outPlanes[3] = rows[3] - rows[1];	// Top
+		outPlanes[4] = rows[3] - rows[2];	// Far
+		for (uint plane = 0; plane < CULLING_PLANES; ++plane)
+		{
+			outPlanes[plane] /= glm::length(glm::vec3(outPlanes[plane]));
+		}
+	}
+
+	bool RenderQueue::IsOutside(const glm::vec3& centre, float radius, const glm::vec4 planes[CULLING_PLANES])
+	{
+		for (uint plane = 0; plane < CULLING_PLANES; ++plane)
+		{
+			if (glm::dot(glm::vec3(planes[plane]), centre) + planes[plane].w < -radius)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void RenderQueue::RadixSort(std::vector<RenderCommand>& commands, std::vector<RenderCommand>& scratch)
+	{
+		const uint DIGITS = 8;
+		const size_t count = commands.size();
+		if (count < 2)
+		{
+			return;
+		}
+		scratch.resize(count);
+
+		// Count every digit in one read of the keys
+		uint32 histograms[DIGITS][256] = {};
+		for (const RenderCommand& command : commands)
+		{
+			for (uint digit = 0; digit < DIGITS; ++digit)
+			{
+				++histograms[digit][(command.key >> (digit * 8)) & 0xFF];
+			}
+		}
+
+		RenderCommand* source = commands.data();
+		RenderCommand* destination = scratch.data();
+		for (uint digit = 0; digit < DIGITS; ++digit)
+		{
+			uint32* histogram = histograms[digit];
+
+			// Every key has the same value for this digit, so this pass wouldn't move anything
+			if (histogram[(source[0].key >> (digit * 8)) & 0xFF] == count)
+			{
+				continue;
+			}
+
+			uint32 offset = 0;
+			for (uint bucket = 0; bucket < 256; ++bucket)
+			{
+				uint32 bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				destination[histogram[(source[i].key >> (digit * 8)) & 0xFF]++] = source[i];
+			}
+			std::swap(source, destination);
+		}
+
+		if (source != commands.data())
+		{
+			commands.swap(scratch);
+		}
+	}
+}
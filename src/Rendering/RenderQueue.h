@@ -0,0 +1,78 @@
+#pragma once
+#include "RenderSnapshot.h"
+
+namespace snes
+{
+	enum RenderPass : uint8
+	{
+		/** Shadows of static items, drawn into the cached shadow maps */
+		RENDER_PASS_STATIC_SHADOW,
+		/** Shadows of everything else, drawn every frame */
+		RENDER_PASS_SHADOW,
+		RENDER_PASS_GEOMETRY,
+		RENDER_PASS_COUNT
+	};
+
+	/** One draw in a render queue: where it sorts, and which of the snapshot's draw items it draws */
+	struct RenderCommand
+	{
+		uint64 key;
+		uint32 item;
+	};
+
+	/** Render Queue
+	  * Orders one pass of a snapshot's draw items by a 64-bit sort key, then draws them changing GL state only when
+	  * the part of the key it depends on changes. Draw order no longer depends on where objects sit in the hierarchy.
+	  *
+	  * Key layout, from the most significant bit:
+	  *   pass (4 bits) | shader (8) | material (16) | mesh (16) | view depth (20)
+	  * so items sharing a shader are drawn together, then those sharing a material and mesh, then nearest first. */
+	class RenderQueue
+	{
+	public:
+		/** Fill the queue with a key for every item in the snapshot, as seen from a camera in a pass.
+		  * The shadow passes leave out items whose bounds are outside the camera's sides or beyond its far plane,
+		  * and each only takes the items on its own side of static or not */
+		void Build(const RenderSnapshot& snapshot, RenderPass pass, const CameraState& camera);
+
+		/** Sort the queue by key */
+		void Sort();
+
+		/** Draw every item in the queue in order, as seen from the camera it was built with */
+		void Execute(const RenderSnapshot& snapshot, const CameraState& camera) const;
+
+		const std::vector<RenderCommand>& GetCommands() const { return m_commands; }
+		/** @return the number of items the last Build() left out */
+		uint GetCulledCount() const { return m_culledCount; }
+
+	public:
+		/** @return the sort key for drawing a mesh with a material at a view-space depth in a pass */
+		static uint64 MakeKey(RenderPass pass, const Material& material, const Mesh& mesh, float viewDepth);
+
+		/** @return the shader bits of a key */
+		static uint8 GetKeyShader(uint64 key) { return (uint8)(key >> SHADER_SHIFT); }
+
+		/** Sort commands by key with a least significant digit radix sort, using scratch as working space
+		  * Digits every key shares are skipped, so a single pass with a few shaders only sorts the bits that differ */
+		static void RadixSort(std::vector<RenderCommand>& commands, std::vector<RenderCommand>& scratch);
+
+		/** The side and far planes of a view, which shadow casters are culled against */
+		static constexpr uint CULLING_PLANES = 5;
+		/** Find the side and far planes of a projection and view, normalised with their normals facing inwards */
+		static void GetCullingPlanes(const glm::mat4& projView, glm::vec4 outPlanes[CULLING_PLANES]);
+		/** @return true if a sphere is entirely outside any of the planes */
+		static bool IsOutside(const glm::vec3& centre, float radius, const glm::vec4 planes[CULLING_PLANES]);
+
+	private:
+		static constexpr uint PASS_SHIFT = 60;
+		static constexpr uint SHADER_SHIFT = 52;
+		static constexpr uint MATERIAL_SHIFT = 36;
+		static constexpr uint MESH_SHIFT = 20;
+		static constexpr uint DEPTH_BITS = 20;
+
+		RenderPass m_pass = RENDER_PASS_GEOMETRY;
+		uint m_culledCount = 0;
+		std::vector<RenderCommand> m_commands;
+		std::vector<RenderCommand> m_scratch;
+	};
+}
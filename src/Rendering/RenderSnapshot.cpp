@@ -0,0 +1,184 @@
+#include "stdafx.h"
+#include "RenderSnapshot.h"
+#include "GLState.h"
+#include "Material.h"
+#include "Mesh.h"
+#include <Components\Camera.h>
+#include <Components\Transform.h>
+#include <Core\GameObject.h>
+#include <GL/glew.h>
+#include <algorithm>
+
+namespace snes
+{
+	/** 4x4 ordered dithering thresholds, tiled into 32x32 polygon stipple patterns */
+	static const float STIPPLE_PATTERN[16] = {
+		1.0f/17.0f,  9.0f/17.0f,  3.0f/17.0f,  11.0f/17.0f,
+		13.0f/17.0f, 5.0f/17.0f,  15.0f/17.0f, 7.0f/17.0f,
+		4.0f/17.0f,  12.0f/17.0f, 2.0f/17.0f,  10.0f/17.0f,
+		16.0f/17.0f, 8.0f/17.0f,  14.0f/17.0f, 6.0f/17.0f
+	};
+
+	/** Generate a stipple pattern between 0 (invisible) and 1 (visible) */
+	static void GenerateStipplePattern(float opacity, GLubyte patternOut[128])
+	{
+		// Generate a 32x32 stipple pattern from the 4x4 ordered dithering pattern and opacity
+		for (int l = 0; l < 8; l++)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				for (int i = 0; i < 4; i++)
+				{
+					GLubyte eightBits = 0;
+					for (int j = 0; j < 4; j++)
+					{
+						if (opacity > STIPPLE_PATTERN[(4 * k) + j])
+						{
+							eightBits = eightBits | (1 << j);
+							eightBits = eightBits | (1 << (j + 4));
+						}
+					}
+					patternOut[(16 * l) + (4 * k) + i] = eightBits;
+				}
+			}
+		}
+	}
+
+	static void InvertStipplePattern(GLubyte patternOut[128])
+	{
+		// Invert the bits of the stipple pattern
+		for (int i = 0; i < 128; i++)
+		{
+			patternOut[i] = patternOut[i] ^ 255;
+		}
+	}
+
+	CameraState CameraState::Capture(Camera& camera)
+	{
+		CameraState state;
+		state.view = camera.GetViewMatrix();
+		state.proj = camera.GetProjMatrix();
+		state.position = camera.GetTransform().GetWorldPosition();
+		state.rotation = camera.GetTransform().GetWorldRotation();
+		state.verticalFoV = camera.GetVerticalFoV();
+		state.mouseLook = camera.GetMouseLookSensitivity();
+		return state;
+	}
+
+	CameraState CameraState::WithMouseLook(const glm::vec2& mouseOffset) const
+	{
+		CameraState state = *this;
+		state.rotation.x = glm::clamp(rotation.x - mouseOffset.y * mouseLook.y, -89.0f, 89.0f);
+		state.rotation.y = rotation.y + mouseOffset.x * mouseLook.x;
+		state.view = Camera::CalculateViewMatrix(position, state.rotation);
+		return state;
+	}
+
+	void DrawItem::Draw(const CameraState& camera) const
+	{
+		// Set up uniforms. The camera's are already in the view uniform buffer
+		material->ApplyTransformUniforms(model);
+		material->PrepareForRendering(*this, useLodCamera ? lodCamera : camera);
+
+		// Stippling stays enabled between stippled items, so it's only switched when moving to or from one
+		GLState::SetEnabled(GL_POLYGON_STIPPLE, stippled);
+		if (stippled)
+		{
+			GLubyte pattern[128];
+			GenerateStipplePattern(stippleOpacity, pattern);
+			if (invertStipple)
+			{
+				// The inverted pattern lets a mesh fade out while another fades in, keeping the object as a whole opaque
+				InvertStipplePattern(pattern);
+			}
+			GLState::SetPolygonStipple(pattern);
+		}
+
+		// Draw the mesh
+		mesh->Draw(material->GetUsePatches());
+	}
+
+	void RenderSnapshot::Clear()
+	{
+		frame = 0;
+		inputSequence = 0;
+		mouseTravel = glm::ivec2(0);
+		pointLights.clear();
+		items.clear();
+		staticItemHash = 0;
+		wireframe = false;
+	}
+
+	DrawItem& RenderSnapshot::AddItem(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Material>& material, Transform& transform)
+	{
+		items.emplace_back();
+		DrawItem& item = items.back();
+		item.mesh = mesh;
+		item.material = material;
+		item.model = transform.GetRenderMatrix();
+		item.worldPosition = transform.GetWorldPosition();
+		item.worldScale = transform.GetWorldScale();
+
+		// The model matrix may scale unevenly, so the radius grows by its largest axis scale
+		glm::vec3 axisScales(glm::length(glm::vec3(item.model[0])), glm::length(glm::vec3(item.model[1])), glm::length(glm::vec3(item.model[2])));
+		item.boundsCentre = glm::vec3(item.model * glm::vec4(mesh->GetBoundsCentre(), 1.0f));
+		item.boundsRadius = mesh->GetBoundsRadius() * std::max(std::max(axisScales.x, axisScales.y), axisScales.z);
+		item.isStatic = transform.GetGameObject().IsStatic();
+		return item;
+	}
+
+	uint64 RenderSnapshot::HashStaticItems() const
+	{
+		// FNV-1a over the bytes of each static item's mesh, matrix and stippling
+		uint64 hash = 14695981039346656037ull;
+		auto add = [&hash](const void* data, size_t size)
+		{
+			const uint8* bytes = (const uint8*)data;
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			}
+		};
+
+		for (const DrawItem& item : items)
+		{
+			if (!item.isStatic)
+			{
+				continue;
+			}
+			const Mesh* mesh = item.mesh.get();
+			add(&mesh, sizeof(mesh));
+			add(&item.model, sizeof(item.model));
+			float stipple = item.stippled ? (item.invertStipple ? -item.stippleOpacity : item.stippleOpacity) : 2.0f;
+			add(&stipple, sizeof(stipple));
+		}
+		return hash;
+	}
+
+	void RenderSnapshotBuffer::Publish()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			uint8 previous = m_readyIndex.exchange(m_writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+			m_writeIndex = previous & ~FRESH_BIT;
+		}
+		m_published.notify_one();
+	}
+
+	const RenderSnapshot& RenderSnapshotBuffer::GetReadSnapshot()
+	{
+		if (m_readyIndex.load(std::memory_order_acquire) & FRESH_BIT)
+		{
+			// Hand back the snapshot just drawn and take the new one
+			uint8 ready = m_readyIndex.exchange(m_readIndex, std::memory_order_acq_rel);
+			m_readIndex = ready & ~FRESH_BIT;
+		}
+		return m_snapshots[m_readIndex];
+	}
+
+	bool RenderSnapshotBuffer::WaitForSnapshot(std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		return m_published.wait_for(lock, timeout, [this]() { return (m_readyIndex.load(std::memory_order_acquire) & FRESH_BIT) != 0; });
+	}
+}
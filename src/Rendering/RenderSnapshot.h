@@ -0,0 +1,157 @@
+#pragma once
+#include <glm\glm.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace snes
+{
+	class Camera;
+	class Material;
+	class Mesh;
+	class Transform;
+
+	/** A camera's view as of the end of a frame's logic */
+	struct CameraState
+	{
+		glm::mat4 view = glm::mat4(1.0f);
+		glm::mat4 proj = glm::mat4(1.0f);
+		glm::vec3 position = glm::vec3(0.0f);
+		/** World rotation in euler angles (degrees) */
+		glm::vec3 rotation = glm::vec3(0.0f);
+		float verticalFoV = 0.0f;
+		/** Degrees turned per pixel of mouse movement, or zero if the mouse doesn't turn this camera */
+		glm::vec2 mouseLook = glm::vec2(0.0f);
+
+		/** @return the current state of a camera */
+		static CameraState Capture(Camera& camera);
+
+		/** @return this state turned by mouse movement the simulation hasn't seen yet, the same way the camera itself would turn */
+		CameraState WithMouseLook(const glm::vec2& mouseOffset) const;
+	};
+
+	struct PointLightState
+	{
+		glm::vec3 position;
+		glm::vec3 colour;
+		float linearAttenuation;
+		float quadraticAttenuation;
+	};
+
+	struct DirectionalLightState
+	{
+		/** The light's camera. Shadow cascades look the same way, fitted around the main camera's view (see ShadowCascades) */
+		CameraState camera;
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 rotation = glm::vec3(0.0f);
+		glm::vec3 colour = glm::vec3(1.0f);
+	};
+
+	/** Draw Item
+	  * One mesh to draw, with everything the draw needs copied out of the scene.
+	  * The mesh and material are shared, so they stay alive while the item is waiting to be drawn. */
+	struct DrawItem
+	{
+		std::shared_ptr<Mesh> mesh;
+		std::shared_ptr<Material> material;
+		/** The interpolated world matrix to draw with */
+		glm::mat4 model;
+		glm::vec3 worldPosition;
+		glm::vec3 worldScale;
+		/** The world-space sphere enclosing the mesh, for culling */
+		glm::vec3 boundsCentre = glm::vec3(0.0f);
+		float boundsRadius = 0.0f;
+		/** Drawn for a GameObject marked static, so its shadow is drawn into the cached shadow maps rather than every frame */
+		bool isStatic = false;
+
+		/** Draw with an ordered-dither stipple pattern at this opacity (e.g. while fading between LODs) */
+		bool stippled = false;
+		float stippleOpacity = 1.0f;
+		/** Draw the pixels the pattern would leave out instead, so two items can cross-fade */
+		bool invertStipple = false;
+
+		/** Prepare the material as seen from lodCamera rather than the camera drawing it, so detail chosen from screen size
+		  * (e.g. tessellation) follows the camera an LODModel measures from */
+		bool useLodCamera = false;
+		CameraState lodCamera;
+
+		/** Issue the GL calls for this item, as seen from a camera. Its material's shader, its mesh and the camera's view
+		  * uniforms (see ViewUniformBuffer) must already be bound */
+		void Draw(const CameraState& camera) const;
+	};
+
+	/** Render Snapshot
+	  * Everything needed to draw one frame: cameras, lights and draw items.
+	  * Filled in by the simulation at the end of a frame's logic, then only read while it's drawn,
+	  * so the next frame's logic can run while this one is submitted. */
+	class RenderSnapshot
+	{
+	public:
+		/** Empty the snapshot, keeping its storage for the next frame */
+		void Clear();
+
+		/** Add a draw of a mesh with a transform's current render matrix
+		  * @return the item, so its stipple settings can be changed */
+		DrawItem& AddItem(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Material>& material, Transform& transform);
+
+		/** @return a hash of everything about the static items that shows in their shadows, which changes when any of them
+		  * moves, changes mesh or stippling, or is added or removed */
+		uint64 HashStaticItems() const;
+
+		/** The number of the frame this snapshot was captured on, or 0 if it has never been filled in */
+		uint64 frame = 0;
+		/** The sequence number of the last input event the simulation had applied when this was captured */
+		uint64 inputSequence = 0;
+		/** Input::GetProcessedMouseTravel() when this was captured, to work out the mouse movement it doesn't show */
+		glm::ivec2 mouseTravel = glm::ivec2(0);
+		/** Seconds of simulation run when this was captured */
+		float time = 0.0f;
+
+		CameraState camera;
+		DirectionalLightState directionalLight;
+		std::vector<PointLightState> pointLights;
+		std::vector<DrawItem> items;
+		/** HashStaticItems() as of when this was captured */
+		uint64 staticItemHash = 0;
+
+		/** Draw the geometry pass in wireframe */
+		bool wireframe = false;
+	};
+
+	/** Render Snapshot Buffer
+	  * Triple buffer passing snapshots from the simulation to the renderer without either waiting on the other.
+	  * The simulation always has a snapshot to write, the renderer always has the newest complete one to read,
+	  * and the third holds whichever was published last until one side swaps it out. */
+	class RenderSnapshotBuffer
+	{
+	public:
+		/** @return the snapshot to fill in for the next frame. Only called from the simulation */
+		RenderSnapshot& GetWriteSnapshot() { return m_snapshots[m_writeIndex]; }
+
+		/** Make the snapshot returned by GetWriteSnapshot() the latest one, and wake the renderer if it's waiting */
+		void Publish();
+
+		/** @return the newest published snapshot, which stays valid until the next call. Only called from the renderer */
+		const RenderSnapshot& GetReadSnapshot();
+
+		/** Wait until a snapshot newer than the one last read is published
+		  * @return false if the timeout passed first */
+		bool WaitForSnapshot(std::chrono::milliseconds timeout);
+
+	private:
+		/** Set on the ready index when it holds a snapshot the renderer hasn't read yet */
+		static constexpr uint8 FRESH_BIT = 0x4;
+
+		RenderSnapshot m_snapshots[3];
+		/** Only touched by the simulation */
+		uint8 m_writeIndex = 0;
+		/** Swapped by both sides */
+		std::atomic<uint8> m_readyIndex{ 1 };
+		/** Only touched by the renderer */
+		uint8 m_readIndex = 2;
+
+		std::mutex m_mutex;
+		std::condition_variable m_published;
+	};
+}
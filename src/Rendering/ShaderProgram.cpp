@@ -1,5 +1,7 @@
 #include "stdafx.h"
 #include "ShaderProgram.h"
+#include "GLState.h"
+#include "GraphicsDevice.h"
 #include <fstream>
 #include <sstream>
 
@@ -7,12 +9,19 @@ namespace snes
 {
 	ShaderProgram::~ShaderProgram()
 	{
-		glDeleteShader(m_programID);
+		if (m_programID != 0)
+		{
+			glDeleteShader(m_programID);
+		}
 	}
 
 	bool ShaderProgram::SetGlUniformMat4(const char* name, const glm::mat4& value)
 	{
 		GLuint position = FindUniformPositionFromName(name);
+		if (m_programID == 0)
+		{
+			return false;
+		}
 		glUniformMatrix4fv(position, 1, GL_FALSE, &value[0][0]);
 		return true;
 	}
@@ -20,6 +29,10 @@ namespace snes
 	bool ShaderProgram::SetGlUniformVec3(const char* name, const glm::vec3& value)
 	{
 		GLuint position = FindUniformPositionFromName(name);
+		if (m_programID == 0)
+		{
+			return false;
+		}
 		glUniform3f(position, value.x, value.y, value.z);
 		return true;
 	}
@@ -27,6 +40,10 @@ namespace snes
 	bool ShaderProgram::SetGlUniformVec2(const char* name, const glm::vec2& value)
 	{
 		GLuint position = FindUniformPositionFromName(name);
+		if (m_programID == 0)
+		{
+			return false;
+		}
 		glUniform2f(position, value.x, value.y);
 		return true;
 	}
@@ -34,6 +51,10 @@ namespace snes
 	bool ShaderProgram::SetGlUniformFloat(const char* name, float value)
 	{
 		GLuint position = FindUniformPositionFromName(name);
+		if (m_programID == 0)
+		{
+			return false;
+		}
 		glUniform1f(position, value);
 		return true;
 	}
@@ -41,6 +62,10 @@ namespace snes
 	bool ShaderProgram::SetGlUniformInt(const char* name, int value)
 	{
 		GLuint position = FindUniformPositionFromName(name);
+		if (m_programID == 0)
+		{
+			return false;
+		}
 		glUniform1i(position, value);
 		return true;
 	}
@@ -48,6 +73,10 @@ namespace snes
 	bool ShaderProgram::SetGlUniformSampler2D(const char* name, GLuint value)
 	{
 		GLuint position = FindUniformPositionFromName(name);
+		if (m_programID == 0)
+		{
+			return false;
+		}
 		glUniform1i(position, value);
 		return true;
 	}
@@ -55,10 +84,82 @@ namespace snes
 	bool ShaderProgram::SetGlUniformBool(const char* name, bool value)
 	{
 		GLuint position = FindUniformPositionFromName(name);
+		if (m_programID == 0)
+		{
+			return false;
+		}
 		glUniform1i(position, value);
 		return true;
 	}
 
+	UniformSlot ShaderProgram::FindUniformSlot(const char* name) const
+	{
+		for (uint i = 0; i < m_uniforms.size(); ++i)
+		{
+			if (m_uniforms[i].m_name == name)
+			{
+				return (UniformSlot)i;
+			}
+		}
+		return NO_UNIFORM;
+	}
+
+	void ShaderProgram::SetGlUniformMat4(UniformSlot slot, const glm::mat4& value)
+	{
+		if (slot != NO_UNIFORM && m_programID != 0)
+		{
+			glUniformMatrix4fv(m_uniforms[slot].m_position, 1, GL_FALSE, &value[0][0]);
+		}
+	}
+
+	void ShaderProgram::SetGlUniformVec2(UniformSlot slot, const glm::vec2& value)
+	{
+		if (slot != NO_UNIFORM && m_programID != 0)
+		{
+			glUniform2f(m_uniforms[slot].m_position, value.x, value.y);
+		}
+	}
+
+	void ShaderProgram::SetGlUniformVec3(UniformSlot slot, const glm::vec3& value)
+	{
+		if (slot != NO_UNIFORM && m_programID != 0)
+		{
+			glUniform3f(m_uniforms[slot].m_position, value.x, value.y, value.z);
+		}
+	}
+
+	void ShaderProgram::SetGlUniformFloat(UniformSlot slot, float value)
+	{
+		if (slot != NO_UNIFORM && m_programID != 0)
+		{
+			glUniform1f(m_uniforms[slot].m_position, value);
+		}
+	}
+
+	void ShaderProgram::SetGlUniformInt(UniformSlot slot, int value)
+	{
+		if (slot != NO_UNIFORM && m_programID != 0)
+		{
+			glUniform1i(m_uniforms[slot].m_position, value);
+		}
+	}
+
+	void ShaderProgram::SetGlUniformMat4Array(UniformSlot slot, const glm::mat4* values, uint count)
+	{
+		if (slot != NO_UNIFORM && m_programID != 0)
+		{
+			glUniformMatrix4fv(m_uniforms[slot].m_position, count, GL_FALSE, &values[0][0][0]);
+		}
+	}
+
+	void ShaderProgram::SetGlUniformFloatArray(UniformSlot slot, const float* values, uint count)
+	{
+		if (slot != NO_UNIFORM && m_programID != 0)
+		{
+			glUniform1fv(m_uniforms[slot].m_position, count, values);
+		}
+	}
+
 	GLuint ShaderProgram::FindUniformPositionFromName(const char* name)
 	{
 		// If it's part of an array, find it manually
@@ -66,6 +167,11 @@ namespace snes
 		GLuint pos = -1;
 		if (nameStr.find('[') != std::string::npos)
 		{
+			// Array elements aren't in the uniform list, so they can only be found in a linked program
+			if (m_programID == 0)
+			{
+				return pos;
+			}
 			pos = glGetUniformLocation(m_programID, name);
 			if (pos != -1)
 			{
@@ -126,6 +232,17 @@ namespace snes
 		// Get file paths from shader name
 		// Load shaders (see MeshRenderer.cpp)
 		std::string filePath = GetShaderFilePaths(shaderName);
+
+		// Without a GL context, only read the sources so the uniform list is still known
+		if (!GraphicsDevice::IsAvailable())
+		{
+			LoadShaderFromFile((filePath + ".vs").c_str());
+			LoadShaderFromFile((filePath + ".fs").c_str());
+			LoadShaderFromFile((filePath + ".tcs").c_str());
+			LoadShaderFromFile((filePath + ".tes").c_str());
+			GraphicsDevice::RecordSkippedShader();
+			return 0;
+		}
 		
 		// Create the shaders
 		GLuint vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
@@ -235,7 +352,7 @@ namespace snes
 			glDeleteShader(geometryShaderID);
 		}
 
-		glUseProgram(m_programID);
+		GLState::UseProgram(m_programID);
 
 		// Find and store uniform locations
 		RetrieveUniformLocations();
@@ -321,6 +438,15 @@ namespace snes
 				std::getline(lineStream, name, ';');
 			}
 
+			// An array is found by its bare name, which locates its first element
+			name = name.substr(0, name.find('['));
+
+			// Uniforms shared between stages (e.g. the vertex and tessellation shaders) only need one slot
+			if (FindUniformSlot(name.c_str()) != NO_UNIFORM)
+			{
+				return;
+			}
+
 			// Create the ShaderUniform
 			ShaderUniform uniform;
 			uniform.m_name = name;
@@ -28,6 +28,13 @@ namespace snes
 		std::string m_name;
 	};
 
+	/** The index of a uniform in a shader program, found once by name so it can be set without searching */
+	typedef int UniformSlot;
+	/** The slot of a uniform the program doesn't declare. Setting it does nothing */
+	const UniformSlot NO_UNIFORM = -1;
+
+	class Material;
+
 	/** Shader Program
 	  * Loads and compiles a shader.
 	  * Uniforms can be set through this object, with error checking. */
@@ -39,7 +46,7 @@ namespace snes
 		~ShaderProgram();
 
 		/** Set the value of the uniform with the given name
-		  * @return true if successful */
+		  * @return true if successful, or false if there is no program to set it on (e.g. it failed to compile, or there is no GL context) */
 		bool SetGlUniformMat4(const char* name, const glm::mat4& value);
 		bool SetGlUniformVec2(const char* name, const glm::vec2& value);
 		bool SetGlUniformVec3(const char* name, const glm::vec3& value);
@@ -48,6 +55,27 @@ namespace snes
 		bool SetGlUniformSampler2D(const char* name, GLuint value);
 		bool SetGlUniformBool(const char* name, bool value);
 
+		/** @return the slot of the uniform with the given name, or NO_UNIFORM if no shader in the program declares it */
+		UniformSlot FindUniformSlot(const char* name) const;
+		/** @return the number of uniform slots, one for each uniform declared in the program's shaders */
+		uint GetUniformCount() const { return (uint)m_uniforms.size(); }
+
+		/** Set the value of the uniform in a slot, on the current program. Does nothing without a slot or a program */
+		void SetGlUniformMat4(UniformSlot slot, const glm::mat4& value);
+		void SetGlUniformVec2(UniformSlot slot, const glm::vec2& value);
+		void SetGlUniformVec3(UniformSlot slot, const glm::vec3& value);
+		void SetGlUniformFloat(UniformSlot slot, float value);
+		void SetGlUniformInt(UniformSlot slot, int value);
+		/** Set the first count elements of an array uniform in a slot, on the current program. Arrays get their slot
+		  * under their name without the size, e.g. "lights" for "uniform vec3 lights[4];" */
+		void SetGlUniformMat4Array(UniformSlot slot, const glm::mat4* values, uint count);
+		void SetGlUniformFloatArray(UniformSlot slot, const float* values, uint count);
+
+		/** @return the material whose parameters this program last had uploaded. Materials share programs, so one whose
+		  * parameters were overwritten by another's must upload all of them again rather than only what changed */
+		const Material* GetParameterOwner() const { return m_parameterOwner; }
+		void SetParameterOwner(const Material* material) { m_parameterOwner = material; }
+
 		GLuint GetProgramID() { return m_programID; }
 		void Load(ShaderName shaderName) { m_programID = LoadShaders(shaderName); }
 
@@ -66,6 +94,7 @@ namespace snes
 
 		GLuint m_programID;
 		std::vector<ShaderUniform> m_uniforms;
+		const Material* m_parameterOwner = nullptr;
 
 
 	};
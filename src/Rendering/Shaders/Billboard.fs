@@ -1,8 +1,6 @@
 #version 430 core
-layout (location = 0) out vec3 gPosition;
-layout (location = 1) out vec3 gNormal;
-layout (location = 2) out vec4 gAlbedoSpec;
-layout (location = 3) out vec3 gEmissive;
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec4 gSurface;
 
 in vec3 fragPos;
 in vec3 vNormal;
@@ -12,6 +10,20 @@ uniform sampler2D albedo;
 uniform sampler2D normal;
 uniform bool useNormalMap;
 
+// Octahedral normal encoding, decoded by DeferredLightingPass.fs
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return n.z >= 0.0 ? n.xy : folded;
+}
+
+// Specular intensity for the surface buffer's alpha, kept below the 1.0 that marks a surface as emissive
+float EncodeSpecular(float specular)
+{
+	return min(specular, 254.0 / 255.0);
+}
+
 void main()
 {
 	vec4 tex = texture(albedo, texCoord);
@@ -21,8 +33,6 @@ void main()
 		discard;
 	}
 
-	// Fragment position vector
-	gPosition = fragPos;
 	// Fragment normal
 	//if(useNormalMap)
 	{
@@ -30,12 +40,8 @@ void main()
 	}
 	//else
 	{
-		gNormal = vNormal;
+		gNormal = EncodeNormal(vNormal);
 	}
-	// Albedo (colour)
-	gAlbedoSpec.rgb = tex.rgb;
-	// Specular intensity
-	gAlbedoSpec.a = 0;
-	// Emissive
-	gEmissive.rgb = vec3(0.0, 0.0, 0.0);
+	// Albedo (colour), with the specular intensity (below 1) in alpha
+	gSurface = vec4(tex.rgb, EncodeSpecular(0.0));
 }
\ No newline at end of file
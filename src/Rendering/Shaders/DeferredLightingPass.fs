@@ -4,15 +4,28 @@ in vec2 texCoord;
 
 out vec4 fragColour;
 
-uniform sampler2D gPosition;
+uniform sampler2D gDepth;
 uniform sampler2D gNormal;
-uniform sampler2D gAlbedoSpec;
-uniform sampler2D gEmissive;
+uniform sampler2D gSurface;
 uniform sampler2D gShadowMap;
 
-uniform vec3 viewPos;
-uniform mat4 cameraViewMat;
-uniform mat4 shadowVPMat;
+layout(std140, binding = 0) uniform View // See ViewUniformBuffer.h
+{
+	mat4 viewMat;
+	mat4 projMat;
+	mat4 projViewMat;
+	vec3 viewPos;
+	float time;
+};
+
+// The fraction of the G-buffer drawn to this frame, which is less than all of it at a reduced render resolution
+uniform vec2 gBufferScale;
+uniform mat4 inverseProjViewMat;
+const int CASCADE_COUNT = 4; // See ShadowCascades.h
+// Each cascade's matrix from world space to its tile of the shadow atlas, the view depth it covers up to, and its depth bias
+uniform mat4 cascadeAtlasMats[CASCADE_COUNT];
+uniform float cascadeSplits[CASCADE_COUNT];
+uniform float cascadeDepthBiases[CASCADE_COUNT];
 uniform vec3 eyeSpaceLightPos;
 uniform vec3 directionalLightColour;
 uniform float directionalLightIntensity = 1.0;
@@ -21,12 +34,31 @@ uniform vec3 directionalLightEyeDirection;
 struct PointLight
 {
 	vec3 pos;
-	vec3 colour;
 	float linear;
+	vec3 colour;
 	float quadratic;
 };
-const int MAX_POINT_LIGHTS = 32; // See DeferredLightingManager.h
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
+layout(std430, binding = 1) readonly buffer PointLights // See DeferredLightingManager.cpp
+{
+	uint pointLightCount;
+	PointLight pointLights[];
+};
+
+const uint CLUSTERS_X = 16; // See LightClusterGrid.h
+const uint CLUSTERS_Y = 9;
+const uint CLUSTERS_Z = 24;
+struct LightCluster
+{
+	uint offset;
+	uint count;
+};
+layout(std430, binding = 2) readonly buffer LightClusters // See LightClusterGrid.cpp
+{
+	float clusterDepthScale;
+	float clusterDepthBias;
+	LightCluster clusters[CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z];
+	uint clusterLightIndices[];
+};
 
 const float AMBIENT = 0.3;
 
@@ -46,33 +78,66 @@ float GetLinearShadowMap(in vec2 uv)
     return (2.0 * zNear) / (zFar + zNear - depth * (zFar - zNear));
 }
 
+// Inverse of the octahedral encoding in the geometry pass shaders
+vec3 DecodeNormal(vec2 encoded)
+{
+	vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -fold : fold, n.y >= 0.0 ? -fold : fold);
+	return normalize(n);
+}
+
 void main()
 {
 	//** GET DATA FROM BUFFER */
 
-    vec3 fragPos = texture(gPosition, texCoord).rgb;
-    vec3 normal = normalize(texture(gNormal, texCoord).rgb);
-    vec3 albedo = texture(gAlbedoSpec, texCoord).rgb;
-    vec3 emissive = texture(gEmissive, texCoord).rgb;
-    float specularAmount = texture(gAlbedoSpec, texCoord).a;
+	vec2 gBufferCoord = texCoord * gBufferScale;
+	float depth = texture(gDepth, gBufferCoord).r;
+	vec4 surface = texture(gSurface, gBufferCoord);
+
+	// Nothing was drawn here, so show the clear colour the surface buffer still holds
+	if (depth == 1.0)
+	{
+		fragColour = vec4(surface.rgb, 1.0);
+		return;
+	}
+
+	// The world position, reconstructed from the depth
+	vec4 worldPos = inverseProjViewMat * vec4(vec3(texCoord, depth) * 2.0 - 1.0, 1.0);
+	vec3 fragPos = worldPos.xyz / worldPos.w;
+	vec3 normal = DecodeNormal(texture(gNormal, gBufferCoord).rg);
+
+	// A surface is either lit, with its specular intensity (at most 254/255) in alpha, or emissive, with an alpha of 1
+	bool isEmissive = surface.a == 1.0;
+	vec3 albedo = isEmissive ? vec3(0.0) : surface.rgb;
+	vec3 emissive = isEmissive ? surface.rgb : vec3(0.0);
+	float specularAmount = isEmissive ? 0.0 : surface.a;
 
 	//** APPLY SHADOWS */
 
-	vec4 shadowSpacePos = shadowVPMat * vec4(fragPos, 1.0);
-	shadowSpacePos /= shadowSpacePos.w;
-	shadowSpacePos = shadowSpacePos * vec4(0.5) + vec4(0.5);
+	// Shadows come from the nearest cascade covering the pixel's depth. Beyond the last, nothing is shadowed
+	vec3 eyeSpaceFragPos = (viewMat * vec4(fragPos, 1)).xyz;
 	float dirLightAmount = 1.0;
+	int cascade = 0;
+	while (cascade < CASCADE_COUNT && -eyeSpaceFragPos.z > cascadeSplits[cascade])
+	{
+		cascade++;
+	}
 
-	for(int i = 0; i < 4; i++)
+	if (cascade < CASCADE_COUNT)
 	{
-		float shadowDepth = texture2D(gShadowMap, shadowSpacePos.xy + POISSONDISK[i]/700.0).x;
-		dirLightAmount = (shadowSpacePos.z > shadowDepth + 0.01) ? dirLightAmount - 0.25 : dirLightAmount;
+		// Already in the atlas' texture coordinates and 0-1 depth, as cascades are orthographic
+		vec3 shadowSpacePos = (cascadeAtlasMats[cascade] * vec4(fragPos, 1.0)).xyz;
+		for(int i = 0; i < 4; i++)
+		{
+			float shadowDepth = texture2D(gShadowMap, shadowSpacePos.xy + POISSONDISK[i]/1400.0).x;
+			dirLightAmount = (shadowSpacePos.z > shadowDepth + cascadeDepthBiases[cascade]) ? dirLightAmount - 0.25 : dirLightAmount;
+		}
 	}
 
     //** DIRECTIONAL LIGHTING */
     
 	vec3 lighting;
-	vec3 eyeSpaceFragPos = (cameraViewMat * vec4(fragPos, 1)).xyz;
 	vec3 viewDir = normalize(viewPos - fragPos);
 	{
 		//vec3 lightDir = normalize(eyeSpaceLightPos - eyeSpaceFragPos);
@@ -86,8 +151,22 @@ void main()
 
 	//** POINT LIGHTS */
 
-    for(int i = 0; i < MAX_POINT_LIGHTS; ++i)
+	// Point lights only add to lit surfaces, so emissive pixels skip them.
+	// Otherwise only the lights whose range reaches this pixel's cluster are evaluated
+	uint clusterLightCount = 0;
+	uint clusterOffset = 0;
+	if (!isEmissive)
+	{
+		uvec2 tile = min(uvec2(texCoord * vec2(CLUSTERS_X, CLUSTERS_Y)), uvec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+		uint slice = uint(clamp(log(-eyeSpaceFragPos.z) * clusterDepthScale - clusterDepthBias, 0.0, float(CLUSTERS_Z - 1)));
+		LightCluster cluster = clusters[(slice * CLUSTERS_Y + tile.y) * CLUSTERS_X + tile.x];
+		clusterOffset = cluster.offset;
+		clusterLightCount = cluster.count;
+	}
+
+    for(uint clusterLight = 0; clusterLight < clusterLightCount; ++clusterLight)
     {
+        uint i = clusterLightIndices[clusterOffset + clusterLight];
         // diffuse
         vec3 lightDir = normalize(pointLights[i].pos - fragPos);
         vec3 diffuse = max(dot(normal, lightDir), 0.0) * albedo * pointLights[i].colour;
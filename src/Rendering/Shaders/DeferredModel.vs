@@ -3,9 +3,16 @@ layout(location = 0) in vec3 vModelSpacePos;
 layout(location = 1) in vec2 vTexCoordIn;
 layout(location = 2) in vec3 vNormalIn;
 
+layout(std140, binding = 0) uniform View // See ViewUniformBuffer.h
+{
+	mat4 viewMat;
+	mat4 projMat;
+	mat4 projViewMat;
+	vec3 viewPos;
+	float time;
+};
+
 uniform mat4 modelMat;
-uniform mat4 viewMat;
-uniform mat4 projMat;
 
 out vec3 fragPos;
 out vec3 vNormal;
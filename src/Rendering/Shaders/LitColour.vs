@@ -2,10 +2,16 @@
 layout(location = 0) in vec3 vModelSpacePos;
 layout(location = 1) in vec3 vNormalIn;
 
+layout(std140, binding = 0) uniform View // See ViewUniformBuffer.h
+{
+	mat4 viewMat;
+	mat4 projMat;
+	mat4 projViewMat;
+	vec3 viewPos;
+	float time;
+};
+
 uniform mat4 modelMat;
-uniform mat4 viewMat;
-uniform mat4 projMat;
-uniform mat4 projViewMat;
 uniform mat4 normalMat;
 
 out vec3 fragPos;
@@ -16,5 +22,5 @@ void main()
 	vec4 worldPos = modelMat * vec4(vModelSpacePos, 1);
 	gl_Position = projViewMat * worldPos;
 	fragPos = worldPos.rgb;
-	vNormal = (normalMat * vec4(vNormalIn, 0)).xyz;
+	vNormal = mat3(viewMat) * mat3(normalMat) * vNormalIn;
 }
\ No newline at end of file
@@ -1,9 +1,18 @@
 #version 430 core
 layout(location = 0) in vec3 vModelSpacePos;
 
-uniform mat4 depthMVP;
+layout(std140, binding = 0) uniform View // See ViewUniformBuffer.h
+{
+	mat4 viewMat;
+	mat4 projMat;
+	mat4 projViewMat;
+	vec3 viewPos;
+	float time;
+};
+
+uniform mat4 modelMat;
 
 void main()
 {
-	gl_Position = depthMVP * vec4(vModelSpacePos, 1);
+	gl_Position = projViewMat * modelMat * vec4(vModelSpacePos, 1);
 }
\ No newline at end of file
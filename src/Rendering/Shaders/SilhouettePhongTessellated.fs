@@ -1,8 +1,6 @@
 #version 430 core
-layout (location = 0) out vec3 fPosition;
-layout (location = 1) out vec3 fNormal;
-layout (location = 2) out vec4 fAlbedoSpec;
-layout (location = 3) out vec3 fEmissive;
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec4 gSurface;
 
 in vec3 teFragPos;
 in vec3 teNormal;
@@ -10,16 +8,24 @@ in vec2 teTexCoord;
 
 uniform sampler2D tex1;
 
+// Octahedral normal encoding, decoded by DeferredLightingPass.fs
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return n.z >= 0.0 ? n.xy : folded;
+}
+
+// Specular intensity for the surface buffer's alpha, kept below the 1.0 that marks a surface as emissive
+float EncodeSpecular(float specular)
+{
+	return min(specular, 254.0 / 255.0);
+}
+
 void main()
 {
-	// Fragment position vector
-	fPosition = teFragPos;
 	// Fragment normal
-	fNormal = teNormal;
-	// Albedo (texture colour)
-	fAlbedoSpec.rgb = texture(tex1, teTexCoord).rgb;
-	// Specular intensity
-	fAlbedoSpec.a = 0.5;
-	// Emissive
-	fEmissive = vec3(0.0, 0.0, 0.0);
+	gNormal = EncodeNormal(teNormal);
+	// Albedo (texture colour), with the specular intensity (below 1) in alpha
+	gSurface = vec4(texture(tex1, teTexCoord).rgb, EncodeSpecular(0.5));
 }
\ No newline at end of file
@@ -1,24 +1,24 @@
 #version 430 core
-layout (location = 0) out vec3 gPosition;
-layout (location = 1) out vec3 gNormal;
-layout (location = 2) out vec4 gAlbedoSpec;
-layout (location = 3) out vec3 gEmissive;
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec4 gSurface;
 
 in vec3 fragPos;
 in vec3 vNormal;
 
 uniform vec3 colour;
 
+// Octahedral normal encoding, decoded by DeferredLightingPass.fs
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return n.z >= 0.0 ? n.xy : folded;
+}
+
 void main()
 {
-	// Fragment position vector
-	gPosition = fragPos;
 	// Fragment normal
-	gNormal = vNormal;
-	// Albedo (colour)
-	gAlbedoSpec.rgb = vec3(0.0, 0.0, 0.0);
-	// Specular intensity
-	gAlbedoSpec.a = 0;
-	// Emissive
-	gEmissive.rgb = colour;
+	gNormal = EncodeNormal(vNormal);
+	// Emissive colour, marked as emissive by an alpha of 1
+	gSurface = vec4(colour, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "stdafx.h"
+#include "ShadowCascades.h"
+#include <glm\gtc\matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace snes
+{
+	constexpr uint ShadowCascades::COUNT;
+	constexpr uint ShadowCascades::RESOLUTION;
+	constexpr uint ShadowCascades::ATLAS_RESOLUTION;
+	constexpr float ShadowCascades::SHADOW_DISTANCE;
+	constexpr float ShadowCascades::SPLIT_BLEND;
+	constexpr float ShadowCascades::FILTER_MARGIN_TEXELS;
+	constexpr float ShadowCascades::RECENTRE_SLACK;
+
+	void ShadowCascades::Fit(const CameraState& lightCamera, const CameraState& viewCamera)
+	{
+		// The near and far planes, read back out of the projection
+		const glm::mat4& proj = viewCamera.proj;
+		float zNear = proj[3][2] / (proj[2][2] - 1.0f);
+		float zFar = std::min(proj[3][2] / (proj[2][2] + 1.0f), SHADOW_DISTANCE);
+		// The squared distance from the view axis to a corner of the view, at a depth of 1
+		float cornerSlope = 1.0f / (proj[0][0] * proj[0][0]) + 1.0f / (proj[1][1] * proj[1][1]);
+
+		glm::mat4 inverseView = glm::inverse(viewCamera.view);
+		// Cascades are drawn looking the same way as the light, from the origin, so texel snapping works in world units
+		glm::mat4 lightRotation = glm::mat4(glm::mat3(lightCamera.view));
+		// Turning the light moves every cascade
+		bool lightMoved = lightRotation != m_lightRotation;
+		m_lightRotation = lightRotation;
+
+		float splitNear = zNear;
+		for (uint cascade = 0; cascade < COUNT; ++cascade)
+		{
+			float t = (float)(cascade + 1) / COUNT;
+			float logSplit = zNear * std::pow(zFar / zNear, t);
+			float evenSplit = zNear + (zFar - zNear) * t;
+			float splitFar = SPLIT_BLEND * logSplit + (1.0f - SPLIT_BLEND) * evenSplit;
+
+			// The smallest sphere centred on the view axis holding the corners of the range. It only depends on the
+			// splits and the field of view, so it stays the same size however the camera moves
+			float centreDepth = std::min((splitNear + splitFar) * (1.0f + cornerSlope) * 0.5f, splitFar);
+			float nearCornerDistance = std::sqrt(splitNear * splitNear * cornerSlope + (centreDepth - splitNear) * (centreDepth - splitNear));
+			float farCornerDistance = std::sqrt(splitFar * splitFar * cornerSlope + (splitFar - centreDepth) * (splitFar - centreDepth));
+			float radius = std::max(nearCornerDistance, farCornerDistance);
+
+			float slack = radius * RECENTRE_SLACK;
+			float reach = radius + slack;
+			float halfSize = reach * RESOLUTION / (RESOLUTION - 2.0f * FILTER_MARGIN_TEXELS);
+			float texelSize = 2.0f * halfSize / RESOLUTION;
+
+			// Stay put while the sphere is within the slack of where the cascade is centred
+			glm::vec3 sphereCentre = glm::vec3(lightRotation * inverseView * glm::vec4(0.0f, 0.0f, -centreDepth, 1.0f));
+			glm::vec3 drift = glm::abs(sphereCentre - m_centres[cascade]);
+			if (lightMoved || halfSize != m_halfSizes[cascade] || drift.x > slack || drift.y > slack || drift.z > slack)
+			{
+				// Snap the centre to whole texels across the light's view, so the same world positions land on the same texels
+				m_centres[cascade] = sphereCentre;
+				m_centres[cascade].x = std::floor(sphereCentre.x / texelSize) * texelSize;
+				m_centres[cascade].y = std::floor(sphereCentre.y / texelSize) * texelSize;
+				m_halfSizes[cascade] = halfSize;
+			}
+			const glm::vec3& centre = m_centres[cascade];
+
+			// Casters between the light and the sphere fall in front of the near plane, and are kept by clamping their depth
+			CameraState& camera = m_cameras[cascade];
+			camera = lightCamera;
+			camera.view = lightRotation;
+			camera.proj = glm::ortho(centre.x - halfSize, centre.x + halfSize, centre.y - halfSize, centre.y + halfSize, -(centre.z + reach), -(centre.z - reach));
+
+			// From clip space to this cascade's quarter of the atlas, with depth from 0 to 1
+			glm::ivec2 tile = GetTileOffset(cascade) / (int)RESOLUTION;
+			glm::mat4 toAtlas = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f * tile.x + 0.25f, 0.5f * tile.y + 0.25f, 0.5f));
+			toAtlas = glm::scale(toAtlas, glm::vec3(0.25f, 0.25f, 0.5f));
+			m_atlasMatrices[cascade] = toAtlas * camera.proj * camera.view;
+
+			m_splitDepths[cascade] = splitFar;
+			// About how far the depth of a surface at 45 degrees to the light changes across one texel
+			m_depthBiases[cascade] = texelSize / (2.0f * reach);
+			splitNear = splitFar;
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "RenderSnapshot.h"
+
+namespace snes
+{
+	/** Shadow Cascades
+	  * Splits the main camera's view, up to the shadow distance, into depth ranges that each get their own orthographic
+	  * shadow camera, fitted around the range and drawn into its own tile of a shadow atlas. Near ranges are small, so
+	  * the shadows closest to the camera get the most texels.
+	  * Each cascade is fitted to a sphere around its range, which keeps its size as the camera turns, and its position
+	  * snaps to whole texels, so shadow edges don't shimmer as the camera moves.
+	  * Each cascade also covers a little more than its sphere, and only moves once the sphere leaves that slack, so
+	  * small camera movements leave the cascades where they were and their cached static shadows can be reused. */
+	class ShadowCascades
+	{
+	public:
+		/** Must match the constant in DeferredLightingPass.fs */
+		static constexpr uint COUNT = 4;
+		/** The width and height of each cascade's tile, in texels */
+		static constexpr uint RESOLUTION = 1024;
+		/** The width and height of the atlas, which holds the cascades in a 2x2 grid */
+		static constexpr uint ATLAS_RESOLUTION = RESOLUTION * 2;
+		/** How far from the camera shadows are drawn */
+		static constexpr float SHADOW_DISTANCE = 100.0f;
+
+		/** Fit every cascade to the part of a camera's view it covers, as seen from a directional light's camera.
+		  * The view camera must have a perspective projection */
+		void Fit(const CameraState& lightCamera, const CameraState& viewCamera);
+
+		/** @return the camera a cascade's shadow casters are drawn with */
+		const CameraState& GetCamera(uint cascade) const { return m_cameras[cascade]; }
+		/** @return the matrix taking a world position to the cascade's texture coordinates in the atlas (xy) and its depth (z) */
+		const glm::mat4& GetAtlasMatrix(uint cascade) const { return m_atlasMatrices[cascade]; }
+		/** @return the view-space depth the cascade covers up to */
+		float GetSplitDepth(uint cascade) const { return m_splitDepths[cascade]; }
+		/** @return how much further than the shadow map a surface must be to be in shadow, in the cascade's depth units */
+		float GetDepthBias(uint cascade) const { return m_depthBiases[cascade]; }
+
+		/** @return the matrix taking a world position to the cascade's clip space, which only changes when the cascade moves */
+		glm::mat4 GetViewProjection(uint cascade) const { return m_cameras[cascade].proj * m_cameras[cascade].view; }
+
+		/** @return the texel offset of a cascade's tile in the atlas */
+		static glm::ivec2 GetTileOffset(uint cascade) { return glm::ivec2(cascade % 2, cascade / 2) * (int)RESOLUTION; }
+
+	private:
+		/** How far the splits lean from evenly spaced (0) towards logarithmically spaced (1) */
+		static constexpr float SPLIT_BLEND = 0.75f;
+		/** Texels left around each cascade's sphere, so filtered lookups near its edge stay inside the tile */
+		static constexpr float FILTER_MARGIN_TEXELS = 4.0f;
+		/** How far, as a fraction of its sphere's radius, a cascade's sphere may drift before the cascade moves to follow it.
+		  * The cascade's texels are spread over this much more space */
+		static constexpr float RECENTRE_SLACK = 0.1f;
+
+		CameraState m_cameras[COUNT];
+		glm::mat4 m_atlasMatrices[COUNT];
+		float m_splitDepths[COUNT] = {};
+		float m_depthBiases[COUNT] = {};
+		/** Where each cascade is centred, in the light's view, and the rotation and size it was fitted with */
+		glm::vec3 m_centres[COUNT];
+		float m_halfSizes[COUNT] = {};
+		glm::mat4 m_lightRotation = glm::mat4(0.0f);
+	};
+}
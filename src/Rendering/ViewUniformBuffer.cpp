@@ -0,0 +1,70 @@
+#include "stdafx.h"
+#include "ViewUniformBuffer.h"
+#include "GLState.h"
+#include "GraphicsDevice.h"
+#include <cstring>
+
+namespace snes
+{
+	constexpr GLuint ViewUniformBuffer::BINDING;
+
+	void ViewUniformBuffer::Init(uint viewCount)
+	{
+		if (!GraphicsDevice::IsAvailable())
+		{
+			return;
+		}
+
+		GLint alignment = 256;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		m_stride = ((sizeof(ViewUniforms) + alignment - 1) / alignment) * alignment;
+		m_viewCount = viewCount;
+
+		if (m_buffer == 0)
+		{
+			glGenBuffers(1, &m_buffer);
+		}
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBufferData(GL_UNIFORM_BUFFER, m_stride * viewCount, NULL, GL_DYNAMIC_DRAW);
+		m_staging.assign(m_stride * viewCount, 0);
+	}
+
+	void ViewUniformBuffer::WriteView(uint view, const CameraState& camera, float time)
+	{
+		if (view >= m_viewCount)
+		{
+			std::cout << "Error: View " << view << " is outside the view uniform buffer" << std::endl;
+			return;
+		}
+
+		ViewUniforms uniforms;
+		uniforms.viewMat = camera.view;
+		uniforms.projMat = camera.proj;
+		uniforms.projViewMat = camera.proj * camera.view;
+		uniforms.viewPos = camera.position;
+		uniforms.time = time;
+		std::memcpy(&m_staging[m_stride * view], &uniforms, sizeof(ViewUniforms));
+	}
+
+	void ViewUniformBuffer::Upload()
+	{
+		if (m_viewCount == 0)
+		{
+			return;
+		}
+
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, m_staging.size(), m_staging.data());
+	}
+
+	void ViewUniformBuffer::BindView(uint view)
+	{
+		if (view >= m_viewCount)
+		{
+			std::cout << "Error: View " << view << " is outside the view uniform buffer" << std::endl;
+			return;
+		}
+
+		GLState::BindBufferRange(GL_UNIFORM_BUFFER, BINDING, m_buffer, m_stride * view, sizeof(ViewUniforms));
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm\glm.hpp>
+#include "RenderSnapshot.h"
+#include <vector>
+
+namespace snes
+{
+	/** The camera data shaders read from their View uniform block, laid out by std140 rules.
+	  * Must match the block declared in every shader in Rendering/Shaders */
+	struct ViewUniforms
+	{
+		glm::mat4 viewMat;
+		glm::mat4 projMat;
+		glm::mat4 projViewMat;
+		/** Packed into the same 16 bytes as time, as std140 allows a scalar straight after a vec3 */
+		glm::vec3 viewPos;
+		/** Seconds of simulation run when the frame was captured */
+		float time;
+	};
+	static_assert(sizeof(ViewUniforms) == 208, "ViewUniforms must match the std140 layout of the View block");
+
+	/** View Uniform Buffer
+	  * One uniform buffer holding the View block of every view drawn in a frame, each at its own aligned offset.
+	  * Every view is written once per frame in a single upload, then each pass binds its view's range to the View
+	  * block's binding point, so the view and projection aren't set again on every material for every draw. */
+	class ViewUniformBuffer
+	{
+	public:
+		/** The binding point shaders declare their View block at */
+		static constexpr GLuint BINDING = 0;
+
+		/** Create the buffer with room for a number of views */
+		void Init(uint viewCount);
+
+		/** Write a camera into a view's part of the buffer. Reaches the GPU at the next Upload() */
+		void WriteView(uint view, const CameraState& camera, float time);
+		/** Send every view written since the last upload to the GPU in one call */
+		void Upload();
+		/** Bind a view's part of the buffer for the draws that follow */
+		void BindView(uint view);
+
+	private:
+		GLuint m_buffer = 0;
+		/** A copy of the buffer's contents, filled in by WriteView() */
+		std::vector<uint8> m_staging;
+		/** Bytes between views, rounded up to the uniform buffer offset alignment */
+		GLsizeiptr m_stride = 0;
+		uint m_viewCount = 0;
+	};
+}